@@ -1 +1,436 @@
 #include "file_logger.h"
+
+#include <cerrno>
+#include <cstdio>
+#include <stdexcept>
+
+#include <algorithm>
+#include <cstring>
+
+#include <boost/thread.hpp>
+
+#ifdef _LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+namespace system_utilities
+{
+	namespace common
+	{
+		namespace
+		{
+#ifdef _LINUX
+			int open_file( const std::string& file_path, const std::ios_base::openmode mode )
+			{
+				const int flags = O_WRONLY | O_CREAT | ( ( mode & std::ios_base::app ) ? O_APPEND : O_TRUNC );
+				return ::open( file_path.c_str(), flags, 0644 );
+			}
+			// open_mapped_file: shared writable mapping needs file that is opened for reading and writing
+			int open_mapped_file( const std::string& file_path, const std::ios_base::openmode mode )
+			{
+				const int flags = O_RDWR | O_CREAT | ( ( mode & std::ios_base::app ) ? 0 : O_TRUNC );
+				return ::open( file_path.c_str(), flags, 0644 );
+			}
+			void close_file( const int file )
+			{
+				::close( file );
+			}
+			// write_file: writes all parts by writev, counts writev calls, returns amount of written bytes
+			// (less than size of parts if writev failed)
+			size_t write_file( const int file, struct iovec* parts, int parts_size, size_t& calls )
+			{
+				size_t result = 0;
+				while ( parts_size > 0 )
+				{
+					const ssize_t written = ::writev( file, parts, parts_size );
+					++calls;
+					if ( written < 0 )
+					{
+						if ( errno == EINTR )
+							continue;
+						return result;
+					}
+					result += static_cast< size_t >( written );
+					size_t rest = static_cast< size_t >( written );
+					while ( parts_size > 0 && rest >= parts->iov_len )
+					{
+						rest -= parts->iov_len;
+						++parts;
+						--parts_size;
+					}
+					if ( parts_size > 0 )
+					{
+						parts->iov_base = static_cast< char* >( parts->iov_base ) + rest;
+						parts->iov_len -= rest;
+					}
+				}
+				return result;
+			}
+			size_t page_size()
+			{
+				return static_cast< size_t >( ::sysconf( _SC_PAGESIZE ) );
+			}
+			unsigned long long file_size( const int file )
+			{
+				struct stat file_stat;
+				if ( ::fstat( file, &file_stat ) != 0 )
+					return 0;
+				return static_cast< unsigned long long >( file_stat.st_size );
+			}
+			// preallocate_file: reserves disk space of file range, file is extended by ftruncate if file system does not support fallocate
+			bool preallocate_file( const int file, const unsigned long long from, const size_t size )
+			{
+				if ( ::fallocate( file, 0, static_cast< off_t >( from ), static_cast< off_t >( size ) ) == 0 )
+					return true;
+				return file_size( file ) >= from + size || ::ftruncate( file, static_cast< off_t >( from + size ) ) == 0;
+			}
+#else
+			size_t page_size()
+			{
+				return 4096;
+			}
+#endif
+			size_t round_to_page( const size_t size )
+			{
+				const size_t page = page_size();
+				return size ? ( size + page - 1 ) / page * page : page;
+			}
+		}
+
+		flush_settings::flush_settings( const flush_policy::value policy, const size_t bytes, const size_t period_milliseconds, const size_t buffer_size )
+			: policy( policy )
+			, buffer_size( buffer_size )
+			, bytes( bytes < buffer_size ? bytes : buffer_size )
+			, period_milliseconds( period_milliseconds )
+		{
+		}
+
+		file_sink::file_sink( const std::string& file_path, const flush_settings& settings, const std::ios_base::openmode mode )
+			: file_path_( file_path )
+			, settings_( settings )
+			, buffer_( settings.buffer_size ? settings.buffer_size : 1 )
+			, file_( -1 )
+			, last_write_( clock::now() )
+			, write_calls_( 0 )
+			, bytes_written_( 0 )
+			, failed_writes_( 0 )
+			, bytes_lost_( 0 )
+		{
+#ifdef _LINUX
+			file_ = open_file( file_path, mode );
+#else
+			std::FILE* const file = std::fopen( file_path.c_str(), ( mode & std::ios_base::app ) ? "ab" : "wb" );
+			if ( file )
+			{
+				std::fclose( file );
+				file_ = 0;
+			}
+#endif
+			if ( file_ < 0 )
+				throw std::logic_error( "file: " + file_path + " could not be opened." );
+			setp( &buffer_[ 0 ], &buffer_[ 0 ] + buffer_.size() );
+		}
+		file_sink::~file_sink()
+		{
+			flush();
+#ifdef _LINUX
+			close_file( file_ );
+#endif
+		}
+		void file_sink::flush()
+		{
+			write_( NULL, 0 );
+		}
+		void file_sink::message_written( const details::message_level::value value )
+		{
+			if ( settings_.policy == flush_policy::on_error && ( value == details::message_level::error || value == details::message_level::fatal ) )
+				flush();
+			else
+				apply_policy_();
+		}
+		void file_sink::flush_due()
+		{
+			if ( settings_.policy == flush_policy::every_period && pending() && clock::now() - last_write_ >= std::chrono::milliseconds( settings_.period_milliseconds ) )
+				flush();
+		}
+		size_t file_sink::write_calls() const
+		{
+			return write_calls_;
+		}
+		size_t file_sink::bytes_written() const
+		{
+			return bytes_written_;
+		}
+		size_t file_sink::failed_writes() const
+		{
+			return failed_writes_;
+		}
+		size_t file_sink::bytes_lost() const
+		{
+			return bytes_lost_;
+		}
+		size_t file_sink::pending() const
+		{
+			return static_cast< size_t >( pptr() - pbase() );
+		}
+		file_sink::int_type file_sink::overflow( int_type c )
+		{
+			flush();
+			if ( !traits_type::eq_int_type( c, traits_type::eof() ) )
+			{
+				*pptr() = traits_type::to_char_type( c );
+				pbump( 1 );
+			}
+			return traits_type::not_eof( c );
+		}
+		std::streamsize file_sink::xsputn( const char* s, std::streamsize n )
+		{
+			const size_t size = static_cast< size_t >( n );
+			if ( size > static_cast< size_t >( epptr() - pptr() ) )
+			{
+				// message that is not smaller than buffer goes to file with buffered messages, without copy
+				if ( size >= buffer_.size() )
+				{
+					write_( s, size );
+					return n;
+				}
+				flush();
+			}
+			traits_type::copy( pptr(), s, size );
+			pbump( static_cast< int >( n ) );
+			return n;
+		}
+		int file_sink::sync()
+		{
+			apply_policy_();
+			return 0;
+		}
+		void file_sink::apply_policy_()
+		{
+			switch ( settings_.policy )
+			{
+			case flush_policy::every_bytes:
+				if ( pending() >= settings_.bytes )
+					flush();
+				break;
+			case flush_policy::every_period:
+				flush_due();
+				break;
+			case flush_policy::on_error:
+			case flush_policy::on_call:
+				break;
+			}
+		}
+		// write_ method: writes buffered messages and message (could be NULL) by one system call
+		// buffer is reused even if write failed, not written bytes are counted as lost
+		void file_sink::write_( const char* const message, const size_t message_size )
+		{
+			const size_t buffered = pending();
+			const size_t size = buffered + message_size;
+			if ( size == 0 )
+				return;
+			size_t written = 0;
+#ifdef _LINUX
+			struct iovec parts[ 2 ];
+			int parts_size = 0;
+			if ( buffered )
+			{
+				parts[ parts_size ].iov_base = pbase();
+				parts[ parts_size ].iov_len = buffered;
+				++parts_size;
+			}
+			if ( message_size )
+			{
+				parts[ parts_size ].iov_base = const_cast< char* >( message );
+				parts[ parts_size ].iov_len = message_size;
+				++parts_size;
+			}
+			written = write_file( file_, parts, parts_size, write_calls_ );
+#else
+			std::FILE* const file = std::fopen( file_path_.c_str(), "ab" );
+			if ( file )
+			{
+				written = std::fwrite( pbase(), 1, buffered, file );
+				if ( message_size )
+					written += std::fwrite( message, 1, message_size, file );
+				std::fclose( file );
+			}
+			++write_calls_;
+#endif
+			bytes_written_ += written;
+			if ( written != size )
+			{
+				++failed_writes_;
+				bytes_lost_ += size - written;
+			}
+			last_write_ = clock::now();
+			setp( &buffer_[ 0 ], &buffer_[ 0 ] + buffer_.size() );
+		}
+	
+		const long long mapped_file_sink::free_window;
+		const size_t mapped_file_sink::windows_size;
+		const size_t mapped_file_sink::default_window_size;
+
+		mapped_file_sink::mapped_file_sink( const std::string& file_path, const size_t window_size, const std::ios_base::openmode mode )
+			: file_path_( file_path )
+			, window_size_( round_to_page( window_size ) )
+			, file_( -1 )
+			, start_offset_( 0 )
+			, offset_( 0 )
+			, dropped_( 0 )
+			, failed_( false )
+		{
+			for ( size_t i = 0 ; i < windows_size ; ++i )
+			{
+				windows_[ i ].index = free_window;
+				windows_[ i ].data = NULL;
+				windows_[ i ].completed = 0;
+			}
+#ifdef _LINUX
+			file_ = open_mapped_file( file_path, mode );
+			if ( file_ < 0 )
+				throw std::logic_error( "file: " + file_path + " could not be opened." );
+			start_offset_ = file_size( file_ );
+			offset_ = start_offset_;
+#else
+			throw std::logic_error( "file: " + file_path + " could not be mapped, mapped file is supported on linux only." );
+#endif
+		}
+		mapped_file_sink::~mapped_file_sink()
+		{
+#ifdef _LINUX
+			for ( size_t i = 0 ; i < windows_size ; ++i )
+				if ( windows_[ i ].index != free_window )
+					::munmap( windows_[ i ].data, window_size_ );
+			if ( ::ftruncate( file_, static_cast< off_t >( offset_.load() ) ) != 0 )
+				dropped_.fetch_add( 1 );
+			close_file( file_ );
+#endif
+		}
+		bool mapped_file_sink::append( const char* const data, const size_t size )
+		{
+			if ( size == 0 )
+				return true;
+			if ( failed_.load( std::memory_order_relaxed ) )
+			{
+				dropped_.fetch_add( 1, std::memory_order_relaxed );
+				return false;
+			}
+			const unsigned long long begin = offset_.fetch_add( size, std::memory_order_relaxed );
+			const unsigned long long end = begin + size;
+			bool result = true;
+			// data could cross windows bounds, window parts are copied in file order
+			for ( unsigned long long from = begin ; from < end ; )
+			{
+				const unsigned long long index = from / window_size_;
+				const size_t window_from = static_cast< size_t >( from - index * window_size_ );
+				const size_t part = static_cast< size_t >( std::min< unsigned long long >( window_size_ - window_from, end - from ) );
+				char* const window_data = window_( index );
+				if ( window_data )
+				{
+					std::memcpy( window_data + window_from, data + ( from - begin ), part );
+					complete_( index, part );
+				}
+				else
+					result = false;
+				from += part;
+			}
+			if ( !result )
+				dropped_.fetch_add( 1, std::memory_order_relaxed );
+			return result;
+		}
+		unsigned long long mapped_file_sink::size() const
+		{
+			return offset_.load( std::memory_order_relaxed );
+		}
+		size_t mapped_file_sink::dropped() const
+		{
+			return dropped_.load( std::memory_order_relaxed );
+		}
+		bool mapped_file_sink::failed() const
+		{
+			return failed_.load( std::memory_order_relaxed );
+		}
+		size_t mapped_file_sink::window_size() const
+		{
+			return window_size_;
+		}
+		mapped_file_sink::int_type mapped_file_sink::overflow( int_type c )
+		{
+			if ( !traits_type::eq_int_type( c, traits_type::eof() ) )
+			{
+				const char value = traits_type::to_char_type( c );
+				append( &value, 1 );
+			}
+			return traits_type::not_eof( c );
+		}
+		std::streamsize mapped_file_sink::xsputn( const char* s, std::streamsize n )
+		{
+			append( s, static_cast< size_t >( n ) );
+			return n;
+		}
+		// window_ method: returns mapping of window, maps it if it is not mapped yet, returns NULL if window could not be mapped
+		char* mapped_file_sink::window_( const unsigned long long index )
+		{
+			window& w = windows_[ index % windows_size ];
+			const long long expected = static_cast< long long >( index );
+			for ( ;; )
+			{
+				if ( w.index.load( std::memory_order_acquire ) == expected )
+					return w.data;
+				if ( failed_.load( std::memory_order_relaxed ) )
+					return NULL;
+				{
+					boost::mutex::scoped_lock lock( map_protector_ );
+					const long long current = w.index.load( std::memory_order_acquire );
+					if ( current == expected )
+						return w.data;
+					if ( current == free_window )
+					{
+						if ( map_( w, index ) )
+							return w.data;
+						// windows could not be completed without this one, so sink stops appends
+						failed_ = true;
+						return NULL;
+					}
+				}
+				// window that is windows_size windows behind is still written
+				boost::this_thread::yield();
+			}
+		}
+		bool mapped_file_sink::map_( window& w, const unsigned long long index )
+		{
+#ifdef _LINUX
+			const unsigned long long from = index * window_size_;
+			if ( !preallocate_file( file_, from, window_size_ ) )
+				return false;
+			void* const data = ::mmap( NULL, window_size_, PROT_READ | PROT_WRITE, MAP_SHARED, file_, static_cast< off_t >( from ) );
+			if ( data == MAP_FAILED )
+				return false;
+			w.data = static_cast< char* >( data );
+			// bytes of appended file that are before start offset are completed
+			const unsigned long long used = start_offset_ > from ? std::min< unsigned long long >( start_offset_ - from, window_size_ ) : 0;
+			w.completed.store( static_cast< size_t >( used ), std::memory_order_relaxed );
+			w.index.store( static_cast< long long >( index ), std::memory_order_release );
+			return true;
+#else
+			return false;
+#endif
+		}
+		// complete_ method: last writer of window unmaps it and frees window slot for next windows
+		void mapped_file_sink::complete_( const unsigned long long index, const size_t size )
+		{
+			window& w = windows_[ index % windows_size ];
+			if ( w.completed.fetch_add( size, std::memory_order_acq_rel ) + size != window_size_ )
+				return;
+#ifdef _LINUX
+			::munmap( w.data, window_size_ );
+#endif
+			w.index.store( free_window, std::memory_order_release );
+		}
+	}
+}
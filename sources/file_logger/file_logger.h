@@ -4,9 +4,15 @@
 #include <fstream>
 
 #include <boost/filesystem.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/mutex.hpp>
 
 #include <logger.h>
 
+#include "file_sink.h"
+#include "mapped_file_sink.h"
+
 namespace system_utilities
 {
 	namespace tests_
@@ -36,6 +42,10 @@ namespace system_utilities
 			{
 				file_stream_.close();
 			}
+			std::ofstream& file_stream()
+			{
+				return file_stream_;
+			}
 		public:
 			explicit file_logger( const std::string& file_path, std::ios_base::openmode mode = std::ios_base::app )
 				: inside_logger( file_stream_ )
@@ -59,6 +69,154 @@ namespace system_utilities
 				file_stream_.close();
 			}
 		};
+
+		namespace details
+		{
+			// file_sink_holder: sink and its stream should be created before inside logger of buffered_file_logger
+			struct file_sink_holder
+			{
+				file_sink sink_;
+				std::ostream sink_stream_;
+
+				explicit file_sink_holder( const std::string& file_path, const flush_settings& settings, std::ios_base::openmode mode )
+					: sink_( file_path, settings, mode )
+					, sink_stream_( &sink_ )
+				{
+				}
+			};
+		}
+
+		// buffered_file_logger: file logger that writes messages through file_sink (see file_sink.h for flush policies)
+		// gives message level to sink, so flush_policy::on_error could be used
+		// please do not use flush_stream = true inside logger: sink applies policy on std::ostream::flush anyway, it is just an extra call
+		// with every_period policy logger thread calls file_sink::flush_due() every period, so buffered message is written
+		// not later than two periods after previous write even if no more messages come
+		// thread safe logger (write and flush are protected by one mutex)
+
+		template< class inside_logger = logger< true, false, true > >
+		class buffered_file_logger : private details::file_sink_holder, public inside_logger
+		{
+			mutable boost::mutex protect_write_;
+			boost::condition stop_flush_;
+			bool stopping_;
+			boost::thread flush_thread_;
+
+			explicit buffered_file_logger( const buffered_file_logger& );
+		public:
+			explicit buffered_file_logger( const std::string& file_path, const flush_settings& settings = flush_settings(), std::ios_base::openmode mode = std::ios_base::app )
+				: details::file_sink_holder( file_path, settings, mode )
+				, inside_logger( sink_stream_ )
+				, stopping_( false )
+			{
+				if ( settings.policy == flush_policy::every_period )
+				{
+					const boost::posix_time::milliseconds period( settings.period_milliseconds ? settings.period_milliseconds : 1 );
+					flush_thread_ = boost::thread( [ this, period ]() { flush_periodically_( period ); } );
+				}
+			}
+			virtual ~buffered_file_logger()
+			{
+				{
+					boost::mutex::scoped_lock lock( protect_write_ );
+					stopping_ = true;
+					stop_flush_.notify_all();
+				}
+				if ( flush_thread_.joinable() )
+					flush_thread_.join();
+			}
+			// flush method: writes buffered messages to file
+			void flush()
+			{
+				boost::mutex::scoped_lock lock( protect_write_ );
+				sink_.flush();
+			}
+			const file_sink& sink() const
+			{
+				return sink_;
+			}
+		protected:
+			virtual void write( const details::message_level::value value, const std::string& message )
+			{
+				boost::mutex::scoped_lock lock( protect_write_ );
+				inside_logger::write( value, message );
+				sink_.message_written( value );
+			}
+		private:
+			void flush_periodically_( const boost::posix_time::milliseconds period )
+			{
+				boost::mutex::scoped_lock lock( protect_write_ );
+				while ( !stopping_ )
+				{
+					stop_flush_.timed_wait( lock, period );
+					if ( !stopping_ )
+						sink_.flush_due();
+				}
+			}
+		};
+
+		namespace details
+		{
+			// mapped_file_holder: sink and its stream should be created before logger of mapped_file_logger
+			struct mapped_file_holder
+			{
+				mapped_file_sink sink_;
+				std::ostream sink_stream_;
+
+				explicit mapped_file_holder( const std::string& file_path, const size_t window_size, std::ios_base::openmode mode )
+					: sink_( file_path, window_size, mode )
+					, sink_stream_( &sink_ )
+				{
+				}
+			};
+		}
+
+		// mapped_file_logger: file logger for high-volume logs, writes into memory-mapped file (see mapped_file_sink.h)
+		// message line (with prefix) is formatted in writing thread and appended to mapping by one append, writers do not lock each other
+		// lines of different threads could be not ordered by time (time is taken before append)
+		// thread safe logger, linux only
+
+		template< bool print_prefix = true, details::message_level::value min_level = details::message_level::debug >
+		class mapped_file_logger : private details::mapped_file_holder, public logger< true, false, print_prefix, min_level >
+		{
+			typedef logger< true, false, print_prefix, min_level > base_type;
+			static const size_t line_capacity = 1024;
+
+			explicit mapped_file_logger( const mapped_file_logger& );
+		public:
+			explicit mapped_file_logger( const std::string& file_path, const size_t window_size = mapped_file_sink::default_window_size, std::ios_base::openmode mode = std::ios_base::app )
+				: details::mapped_file_holder( file_path, window_size, mode )
+				, base_type( sink_stream_ )
+			{
+			}
+			virtual ~mapped_file_logger()
+			{
+			}
+			const mapped_file_sink& sink() const
+			{
+				return sink_;
+			}
+		protected:
+			virtual void write( const details::message_level::value value, const std::string& message )
+			{
+				static thread_local std::string line;
+				if ( line.capacity() < line_capacity )
+					line.reserve( line_capacity );
+				line.clear();
+				if ( print_prefix )
+				{
+					details::timestamp_formatter& formatter = details::timestamp_formatter::thread_formatter();
+					const size_t time_size = formatter.now();
+					line.push_back( '[' );
+					line.append( formatter.data(), time_size );
+					line.append( base_type::message_levels[ value ] );
+				}
+				line.append( message );
+				line.push_back( '\n' );
+				sink_.append( line.data(), line.size() );
+				if ( line.capacity() > line_capacity )
+					std::string().swap( line );
+			}
+		};
 	}
 }
 
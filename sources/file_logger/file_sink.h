@@ -0,0 +1,101 @@
+#ifndef _SYSTEM_UTILITIES_COMMON_FILE_SINK_H_
+#define _SYSTEM_UTILITIES_COMMON_FILE_SINK_H_
+
+#include <chrono>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include <logger.h>
+
+namespace system_utilities
+{
+	namespace common
+	{
+		// file_sink: stream buffer of log file with big user-space buffer, messages are written to file by flush policy
+		// every_bytes - file is written when buffer has flush_settings::bytes bytes
+		// every_period - file is written on message if previous write was flush_settings::period_milliseconds ago, and by flush_due() hook
+		// that should be called periodically (buffered_file_logger calls it by own thread every period), so last messages do not wait for next one
+		// on_error - file is written after error and fatal messages (see buffered_file_logger, it gives message level to sink)
+		// on_call - file is written only by flush() call
+		// with every policy file is written when buffer is full, by flush() and by destructor
+		// message that is not smaller than buffer is written together with buffered messages by one writev call, without copy
+		// std::ostream::flush() (flush_stream logger parameter) applies flush policy, it does not force write
+		// write error does not throw: messages that could not be written are dropped (buffer is reused), failed_writes() and bytes_lost() count them
+		// could be used as stream of any logger: file_sink sink( "my.log" ); std::ostream stream( &sink ); queue_logger<> l( stream, tasker );
+		// not thread safe, sink should be used by one logger (or under its write lock)
+
+		namespace flush_policy
+		{
+			enum value
+			{
+				every_bytes = 0,
+				every_period = 1,
+				on_error = 2,
+				on_call = 3
+			};
+		}
+
+		struct flush_settings
+		{
+			flush_policy::value policy;
+			size_t buffer_size;
+			size_t bytes;
+			size_t period_milliseconds;
+
+			explicit flush_settings( const flush_policy::value policy = flush_policy::every_bytes, const size_t bytes = 64 * 1024, const size_t period_milliseconds = 1000, const size_t buffer_size = 1024 * 1024 );
+		};
+
+		class file_sink : public std::streambuf
+		{
+			typedef std::chrono::steady_clock clock;
+
+			const std::string file_path_;
+			const flush_settings settings_;
+			std::vector< char > buffer_;
+			int file_;
+			clock::time_point last_write_;
+			size_t write_calls_;
+			size_t bytes_written_;
+			size_t failed_writes_;
+			size_t bytes_lost_;
+
+			explicit file_sink( const file_sink& );
+			file_sink& operator=( const file_sink& );
+		public:
+			// mode - std::ios_base::app appends to file, std::ios_base::trunc (or any other mode) truncates it
+			// throws std::logic_error if file could not be opened
+			explicit file_sink( const std::string& file_path, const flush_settings& settings = flush_settings(), const std::ios_base::openmode mode = std::ios_base::app );
+			// writes buffered messages
+			virtual ~file_sink();
+
+			// flush method: writes buffered messages to file
+			void flush();
+			// message_written method: applies flush policy after message of level was written into sink
+			void message_written( const details::message_level::value value );
+			// flush_due method: periodic hook of every_period policy, writes buffered messages if previous write was period ago
+			// should be called under the same lock as writes into sink
+			void flush_due();
+			// amount of write/writev calls, amount of bytes written to file
+			size_t write_calls() const;
+			size_t bytes_written() const;
+			// amount of writes that failed (completely or partially), amount of bytes that were not written because of them
+			size_t failed_writes() const;
+			size_t bytes_lost() const;
+			// pending method: amount of buffered bytes
+			size_t pending() const;
+
+		protected:
+			virtual int_type overflow( int_type c );
+			virtual std::streamsize xsputn( const char* s, std::streamsize n );
+			virtual int sync();
+
+		private:
+			void apply_policy_();
+			void write_( const char* const message, const size_t message_size );
+		};
+	}
+}
+
+#endif // _SYSTEM_UTILITIES_COMMON_FILE_SINK_H_
@@ -0,0 +1,82 @@
+#ifndef _SYSTEM_UTILITIES_COMMON_MAPPED_FILE_SINK_H_
+#define _SYSTEM_UTILITIES_COMMON_MAPPED_FILE_SINK_H_
+
+#include <atomic>
+#include <ios>
+#include <streambuf>
+#include <string>
+
+#include <boost/thread/mutex.hpp>
+
+namespace system_utilities
+{
+	namespace common
+	{
+		// mapped_file_sink: append-only log file that is mapped into memory by fixed-size windows
+		// append reserves file range by atomic offset and copies data into mapping, so writers do not lock each other and do not make system calls
+		// window is preallocated (fallocate) and mapped by first writer that needs it, last writer that completes window unmaps it
+		// (file is mapped by windows_size windows at most, writer waits only if window that is windows_size windows behind is not completed yet)
+		// destructor unmaps windows and truncates file to its used size, so sink should not be destroyed while other threads append to it
+		// crash safety: appended data is in page cache, as unflushed stream data it could be lost on system crash
+		// (on process crash it reaches file, but file is not truncated and has zero tail of preallocated window)
+		// as stream buffer every stream write is one append, so please use it as stream from one thread (mapped_file_logger appends whole lines)
+		// supported on linux only, constructor throws std::logic_error on other systems
+
+		class mapped_file_sink : public std::streambuf
+		{
+			static const long long free_window = -1;
+			static const size_t windows_size = 4;
+
+			struct window
+			{
+				std::atomic< long long > index;
+				char* data;
+				std::atomic< size_t > completed;
+			};
+
+			const std::string file_path_;
+			const size_t window_size_;
+			int file_;
+			unsigned long long start_offset_;
+			std::atomic< unsigned long long > offset_;
+			std::atomic< size_t > dropped_;
+			std::atomic< bool > failed_;
+
+			boost::mutex map_protector_;
+			window windows_[ windows_size ];
+
+			explicit mapped_file_sink( const mapped_file_sink& );
+			mapped_file_sink& operator=( const mapped_file_sink& );
+		public:
+			static const size_t default_window_size = 16 * 1024 * 1024;
+
+			// window_size is rounded up to page size
+			// mode - std::ios_base::app appends to file, std::ios_base::trunc (or any other mode) truncates it
+			// throws std::logic_error if file could not be opened
+			explicit mapped_file_sink( const std::string& file_path, const size_t window_size = default_window_size, const std::ios_base::openmode mode = std::ios_base::app );
+			// unmaps windows, truncates file to used size
+			virtual ~mapped_file_sink();
+
+			// append method: thread safe, returns false if data was not written
+			// when window could not be mapped (no space on device) sink is failed and next appends are not written
+			bool append( const char* const data, const size_t size );
+			// size method: used size of file
+			unsigned long long size() const;
+			// dropped method: amount of appends that were not written
+			size_t dropped() const;
+			bool failed() const;
+			size_t window_size() const;
+
+		protected:
+			virtual int_type overflow( int_type c );
+			virtual std::streamsize xsputn( const char* s, std::streamsize n );
+
+		private:
+			char* window_( const unsigned long long index );
+			bool map_( window& w, const unsigned long long index );
+			void complete_( const unsigned long long index, const size_t size );
+		};
+	}
+}
+
+#endif // _SYSTEM_UTILITIES_COMMON_MAPPED_FILE_SINK_H_
@@ -1,5 +1,9 @@
 #include "limited_file_logger.h"
 
+#ifdef SYSTEM_UTILITIES_ZLIB
+#include <zlib.h>
+#endif
+
 namespace system_utilities
 {
     namespace common
@@ -39,16 +43,218 @@ namespace system_utilities
 			template<>
 			size_t message_size_counter< true, false, true >::message_size( const details::message_level::value value, const std::string& message )
 			{
-				using namespace boost::posix_time;
-				static const size_t current_time_size = to_simple_string( microsec_clock::universal_time() ).size();
-				return 1 + current_time_size + logger<>::message_levels[ value ].size() + message.size() + 2;
+				return 1 + timestamp_formatter::size + logger<>::message_levels[ value ].size() + message.size() + 2;
 			}
 			template<>
 			size_t message_size_counter< true, true, true >::message_size( const details::message_level::value value, const std::string& message )
 			{
-				using namespace boost::posix_time;
-				static const size_t current_time_size = to_simple_string( microsec_clock::universal_time() ).size();
-				return 1 + current_time_size + logger<>::message_levels[ value ].size() + message.size() + 2;
+				return 1 + timestamp_formatter::size + logger<>::message_levels[ value ].size() + message.size() + 2;
+			}
+
+			namespace
+			{
+				const boost::posix_time::time_duration reopen_timeout = boost::posix_time::seconds( 1 );
+
+#ifdef SYSTEM_UTILITIES_ZLIB
+				// gzip_file: compresses file to gzip file, returns false if file could not be compressed
+				bool gzip_file( const std::string& from, const std::string& to )
+				{
+					std::ifstream input( from.c_str(), std::ios::in | std::ios::binary );
+					if ( !input.is_open() )
+						return false;
+					gzFile output = gzopen( to.c_str(), "wb" );
+					if ( !output )
+						return false;
+					std::vector< char > buffer( 64 * 1024 );
+					bool result = true;
+					while ( result && input )
+					{
+						input.read( &buffer[ 0 ], static_cast< std::streamsize >( buffer.size() ) );
+						const int size = static_cast< int >( input.gcount() );
+						if ( size > 0 )
+							result = gzwrite( output, &buffer[ 0 ], static_cast< unsigned int >( size ) ) == size;
+					}
+					return gzclose( output ) == Z_OK && result;
+				}
+#else
+				bool gzip_file( const std::string&, const std::string& )
+				{
+					return false;
+				}
+#endif
+			}
+
+			file_rotator::file_rotator( const std::string& file_path )
+				: file_path_( file_path )
+				, next_file_path_( file_path + ".next" )
+				, compression_( rotation_compression::none )
+				, next_requested_( false )
+				, next_ready_( false )
+				, next_failed_( false )
+				, working_( false )
+				, stopping_( false )
+			{
+				boost::system::error_code error;
+				if ( boost::filesystem::exists( next_file_path_, error ) && boost::filesystem::file_size( next_file_path_, error ) == 0 )
+					boost::filesystem::remove( next_file_path_, error );
+			}
+			file_rotator::~file_rotator()
+			{
+				{
+					boost::mutex::scoped_lock lock( protector_ );
+					stopping_ = true;
+					changed_.notify_all();
+				}
+				if ( thread_.joinable() )
+					thread_.join();
+				if ( next_ready_ )
+				{
+					next_stream_.close();
+					boost::system::error_code error;
+					boost::filesystem::remove( next_file_path_, error );
+				}
+			}
+			bool file_rotator::interrupted() const
+			{
+				boost::system::error_code error;
+				return boost::filesystem::exists( next_file_path_, error ) && boost::filesystem::file_size( next_file_path_, error ) > 0 && !error;
+			}
+			void file_rotator::recover()
+			{
+				const std::string old_file_path = file_path_ + ".old";
+				boost::system::error_code error;
+				boost::filesystem::remove( old_file_path, error );
+				boost::filesystem::remove( old_file_path + ".gz", error );
+				boost::filesystem::rename( file_path_, old_file_path, error );
+				boost::filesystem::rename( next_file_path_, file_path_, error );
+			}
+			void file_rotator::prepare()
+			{
+				if ( !asynchronous() )
+					return;
+				boost::mutex::scoped_lock lock( protector_ );
+				if ( next_ready_ || next_requested_ || stopping_ )
+					return;
+				next_requested_ = true;
+				start_();
+			}
+			bool file_rotator::rotate( std::ofstream& stream )
+			{
+				if ( !asynchronous() )
+					return false;
+				boost::mutex::scoped_lock lock( protector_ );
+				if ( stopping_ )
+					return false;
+				if ( !next_ready_ && !next_requested_ )
+				{
+					next_requested_ = true;
+					start_();
+				}
+				// next file is requested at 90% of limit, opening is short, so logger waits for it instead of growing over limit
+				// logger writes to current file if next file could not be opened
+				while ( !next_ready_ && !next_failed_ && !stopping_ )
+					changed_.wait( lock );
+				if ( !next_ready_ || stopping_ )
+					return false;
+				std::ofstream* const old_stream = new std::ofstream();
+				old_stream->swap( stream );
+				stream.swap( next_stream_ );
+				old_streams_.push_back( old_stream );
+				next_ready_ = false;
+				start_();
+				return true;
+			}
+			bool file_rotator::asynchronous() const
+			{
+#ifdef _LINUX
+				return true;
+#else
+				return false;
+#endif
+			}
+			bool file_rotator::ready() const
+			{
+				boost::mutex::scoped_lock lock( protector_ );
+				return !working_;
+			}
+			void file_rotator::set_compression( const rotation_compression::value compression )
+			{
+				compression_ = compression;
+			}
+			// start_ method: starts background thread if it is not working, protector_ should be locked
+			void file_rotator::start_()
+			{
+				if ( working_ )
+				{
+					changed_.notify_one();
+					return;
+				}
+				// previous thread has finished its work under protector_, so join does not wait for it
+				if ( thread_.joinable() )
+					thread_.join();
+				working_ = true;
+				thread_ = boost::thread( [this]() { process_(); } );
+			}
+			void file_rotator::process_()
+			{
+				boost::mutex::scoped_lock lock( protector_ );
+				for ( ;; )
+				{
+					std::vector< std::ofstream* > old_streams;
+					old_streams.swap( old_streams_ );
+					const bool open_next = next_requested_ && !next_ready_ && !stopping_;
+					if ( old_streams.empty() && !open_next )
+						break;
+					lock.unlock();
+					for ( size_t i = 0 ; i < old_streams.size() ; ++i )
+						finish_( old_streams[ i ] );
+					// next file is not used by logger until next_ready_ is set, messages of existing file are kept
+					bool opened = false;
+					if ( open_next )
+					{
+						next_stream_.open( next_file_path_.c_str(), std::ios_base::out | std::ios_base::app );
+						opened = next_stream_.is_open();
+					}
+					lock.lock();
+					if ( opened )
+					{
+						next_ready_ = true;
+						next_requested_ = false;
+						next_failed_ = false;
+					}
+					else if ( open_next )
+						next_failed_ = true;
+					changed_.notify_all();
+					if ( open_next && !opened && !stopping_ )
+						changed_.timed_wait( lock, reopen_timeout );
+				}
+				working_ = false;
+			}
+			// finish_ method: closes old file, moves it to .old, moves next file (that logger already writes) to log file path
+			void file_rotator::finish_( std::ofstream* const old_stream )
+			{
+				old_stream->close();
+				delete old_stream;
+				const std::string old_file_path = file_path_ + ".old";
+				boost::system::error_code error;
+				boost::filesystem::remove( old_file_path, error );
+				boost::filesystem::remove( old_file_path + ".gz", error );
+				boost::filesystem::rename( file_path_, old_file_path, error );
+				boost::filesystem::rename( next_file_path_, file_path_, error );
+				if ( compression_ == rotation_compression::gzip && gzip_file( old_file_path, old_file_path + ".gz" ) )
+					boost::filesystem::remove( old_file_path, error );
+			}
+		}
+
+		namespace rotation_compression
+		{
+			bool supported( const value compression )
+			{
+#ifdef SYSTEM_UTILITIES_ZLIB
+				return compression == none || compression == gzip;
+#else
+				return compression == none;
+#endif
 			}
 		}
 	}
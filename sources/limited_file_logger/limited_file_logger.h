@@ -1,10 +1,13 @@
 #ifndef _SYSTEM_UTILITIES_COMMON_LIMITED_FILE_LOGGER_H_
 #define _SYSTEM_UTILITIES_COMMON_LIMITED_FILE_LOGGER_H_
 
+#include <atomic>
 #include <fstream>
+#include <vector>
 
 #include <boost/filesystem.hpp>
 #include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
 
 #include <file_logger.h>
 
@@ -18,6 +21,24 @@ namespace system_utilities
 		// for example: log file name = "my.log", file_size_limit = 1, auto_delete = true
 		// you will find logs: "my.log" - current log for working system and "my.log.old" for old log 
 		// see logger module - to understand template parameters
+		// rotation does not stop writing thread: when log reaches 90% of limit background thread pre-opens "my.log.next" file,
+		// at limit logger swaps stream to it, background thread closes old file, renames it to "my.log.old"
+		// (compresses it to "my.log.old.gz" if set_compression( rotation_compression::gzip ) was called) and renames "my.log.next" to "my.log"
+		// if next file is not pre-opened yet at limit, logger waits for it; if it could not be opened, logger writes to current file and rotates on next write
+		// background thread is started only for this work and exits after it
+		// "my.log.next" with messages left by stopped process is recovered on open: it becomes "my.log", "my.log" becomes "my.log.old"
+		// on systems that could not rename opened files (windows) rotation is synchronous
+
+		namespace rotation_compression
+		{
+			enum value
+			{
+				none = 0,
+				gzip = 1
+			};
+			// supported method: returns false if library was built without zlib
+			bool supported( const value compression );
+		}
 
 		namespace details
 		{
@@ -26,6 +47,52 @@ namespace system_utilities
 			{
 				static size_t message_size( const details::message_level::value value, const std::string& message );
 			};
+
+			// file_rotator: pre-opens next file of log and finishes rotation (close, rename, compress) in background thread
+			// thread is started by prepare() or rotate() and exits when there is nothing to do
+			class file_rotator : protected virtual boost::noncopyable
+			{
+				const std::string file_path_;
+				const std::string next_file_path_;
+				std::atomic< int > compression_;
+
+				mutable boost::mutex protector_;
+				boost::condition changed_;
+				std::ofstream next_stream_;
+				bool next_requested_;
+				bool next_ready_;
+				bool next_failed_;
+				std::vector< std::ofstream* > old_streams_;
+				bool working_;
+				bool stopping_;
+				boost::thread thread_;
+
+			public:
+				// removes empty next file left by stopped process
+				explicit file_rotator( const std::string& file_path );
+				// finishes started rotations, removes pre-opened next file
+				~file_rotator();
+
+				// interrupted method: next file with messages was left by stopped process (rotation was not finished)
+				bool interrupted() const;
+				// recover method: finishes interrupted rotation, log file should be closed: moves log file to old file and next file to log file
+				void recover();
+				// prepare method: pre-opens next file in background thread
+				void prepare();
+				// rotate method: swaps stream to pre-opened next file (waits for requested next file to be opened),
+				// returns false if next file could not be opened
+				bool rotate( std::ofstream& stream );
+				// asynchronous method: false if rotate always returns false (rotation should be synchronous)
+				bool asynchronous() const;
+				// ready method: background thread has finished its work (rotations and requested pre-open of next file)
+				bool ready() const;
+				void set_compression( const rotation_compression::value compression );
+
+			private:
+				void start_();
+				void process_();
+				void finish_( std::ofstream* const old_stream );
+			};
 		}
 
 		template< 
@@ -39,30 +106,51 @@ namespace system_utilities
 			typedef file_logger< logger_type > inside_logger;
 			std::string file_path_;
 			size_t current_file_size_;
+			bool next_file_requested_;
+			details::file_rotator rotator_;
 		public:
 			explicit limited_file_logger( const std::string& file_path, std::ios_base::openmode open_mode = std::ios_base::app )
 				: inside_logger( file_path, open_mode )
 				, file_path_( file_path )
+				, next_file_requested_( false )
+				, rotator_( file_path )
 			{
+				recover_next_file_( file_path );
 				fill_file_size_on_open_( file_path );
 			}
 			template< class P1 >
 			explicit limited_file_logger( const std::string& file_path, P1& p1, std::ios_base::openmode open_mode = std::ios_base::app )
 				: inside_logger( file_path, p1, open_mode )
 				, file_path_( file_path )
+				, next_file_requested_( false )
+				, rotator_( file_path )
 			{
+				recover_next_file_( file_path );
 				fill_file_size_on_open_( file_path );
 			}
 			template< class P1, class P2 >
 			explicit limited_file_logger( const std::string& file_path, P1& p1, P2& p2, std::ios_base::openmode open_mode = std::ios_base::app )
 				: inside_logger( file_path, p1, p2, open_mode )
 				, file_path_( file_path )
+				, next_file_requested_( false )
+				, rotator_( file_path )
 			{
+				recover_next_file_( file_path );
 				fill_file_size_on_open_( file_path );
 			}
 			~limited_file_logger()
 			{
 			}
+			// set_compression method: compression of next old files, gzip is not supported if library was built without zlib
+			void set_compression( const rotation_compression::value compression )
+			{
+				rotator_.set_compression( compression );
+			}
+			// rotation_ready method: previous rotation is finished and next file is pre-opened if it was requested
+			bool rotation_ready() const
+			{
+				return rotator_.ready();
+			}
 		protected:
 			void write( const details::message_level::value value, const std::string& message )
 			{
@@ -70,12 +158,33 @@ namespace system_utilities
 
 				const size_t file_size_limit_in_bytes = file_size_limit * 1024 * 1024;
 				if ( current_file_size_ + new_message_size >= file_size_limit_in_bytes )
-					rename_( file_path_ );
+				{
+					if ( rotator_.rotate( inside_logger::file_stream() ) )
+					{
+						current_file_size_ = 0;
+						next_file_requested_ = false;
+					}
+					else if ( !rotator_.asynchronous() )
+						rename_( file_path_ );
+				}
+				else if ( !next_file_requested_ && current_file_size_ + new_message_size >= file_size_limit_in_bytes / 10 * 9 )
+				{
+					rotator_.prepare();
+					next_file_requested_ = true;
+				}
 
 				current_file_size_ += new_message_size;
 				inside_logger::write( value, message );
 			}
 		private:
+			void recover_next_file_( const std::string& file_path )
+			{
+				if ( !rotator_.interrupted() )
+					return;
+				inside_logger::close_stream();
+				rotator_.recover();
+				inside_logger::open_stream( file_path, std::ios_base::app );
+			}
 			void fill_file_size_on_open_( const std::string& file_path )
 			{
 				current_file_size_ = static_cast< size_t >( boost::filesystem::file_size( file_path ) );
@@ -1,59 +1,210 @@
 #include "logger.h"
 
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+
 
 namespace system_utilities
 {
     namespace common
     {
-		template<>
-		void logger< false >::write( const details::message_level::value , const std::string& )
-		{
-		}
-		template<>
-		void logger< false, false >::write( const details::message_level::value , const std::string& )
+		namespace details
 		{
-		}
-		template<>
-		void logger< false, true, false >::write( const details::message_level::value, const std::string& )
-		{
-		}
-		template<>
-		void logger< false, false, false >::write( const details::message_level::value, const std::string& )
-		{
-		}
+			std::atomic< int > log_threshold::severity( message_level::severity( message_level::debug ) );
 
-		template<>
-		void logger< true, false, false >::write( const details::message_level::value, const std::string& message )
-		{
-			stream_ << message << "\n";
+			const size_t timestamp_formatter::size;
+			const size_t timestamp_formatter::seconds_size;
+
+			timestamp_formatter::timestamp_formatter()
+				: second_( -1 )
+			{
+				buffer_[ seconds_size ] = '.';
+			}
+			size_t timestamp_formatter::format( const long long microseconds )
+			{
+				const long long second = microseconds / 1000000;
+				if ( second != second_ )
+				{
+					const std::string formatted = boost::posix_time::to_simple_string( boost::posix_time::from_time_t( static_cast< std::time_t >( second ) ) );
+					formatted.copy( buffer_, seconds_size );
+					second_ = second;
+				}
+				long long fraction = microseconds % 1000000;
+				if ( fraction == 0 )
+					return seconds_size;
+				for ( size_t i = size - 1 ; i > seconds_size ; --i, fraction /= 10 )
+					buffer_[ i ] = static_cast< char >( '0' + fraction % 10 );
+				return size;
+			}
+			size_t timestamp_formatter::now()
+			{
+				return format( std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::system_clock::now().time_since_epoch() ).count() );
+			}
+			timestamp_formatter& timestamp_formatter::thread_formatter()
+			{
+				static thread_local timestamp_formatter formatter;
+				return formatter;
+			}
+
+			const size_t streamer_buffer::capacity;
+
+			streamer_buffer::streamer_buffer()
+				: stream_( this )
+				, busy_( false )
+			{
+				message_.reserve( capacity );
+			}
+			streamer_buffer::~streamer_buffer()
+			{
+			}
+			streamer_buffer* streamer_buffer::acquire()
+			{
+				static thread_local streamer_buffer buffer;
+				if ( buffer.busy_ )
+					return NULL;
+				buffer.busy_ = true;
+				// previous message could change format flags (std::hex, precision...)
+				static const std::ios_base::fmtflags default_flags = std::ios_base::skipws | std::ios_base::dec;
+				buffer.stream_.flags( default_flags );
+				buffer.stream_.precision( 6 );
+				buffer.stream_.width( 0 );
+				buffer.stream_.fill( ' ' );
+				buffer.stream_.clear();
+				return &buffer;
+			}
+			void streamer_buffer::release()
+			{
+				if ( message_.capacity() > capacity )
+				{
+					std::string().swap( message_ );
+					message_.reserve( capacity );
+				}
+				else
+					message_.clear();
+				busy_ = false;
+			}
+			std::ostream& null_stream()
+			{
+				static thread_local std::ostream stream( NULL );
+				return stream;
+			}
+			streamer_buffer::int_type streamer_buffer::overflow( int_type c )
+			{
+				if ( !traits_type::eq_int_type( c, traits_type::eof() ) )
+					message_.push_back( traits_type::to_char_type( c ) );
+				return traits_type::not_eof( c );
+			}
+			std::streamsize streamer_buffer::xsputn( const char* s, std::streamsize n )
+			{
+				message_.append( s, static_cast< size_t >( n ) );
+				return n;
+			}
+
+			bool format_message( std::string& to, const char* format, va_list arguments )
+			{
+				// string capacity is free, so message is formatted directly into it and measured by the same call
+				to.resize( to.capacity() );
+				va_list measure_arguments;
+				va_copy( measure_arguments, arguments );
+				const int size = vsnprintf( &to[ 0 ], to.size(), format, measure_arguments );
+				va_end( measure_arguments );
+				if ( size < 0 )
+				{
+					to.clear();
+					return false;
+				}
+				const size_t message_size = static_cast< size_t >( size );
+				if ( message_size >= to.size() )
+				{
+					to.resize( message_size + 1 );
+					vsnprintf( &to[ 0 ], to.size(), format, arguments );
+				}
+				to.resize( message_size );
+				return true;
+			}
+
+			template<>
+			void message_writer< false, true, true >::write( std::ostream&, const std::string&, const std::string& )
+			{
+			}
+			template<>
+			void message_writer< false, false, true >::write( std::ostream&, const std::string&, const std::string& )
+			{
+			}
+			template<>
+			void message_writer< false, true, false >::write( std::ostream&, const std::string&, const std::string& )
+			{
+			}
+			template<>
+			void message_writer< false, false, false >::write( std::ostream&, const std::string&, const std::string& )
+			{
+			}
+
+			template<>
+			void message_writer< true, false, false >::write( std::ostream& stream, const std::string&, const std::string& message )
+			{
+				stream << message << "\n";
+			}
+
+			template<>
+			void message_writer< true, true, false >::write( std::ostream& stream, const std::string&, const std::string& message )
+			{
+				stream << message << "\n";
+				stream.flush();
+			}
+
+			template<>
+			void message_writer< true, false, true >::write( std::ostream& stream, const std::string& level_prefix, const std::string& message )
+			{
+				timestamp_formatter& formatter = timestamp_formatter::thread_formatter();
+				const size_t current_time_size = formatter.now();
+				static const char open_quote = '[';
+				stream << open_quote;
+				stream.write( formatter.data(), static_cast< std::streamsize >( current_time_size ) );
+				stream << level_prefix << message << "\n";
+			}
+
+			template<>
+			void message_writer< true, true, true >::write( std::ostream& stream, const std::string& level_prefix, const std::string& message )
+			{
+				timestamp_formatter& formatter = timestamp_formatter::thread_formatter();
+				const size_t current_time_size = formatter.now();
+				static const char open_quote = '[';
+				stream << open_quote;
+				stream.write( formatter.data(), static_cast< std::streamsize >( current_time_size ) );
+				stream << level_prefix << message << "\n";
+				stream.flush();
+			}
 		}
 
-		template<>
-		void logger< true, true, false >::write( const details::message_level::value, const std::string& message )
+		void set_log_level( const details::message_level::value level )
 		{
-			stream_ << message << "\n";
-			flush();
+			details::log_threshold::severity.store( details::message_level::severity( level ), std::memory_order_relaxed );
 		}
-
-		template<>
-		void logger< true, false, true >::write( const details::message_level::value value, const std::string& message )
+		details::message_level::value log_level()
 		{
-			using namespace boost::posix_time;
-			const std::string current_time = to_simple_string( microsec_clock::universal_time() );
-			static const char open_quote = '[';
-			stream_ << open_quote << current_time << message_levels[ value ] << message << "\n";
+			using namespace details::message_level;
+			const value levels[] = { debug, note, warn, error, fatal };
+			return levels[ details::log_threshold::severity.load( std::memory_order_relaxed ) ];
 		}
-
-		template<>
-		void logger< true, true, true >::write( const details::message_level::value value, const std::string& message )
+		bool parse_log_level( const std::string& name, details::message_level::value& level )
 		{
-			using namespace boost::posix_time;
-			const std::string current_time = to_simple_string( microsec_clock::universal_time() );
-			static const char open_quote = '[';
-			stream_ << open_quote << current_time << message_levels[ value ] << message << "\n";
-			flush();
+			using namespace details::message_level;
+			if ( name == "debug" )
+				level = debug;
+			else if ( name == "note" )
+				level = note;
+			else if ( name == "warn" || name == "warning" )
+				level = warn;
+			else if ( name == "error" )
+				level = error;
+			else if ( name == "fatal" )
+				level = fatal;
+			else
+				return false;
+			return true;
 		}
-
     }
 }
 
@@ -3,8 +3,12 @@
 
 #include <stdarg.h>
 
+#include <atomic>
 #include <ostream>
+#include <streambuf>
 #include <string>
+#include <type_traits>
+#include <utility>
 
 #include <boost/noncopyable.hpp>
 #include <boost/date_time/local_time/local_time.hpp>
@@ -24,17 +28,20 @@ namespace system_utilities
 		// turn_on - turn logger on (simply to turn logger of on compilation phaze)
 		// flush_stream - if true will flush stream after each write. log became more safe, but performance killer
 		// print prefix - if true will print prefix strings (for logger it UTC-Time, message_type)
+		// min_level - messages with lower level are not written, level order is debug < note < warn < error < fatal
+		// messages are filtered also by runtime log level (set_log_level function, System.log.level setting of system_processor)
 		//
 		// you can use logger like: logger_.note() << "This is " << 1 << " example";
+		// or logger_.note( "This is {} example", 1 ); - fmt-style message, "{}" is replaced by next argument (written by operator<<)
+		// or SYSTEM_UTILITIES_LOG_FORMAT( logger_, note, "This is {} example", 1 ); - the same, amount of "{}" is checked at compile time
+		// or logger_.formatted_note( "This is %d example", 1 ); - printf-style message
+		// or SYSTEM_UTILITIES_LOG_DEBUG( logger_ ) << "This is " << expensive_call(); - arguments are not evaluated if debug level is disabled
+		// (if level is disabled by turn_on or min_level compiler removes whole statement)
 		// please see queue_logger it could gave better performance on write method (if you writing thread is performance-dependent)
 		// not thread safe logger
 
-		template< bool turn_on = true, bool flush_stream = true, bool print_prefix = true >
-		class logger;
-
 		namespace details
 		{
-
 			namespace message_level
 			{
 				enum value
@@ -45,65 +52,225 @@ namespace system_utilities
 					debug = 3,
 					fatal = 4
 				};
+				// severity function: order of levels for filtering
+				inline constexpr int severity( const value v )
+				{
+					return v == debug ? 0 : v == note ? 1 : v == warn ? 2 : v == error ? 3 : 4;
+				}
+			}
+			// log_threshold: severity of runtime log level
+			struct log_threshold
+			{
+				static std::atomic< int > severity;
+			};
+		}
+
+		// set_log_level function: sets runtime log level of all loggers, could be called at any time from any thread
+		void set_log_level( const details::message_level::value level );
+		details::message_level::value log_level();
+		// parse_log_level function: "debug", "note", "warn" ("warning"), "error", "fatal" names, returns false for other names
+		bool parse_log_level( const std::string& name, details::message_level::value& level );
+
+		template< bool turn_on = true, bool flush_stream = true, bool print_prefix = true, details::message_level::value min_level = details::message_level::debug >
+		class logger;
+
+		namespace details
+		{
+			// timestamp_formatter: formats time like boost::posix_time::to_simple_string( ptime ) ("2016-Jan-01 10:20:30.123456")
+			// date and seconds part is formatted by boost once per second and cached, only microseconds digits are rewritten for other calls
+			// microseconds part is not written if it is 0 (as to_simple_string does)
+			// not thread safe, use one formatter per thread (see thread_formatter())
+			class timestamp_formatter
+			{
+			public:
+				// size of formatted time with microseconds, size of formatted time without microseconds
+				static const size_t size = 27;
+				static const size_t seconds_size = 20;
+
+			private:
+				char buffer_[ size ];
+				long long second_;
+
+				explicit timestamp_formatter( const timestamp_formatter& );
+				timestamp_formatter& operator=( const timestamp_formatter& );
+			public:
+				explicit timestamp_formatter();
+				// format method: formats UTC time (microseconds since 1970-01-01) into data(), returns size of formatted time
+				size_t format( const long long microseconds );
+				// now method: formats current UTC time (the same clock as microsec_clock::universal_time())
+				size_t now();
+				const char* data() const
+				{
+					return buffer_;
+				}
+				// thread_formatter method: formatter of calling thread
+				static timestamp_formatter& thread_formatter();
+			};
+
+			// streamer_buffer: formatting buffer of logger_streamer, message is formatted into string that keeps its capacity between messages
+			// every thread has its own buffer (acquire() method), so logger.note() << ... does not allocate memory for messages
+			// that are not bigger than capacity, bigger message grows string and string is shrinked back after message was written
+			// if thread buffer is busy (streamer is created while other streamer of this thread is alive) acquire() returns NULL
+			class streamer_buffer : public std::streambuf
+			{
+				std::string message_;
+				std::ostream stream_;
+				bool busy_;
+
+				explicit streamer_buffer( const streamer_buffer& );
+				streamer_buffer& operator=( const streamer_buffer& );
+			public:
+				static const size_t capacity = 1024;
+
+				explicit streamer_buffer();
+				virtual ~streamer_buffer();
+
+				// acquire method: returns thread buffer with empty message and default stream format flags, or NULL if thread buffer is busy
+				static streamer_buffer* acquire();
+				// release method: clears message, thread buffer could be acquired again
+				void release();
+				std::ostream& stream()
+				{
+					return stream_;
+				}
+				const std::string& message() const
+				{
+					return message_;
+				}
+				std::string& message()
+				{
+					return message_;
+				}
+			protected:
+				virtual int_type overflow( int_type c );
+				virtual std::streamsize xsputn( const char* s, std::streamsize n );
+			};
+
+			// null_stream function: stream of calling thread without buffer, output of disabled streamer goes there and is not formatted
+			std::ostream& null_stream();
+
+			// message_writer: writes message with prefix to stream, specialized in logger.cpp
+			template< bool turn_on, bool flush_stream, bool print_prefix >
+			struct message_writer
+			{
+				static void write( std::ostream& stream, const std::string& level_prefix, const std::string& message );
+			};
+
+			// format_message function: printf-style formatting into string, string capacity is used first, string grows only for bigger messages
+			// returns false if format is incorrect
+			bool format_message( std::string& to, const char* format, va_list arguments );
+
+			// format_arguments function: fmt-style formatting, "{}" is replaced by next argument, placeholders without arguments are written as is,
+			// extra arguments are ignored
+			inline void format_arguments( std::ostream& stream, const char* format )
+			{
+				stream << format;
+			}
+			template< class T, class... Args >
+			void format_arguments( std::ostream& stream, const char* format, const T& value, const Args&... args )
+			{
+				const char* placeholder = format;
+				while ( *placeholder && !( placeholder[ 0 ] == '{' && placeholder[ 1 ] == '}' ) )
+					++placeholder;
+				stream.write( format, placeholder - format );
+				if ( !*placeholder )
+					return;
+				stream << value;
+				format_arguments( stream, placeholder + 2, args... );
 			}
-			template< bool turn_on = true, bool flush_stream = true, bool print_prefix = true >
+			// placeholders_count function: amount of "{}" in string literal at compile time (range is divided to keep recursion depth small)
+			inline constexpr size_t placeholders_in_range( const char* format, const size_t begin, const size_t end )
+			{
+				return end - begin == 0 ? 0
+					: end - begin == 1 ? ( format[ begin ] == '{' && format[ begin + 1 ] == '}' ? 1 : 0 )
+					: placeholders_in_range( format, begin, ( begin + end ) / 2 ) + placeholders_in_range( format, ( begin + end ) / 2, end );
+			}
+			template< size_t N >
+			constexpr size_t placeholders_count( const char ( &format )[ N ] )
+			{
+				return placeholders_in_range( format, 0, N - 1 );
+			}
+			// arguments_count function: only for decltype
+			template< class... Args >
+			std::integral_constant< size_t, sizeof...( Args ) > arguments_count( const Args&... );
+
+			template< class defined_logger >
 			class logger_streamer
 			{
-				typedef system_utilities::common::logger< turn_on, flush_stream, print_prefix > defined_logger;
-				friend class system_utilities::common::logger< turn_on, flush_stream, print_prefix >;
-                
-				boost::shared_ptr< std::stringstream > stream_;
+				friend defined_logger;
+
+				// enabled_: level was enabled when streamer was created, disabled streamer has no buffer
+				const bool enabled_;
+				streamer_buffer* buffer_;
 				const message_level::value message_level_ ;
 				defined_logger& defined_logger_;
 				mutable bool destroy_;
+				// own_buffer_: buffer_ was allocated because thread buffer was busy
+				const bool own_buffer_;
 
 				explicit logger_streamer( defined_logger& logger, const message_level::value message_level )
-					: stream_( new std::stringstream )
+					: enabled_( defined_logger::enabled( message_level ) )
+					, buffer_( enabled_ ? streamer_buffer::acquire() : NULL )
 					, message_level_( message_level )
 					, defined_logger_( logger )
 					, destroy_( true )
+					, own_buffer_( enabled_ && buffer_ == NULL )
 				{
+					if ( own_buffer_ )
+						buffer_ = new streamer_buffer();
 				}
 
 			public:
 				logger_streamer( const logger_streamer& ls  )
-					: stream_( ls.stream_ )
+					: enabled_( ls.enabled_ )
+					, buffer_( ls.buffer_ )
 					, message_level_( ls.message_level_ )
 					, defined_logger_( ls.defined_logger_ )
+					, own_buffer_( ls.own_buffer_ )
 				{
 					ls.destroy_ = false;
 					destroy_ = true;
 				}
 
+				// operator<< method: does nothing if streamer is disabled, next arguments of the statement go to null_stream()
 				template< class element >
 				std::ostream& operator<<( const element& el )
 				{
-					std::stringstream& stream = (*stream_);
+					if ( !enabled_ )
+						return null_stream();
+					std::ostream& stream = buffer_->stream();
 					stream << el;
 					return stream;
 				}
 				~logger_streamer()
 				{
-					if ( destroy_ )
-						defined_logger_.write( message_level_, stream_->str() );
+					if ( !destroy_ || !enabled_ )
+						return;
+					defined_logger_.write( message_level_, buffer_->message() );
+					if ( own_buffer_ )
+						delete buffer_;
+					else
+						buffer_->release();
 				}
 			};
 
 		}
-		template< bool turn_on, bool flush_stream, bool print_prefix >
+		template< bool turn_on, bool flush_stream, bool print_prefix, details::message_level::value min_level >
 		class logger
 		{
+			typedef logger< turn_on, flush_stream, print_prefix, min_level > self_type;
 		public:
 			static const bool turn_on_value = turn_on;
 			static const bool flush_stream_value = flush_stream;
 			static const bool print_prefix_value = print_prefix;
+			static const details::message_level::value min_level_value = min_level;
 			static const size_t format_buffer_size = 10240;
 		protected:
-			typedef details::logger_streamer< turn_on, flush_stream, print_prefix > streamer;
-			friend class details::logger_streamer< turn_on, flush_stream, print_prefix >;
+			typedef details::logger_streamer< self_type > streamer;
+			friend class details::logger_streamer< self_type >;
 		public:
 			static std::string message_levels[ 5 ];
-		protected:
+			// init_message_levels method: fills message_levels, loggers that write prefix without logger instance (binary_logger) call it before use
 			static void init_message_levels()
 			{
 				if ( message_levels[0] == "" )
@@ -115,16 +282,16 @@ namespace system_utilities
 					message_levels[4] = ":FATAL  ]: ";
 				}
 			}
-
+		protected:
 			friend void tests_::common::logger_write_tests();
 
 			explicit logger();
-			void operator=( const logger< turn_on, flush_stream, print_prefix >& logger_copy );
+			void operator=( const self_type& logger_copy );
 
 			std::ostream& stream_;
 
 		private:
-			explicit logger( const logger< turn_on, flush_stream, print_prefix >& logger_copy )
+			explicit logger( const self_type& logger_copy )
 				: stream_( logger_copy.stream_ )
 			{
 				init_message_levels();
@@ -139,6 +306,12 @@ namespace system_utilities
 			virtual ~logger()
 			{
 			}
+			// enabled method: message of level would be written (level is compiled in and is not lower than runtime log level)
+			static inline bool enabled( const details::message_level::value value )
+			{
+				return turn_on && details::message_level::severity( value ) >= details::message_level::severity( min_level )
+					&& details::message_level::severity( value ) >= details::log_threshold::severity.load( std::memory_order_relaxed );
+			}
 			inline void flush()
 			{
 				stream_.flush();
@@ -152,12 +325,23 @@ namespace system_utilities
 			}
             inline void note( const std::string& message )
 			{
-			    write( details::message_level::note, message );
+				if ( enabled( details::message_level::note ) )
+					write( details::message_level::note, message );
+			}
+			inline void note( std::string&& message )
+			{
+				if ( enabled( details::message_level::note ) )
+					write( details::message_level::note, std::move( message ) );
 			}
 			inline streamer note()
 			{
 				return streamer( *this, details::message_level::note );
 			}
+			template< class T, class... Args >
+			inline void note( const char* format, const T& value, const Args&... args )
+			{
+				format_write( details::message_level::note, format, value, args... );
+			}
 			inline void formatted_warn( const char* format, ... )
 			{
 				va_list arguments;
@@ -167,12 +351,23 @@ namespace system_utilities
 			}
             inline void warn( const std::string& message )
 			{
-				write( details::message_level::warn, message );
+				if ( enabled( details::message_level::warn ) )
+					write( details::message_level::warn, message );
+			}
+			inline void warn( std::string&& message )
+			{
+				if ( enabled( details::message_level::warn ) )
+					write( details::message_level::warn, std::move( message ) );
 			}
 			inline streamer warn()
 			{
 				return streamer( *this, details::message_level::warn );
 			}
+			template< class T, class... Args >
+			inline void warn( const char* format, const T& value, const Args&... args )
+			{
+				format_write( details::message_level::warn, format, value, args... );
+			}
 			inline void formatted_error( const char* format, ... )
 			{
 				va_list arguments;
@@ -182,12 +377,23 @@ namespace system_utilities
 			}
             inline void error( const std::string& message )
 			{
-			    write( details::message_level::error, message );
+				if ( enabled( details::message_level::error ) )
+					write( details::message_level::error, message );
+			}
+			inline void error( std::string&& message )
+			{
+				if ( enabled( details::message_level::error ) )
+					write( details::message_level::error, std::move( message ) );
 			}
 			inline streamer error()
 			{
 				return streamer( *this, details::message_level::error );
 			}
+			template< class T, class... Args >
+			inline void error( const char* format, const T& value, const Args&... args )
+			{
+				format_write( details::message_level::error, format, value, args... );
+			}
 			inline void formatted_debug( const char* format, ... )
 			{
 				va_list arguments;
@@ -197,12 +403,23 @@ namespace system_utilities
 			}
 			inline void debug( const std::string& message )
 			{
-			    write( details::message_level::debug, message );
+				if ( enabled( details::message_level::debug ) )
+					write( details::message_level::debug, message );
+			}
+			inline void debug( std::string&& message )
+			{
+				if ( enabled( details::message_level::debug ) )
+					write( details::message_level::debug, std::move( message ) );
 			}
 			inline streamer debug()
 			{
 				return streamer( *this, details::message_level::debug );
 			}
+			template< class T, class... Args >
+			inline void debug( const char* format, const T& value, const Args&... args )
+			{
+				format_write( details::message_level::debug, format, value, args... );
+			}
 			inline void formatted_fatal( const char* format, ... )
 			{
 				va_list arguments;
@@ -212,29 +429,88 @@ namespace system_utilities
 			}
             inline void fatal( const std::string& message )
 			{
-				write( details::message_level::fatal, message );
+				if ( enabled( details::message_level::fatal ) )
+					write( details::message_level::fatal, message );
+			}
+			inline void fatal( std::string&& message )
+			{
+				if ( enabled( details::message_level::fatal ) )
+					write( details::message_level::fatal, std::move( message ) );
 			}
 			inline streamer fatal()
 			{
 				return streamer( *this, details::message_level::fatal );
 			}
+			template< class T, class... Args >
+			inline void fatal( const char* format, const T& value, const Args&... args )
+			{
+				format_write( details::message_level::fatal, format, value, args... );
+			}
 		protected:
+			// formatted_write method: message is formatted into thread buffer of streamer (see streamer_buffer), or into own string if it is busy
 			inline void formatted_write( const details::message_level::value value, const char* format, va_list arguments )
 			{
-				char buffer[ format_buffer_size ];
-				const int result = vsprintf( buffer, format, arguments );
-				if ( result >= 0 )
-					write( value, buffer );
+				if ( !enabled( value ) )
+					return;
+				details::streamer_buffer* const buffer = details::streamer_buffer::acquire();
+				std::string own_message;
+				std::string& message = buffer ? buffer->message() : own_message;
+				if ( details::format_message( message, format, arguments ) )
+					write( value, static_cast< const std::string& >( message ) );
 				else
 					write( details::message_level::fatal, "bad formatted message: '"+ std::string( format )+"'" );
+				if ( buffer )
+					buffer->release();
+			}
+			template< class... Args >
+			inline void format_write( const details::message_level::value value, const char* format, const Args&... args )
+			{
+				// level is checked once by streamer, runtime log level could be changed concurrently
+				streamer s( *this, value );
+				if ( s.enabled_ )
+					details::format_arguments( s.buffer_->stream(), format, args... );
 			}
 			virtual void write( const details::message_level::value value, const std::string& message );
+			// write method for temporary messages: loggers that keep message (queue_logger) could take it without copy
+			virtual void write( const details::message_level::value value, std::string&& message )
+			{
+				write( value, static_cast< const std::string& >( message ) );
+			}
 		};
+		template< bool turn_on, bool flush_stream, bool print_prefix, details::message_level::value min_level >
+		void logger< turn_on, flush_stream, print_prefix, min_level >::write( const details::message_level::value value, const std::string& message )
+		{
+			details::message_writer< turn_on, flush_stream, print_prefix >::write( stream_, message_levels[ value ], message );
+		}
 		//
-		template< bool turn_on, bool flush_stream, bool print_prefix >
-		std::string logger< turn_on, flush_stream, print_prefix >::message_levels[ 5 ];
+		template< bool turn_on, bool flush_stream, bool print_prefix, details::message_level::value min_level >
+		std::string logger< turn_on, flush_stream, print_prefix, min_level >::message_levels[ 5 ];
+		template< bool turn_on, bool flush_stream, bool print_prefix, details::message_level::value min_level >
+		const details::message_level::value logger< turn_on, flush_stream, print_prefix, min_level >::min_level_value;
 	}
 }
 
+// SYSTEM_UTILITIES_LOG( logger, level ) << ... : arguments are evaluated only if level is enabled for logger (see logger::enabled)
+#define SYSTEM_UTILITIES_LOG( logger_object, level ) \
+	if ( !( logger_object ).enabled( system_utilities::common::details::message_level::level ) ) {} else ( logger_object ).level()
+#define SYSTEM_UTILITIES_LOG_DEBUG( logger_object ) SYSTEM_UTILITIES_LOG( logger_object, debug )
+#define SYSTEM_UTILITIES_LOG_NOTE( logger_object ) SYSTEM_UTILITIES_LOG( logger_object, note )
+#define SYSTEM_UTILITIES_LOG_WARN( logger_object ) SYSTEM_UTILITIES_LOG( logger_object, warn )
+#define SYSTEM_UTILITIES_LOG_ERROR( logger_object ) SYSTEM_UTILITIES_LOG( logger_object, error )
+#define SYSTEM_UTILITIES_LOG_FATAL( logger_object ) SYSTEM_UTILITIES_LOG( logger_object, fatal )
+
+// SYSTEM_UTILITIES_LOG_FORMAT( logger, level, format, arguments... ) : fmt-style message, format should be string literal,
+// compilation fails if amount of "{}" in format is not equal to amount of arguments, arguments are evaluated only if level is enabled
+#define SYSTEM_UTILITIES_LOG_FORMAT( logger_object, level, ... ) \
+	do \
+	{ \
+		static_assert( system_utilities::common::details::placeholders_count( SYSTEM_UTILITIES_FIRST_ARGUMENT( __VA_ARGS__ ) ) + 1 == \
+			decltype( system_utilities::common::details::arguments_count( __VA_ARGS__ ) )::value, "amount of {} placeholders is not equal to amount of arguments" ); \
+		if ( ( logger_object ).enabled( system_utilities::common::details::message_level::level ) ) \
+			( logger_object ).level( __VA_ARGS__ ); \
+	} while ( false )
+#define SYSTEM_UTILITIES_FIRST_ARGUMENT( ... ) SYSTEM_UTILITIES_FIRST_ARGUMENT_( __VA_ARGS__, unused )
+#define SYSTEM_UTILITIES_FIRST_ARGUMENT_( first, ... ) first
+
 #endif // _SYSTEM_UTILITIES_COMMON_LOGGER_H_
 
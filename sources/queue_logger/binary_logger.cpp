@@ -0,0 +1,191 @@
+#include "binary_logger.h"
+
+#include <cstdio>
+
+namespace system_utilities
+{
+	namespace common
+	{
+		namespace
+		{
+			// append_argument: appends argument that starts from 'from' to line, returns pointer to next argument
+			const char* append_argument( std::string& line, const char* const from )
+			{
+				char buffer[ 32 ];
+				const char* const data = from + 1;
+				switch ( static_cast< details::binary_argument::type >( *from ) )
+				{
+				case details::binary_argument::signed_integer:
+					{
+						long long value = 0;
+						std::memcpy( &value, data, sizeof( value ) );
+						line.append( buffer, std::snprintf( buffer, sizeof( buffer ), "%lld", value ) );
+						return data + sizeof( value );
+					}
+				case details::binary_argument::unsigned_integer:
+					{
+						unsigned long long value = 0;
+						std::memcpy( &value, data, sizeof( value ) );
+						line.append( buffer, std::snprintf( buffer, sizeof( buffer ), "%llu", value ) );
+						return data + sizeof( value );
+					}
+				case details::binary_argument::floating_point:
+					{
+						double value = 0.0;
+						std::memcpy( &value, data, sizeof( value ) );
+						line.append( buffer, std::snprintf( buffer, sizeof( buffer ), "%g", value ) );
+						return data + sizeof( value );
+					}
+				case details::binary_argument::character:
+					line.push_back( *data );
+					return data + 1;
+				case details::binary_argument::boolean:
+					line.append( *data ? "true" : "false" );
+					return data + 1;
+				case details::binary_argument::string:
+					{
+						unsigned int size = 0;
+						std::memcpy( &size, data, sizeof( size ) );
+						line.append( data + sizeof( size ), size );
+						return data + sizeof( size ) + size;
+					}
+				case details::binary_argument::pointer:
+					{
+						const void* value = NULL;
+						std::memcpy( &value, data, sizeof( value ) );
+						line.append( buffer, std::snprintf( buffer, sizeof( buffer ), "%p", value ) );
+						return data + sizeof( value );
+					}
+				}
+				return data;
+			}
+		}
+
+		namespace details
+		{
+			size_t next_binary_logger_id()
+			{
+				static std::atomic< size_t > id( 0 );
+				return ++id;
+			}
+		}
+
+		const size_t binary_logger::default_ring_size;
+		const size_t binary_logger::default_idle_microseconds;
+
+		binary_logger::binary_logger( std::ostream& stream, const bool print_prefix, const size_t ring_size, const size_t idle_microseconds )
+			: stream_( stream )
+			, print_prefix_( print_prefix )
+			, ring_size_( ring_size )
+			, idle_timeout_( boost::posix_time::microseconds( idle_microseconds ) )
+			, id_( details::next_binary_logger_id() )
+			, dropped_( 0 )
+			, reported_dropped_( 0 )
+			, stopped_( false )
+		{
+			logger<>::init_message_levels();
+			thread_ = boost::thread( [this]() { process_(); } );
+		}
+		binary_logger::~binary_logger()
+		{
+			stopped_ = true;
+			// background thread could sleep for idle timeout
+			thread_.interrupt();
+			thread_.join();
+			flush();
+			for ( rings::iterator i = rings_.begin() ; i != rings_.end() ; ++i )
+				delete i->second;
+		}
+		void binary_logger::flush()
+		{
+			drain_();
+			boost::mutex::scoped_lock lock( drain_protector_ );
+			stream_.flush();
+		}
+		size_t binary_logger::dropped() const
+		{
+			return dropped_.load( std::memory_order_relaxed );
+		}
+		spsc_byte_ring& binary_logger::register_thread_()
+		{
+			boost::mutex::scoped_lock lock( rings_protector_ );
+			spsc_byte_ring*& ring = rings_[ boost::this_thread::get_id() ];
+			if ( !ring )
+				ring = new spsc_byte_ring( ring_size_ );
+			return *ring;
+		}
+		void binary_logger::process_()
+		{
+			while ( !stopped_ )
+			{
+				if ( drain_() )
+				{
+					boost::mutex::scoped_lock lock( drain_protector_ );
+					stream_.flush();
+				}
+				else
+					boost::this_thread::sleep( idle_timeout_ );
+			}
+		}
+		size_t binary_logger::drain_()
+		{
+			boost::mutex::scoped_lock lock( drain_protector_ );
+			size_t result = 0;
+			auto write_record = [this]( const char* const record ) { write_record_( record ); };
+			{
+				boost::mutex::scoped_lock rings_lock( rings_protector_ );
+				drained_rings_.clear();
+				for ( rings::iterator i = rings_.begin() ; i != rings_.end() ; ++i )
+					drained_rings_.push_back( i->second );
+			}
+			// rings are deleted only by destructor, so pointers stay valid without lock
+			for ( size_t i = 0 ; i < drained_rings_.size() ; ++i )
+				result += drained_rings_[ i ]->consume( write_record );
+			const size_t dropped = dropped_.load( std::memory_order_relaxed );
+			if ( dropped != reported_dropped_ )
+			{
+				char buffer[ 64 ];
+				const int size = std::snprintf( buffer, sizeof( buffer ), "%llu messages dropped", static_cast< unsigned long long >( dropped - reported_dropped_ ) );
+				reported_dropped_ = dropped;
+				details::binary_record record;
+				record.timestamp = std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::system_clock::now().time_since_epoch() ).count();
+				record.format = "{}";
+				record.level = details::message_level::warn;
+				char data[ sizeof( record ) + 1 + sizeof( unsigned int ) + sizeof( buffer ) ];
+				record.arguments_size = static_cast< unsigned int >( details::pack_binary_string( data + sizeof( record ), buffer, static_cast< unsigned int >( size ) ) - data - sizeof( record ) );
+				std::memcpy( data, &record, sizeof( record ) );
+				write_record_( data );
+				++result;
+			}
+			return result;
+		}
+		void binary_logger::write_record_( const char* const record_data )
+		{
+			details::binary_record record;
+			std::memcpy( &record, record_data, sizeof( record ) );
+			const char* argument = record_data + sizeof( record );
+			const char* const arguments_end = argument + record.arguments_size;
+			line_.clear();
+			if ( print_prefix_ )
+			{
+				details::timestamp_formatter& formatter = details::timestamp_formatter::thread_formatter();
+				const size_t time_size = formatter.format( record.timestamp );
+				line_.push_back( '[' );
+				line_.append( formatter.data(), time_size );
+				line_.append( logger<>::message_levels[ record.level ] );
+			}
+			for ( const char* f = record.format ; *f ; ++f )
+			{
+				if ( f[ 0 ] == '{' && f[ 1 ] == '}' && argument != arguments_end )
+				{
+					argument = append_argument( line_, argument );
+					++f;
+				}
+				else
+					line_.push_back( *f );
+			}
+			line_.push_back( '\n' );
+			stream_.write( line_.data(), static_cast< std::streamsize >( line_.size() ) );
+		}
+	}
+}
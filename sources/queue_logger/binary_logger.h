@@ -0,0 +1,331 @@
+#ifndef _SYSTEM_UTILITIES_COMMON_BINARY_LOGGER_H_
+#define _SYSTEM_UTILITIES_COMMON_BINARY_LOGGER_H_
+
+#include <atomic>
+#include <cstring>
+#include <map>
+#include <ostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <chrono>
+
+#include <boost/thread.hpp>
+
+#include <logger.h>
+#include <spsc_byte_ring.h>
+
+namespace system_utilities
+{
+	namespace common
+	{
+		// binary logger is an asynchronous logger for performance-dependent writing threads
+		// writing thread does not format message and does not allocate memory: it puts format pointer (it is an id of message), raw timestamp
+		// and packed arguments into its own single-producer single-consumer byte ring (spsc_byte_ring), one ring per writing thread per logger
+		// background thread reads rings, formats messages (prefix is the same as logger prefix) and writes them to stream
+		//
+		// you can use binary logger like: logger_.note( "order {} filled by {} at {}", id, trader_name, price );
+		// format should have static storage duration (string literal), "{}" is replaced by next argument
+		// arguments: integral types, floating point types, bool, char, const char*, std::string, pointers (strings are copied into ring)
+		// when ring of writing thread is full message is dropped (write returns false), background thread writes "N messages dropped" warning
+		// messages of one writing thread are written in write order, messages of different writing threads are not ordered by time
+		// ring of writing thread lives until logger is destroyed, so please use binary logger from long-living threads (thread pools)
+		// logger should not be destroyed while other threads write to it
+		// thread safe logger
+
+		namespace details
+		{
+			namespace binary_argument
+			{
+				enum type
+				{
+					signed_integer = 1,
+					unsigned_integer = 2,
+					floating_point = 3,
+					character = 4,
+					boolean = 5,
+					string = 6,
+					pointer = 7
+				};
+			}
+			// binary_record: head of message in byte ring, packed arguments (type byte + value) follow it
+			struct binary_record
+			{
+				long long timestamp;
+				const char* format;
+				unsigned int arguments_size;
+				unsigned int level;
+			};
+
+			inline char* pack_binary_value( char* const to, const binary_argument::type tag, const void* const value, const size_t size )
+			{
+				*to = static_cast< char >( tag );
+				std::memcpy( to + 1, value, size );
+				return to + 1 + size;
+			}
+			inline char* pack_binary_string( char* const to, const char* const value, const unsigned int size )
+			{
+				char* const data = pack_binary_value( to, binary_argument::string, &size, sizeof( size ) );
+				std::memcpy( data, value, size );
+				return data + size;
+			}
+
+			// binary_packer: size() and pack() of one argument, not supported argument types do not compile
+			template< class T, class enable = void >
+			struct binary_packer;
+
+			template< class T >
+			struct binary_packer< T, typename std::enable_if< std::is_integral< T >::value && std::is_signed< T >::value && !std::is_same< T, char >::value >::type >
+			{
+				static size_t size( const T& )
+				{
+					return 1 + sizeof( long long );
+				}
+				static char* pack( char* const to, const T& value )
+				{
+					const long long v = value;
+					return pack_binary_value( to, binary_argument::signed_integer, &v, sizeof( v ) );
+				}
+			};
+			template< class T >
+			struct binary_packer< T, typename std::enable_if< std::is_integral< T >::value && std::is_unsigned< T >::value && !std::is_same< T, bool >::value && !std::is_same< T, char >::value >::type >
+			{
+				static size_t size( const T& )
+				{
+					return 1 + sizeof( unsigned long long );
+				}
+				static char* pack( char* const to, const T& value )
+				{
+					const unsigned long long v = value;
+					return pack_binary_value( to, binary_argument::unsigned_integer, &v, sizeof( v ) );
+				}
+			};
+			template< class T >
+			struct binary_packer< T, typename std::enable_if< std::is_floating_point< T >::value >::type >
+			{
+				static size_t size( const T& )
+				{
+					return 1 + sizeof( double );
+				}
+				static char* pack( char* const to, const T& value )
+				{
+					const double v = static_cast< double >( value );
+					return pack_binary_value( to, binary_argument::floating_point, &v, sizeof( v ) );
+				}
+			};
+			template<>
+			struct binary_packer< char >
+			{
+				static size_t size( const char )
+				{
+					return 2;
+				}
+				static char* pack( char* const to, const char value )
+				{
+					return pack_binary_value( to, binary_argument::character, &value, 1 );
+				}
+			};
+			template<>
+			struct binary_packer< bool >
+			{
+				static size_t size( const bool )
+				{
+					return 2;
+				}
+				static char* pack( char* const to, const bool value )
+				{
+					const char v = value ? 1 : 0;
+					return pack_binary_value( to, binary_argument::boolean, &v, 1 );
+				}
+			};
+			// NULL string is written as empty string
+			template<>
+			struct binary_packer< const char* >
+			{
+				static size_t size( const char* const value )
+				{
+					return 1 + sizeof( unsigned int ) + ( value ? std::strlen( value ) : 0 );
+				}
+				static char* pack( char* const to, const char* const value )
+				{
+					return pack_binary_string( to, value, static_cast< unsigned int >( value ? std::strlen( value ) : 0 ) );
+				}
+			};
+			template<>
+			struct binary_packer< char* > : public binary_packer< const char* >
+			{
+			};
+			template< size_t N >
+			struct binary_packer< char[ N ] > : public binary_packer< const char* >
+			{
+			};
+			template<>
+			struct binary_packer< std::string >
+			{
+				static size_t size( const std::string& value )
+				{
+					return 1 + sizeof( unsigned int ) + value.size();
+				}
+				static char* pack( char* const to, const std::string& value )
+				{
+					return pack_binary_string( to, value.data(), static_cast< unsigned int >( value.size() ) );
+				}
+			};
+			template< class T >
+			struct binary_packer< T* >
+			{
+				static size_t size( const T* const )
+				{
+					return 1 + sizeof( const void* );
+				}
+				static char* pack( char* const to, const T* const value )
+				{
+					const void* const v = value;
+					return pack_binary_value( to, binary_argument::pointer, &v, sizeof( v ) );
+				}
+			};
+
+			inline size_t packed_size()
+			{
+				return 0;
+			}
+			template< class T, class... Args >
+			size_t packed_size( const T& value, const Args&... args )
+			{
+				return binary_packer< T >::size( value ) + packed_size( args... );
+			}
+			inline char* pack_arguments( char* const to )
+			{
+				return to;
+			}
+			template< class T, class... Args >
+			char* pack_arguments( char* const to, const T& value, const Args&... args )
+			{
+				return pack_arguments( binary_packer< T >::pack( to, value ), args... );
+			}
+
+			size_t next_binary_logger_id();
+		}
+
+		class binary_logger : protected virtual boost::noncopyable
+		{
+			static const size_t thread_cache_size = 4;
+
+			struct thread_ring
+			{
+				size_t logger_id;
+				spsc_byte_ring* ring;
+			};
+			struct thread_cache
+			{
+				thread_ring rings[ thread_cache_size ];
+				size_t next;
+			};
+			typedef std::map< boost::thread::id, spsc_byte_ring* > rings;
+
+			std::ostream& stream_;
+			const bool print_prefix_;
+			const size_t ring_size_;
+			const boost::posix_time::time_duration idle_timeout_;
+			const size_t id_;
+
+			boost::mutex rings_protector_;
+			rings rings_;
+			boost::mutex drain_protector_;
+			// rings are copied under rings_protector_ and consumed without it, so new threads are not blocked by formatting
+			std::vector< spsc_byte_ring* > drained_rings_;
+			std::string line_;
+
+			std::atomic< size_t > dropped_;
+			size_t reported_dropped_;
+
+			std::atomic< bool > stopped_;
+			boost::thread thread_;
+
+		public:
+			static const size_t default_ring_size = 64 * 1024;
+			static const size_t default_idle_microseconds = 1000;
+
+			// ring_size - size of byte ring of every writing thread (message could not be bigger than ring_size / 2)
+			// idle_microseconds - sleep time of background thread when all rings are empty
+			explicit binary_logger( std::ostream& stream, const bool print_prefix = true, const size_t ring_size = default_ring_size, const size_t idle_microseconds = default_idle_microseconds );
+			// !not a virtual destructor
+			// writes all messages that are in rings
+			~binary_logger();
+
+			template< class... Args >
+			bool note( const char* const format, const Args&... args )
+			{
+				return write( details::message_level::note, format, args... );
+			}
+			template< class... Args >
+			bool warn( const char* const format, const Args&... args )
+			{
+				return write( details::message_level::warn, format, args... );
+			}
+			template< class... Args >
+			bool error( const char* const format, const Args&... args )
+			{
+				return write( details::message_level::error, format, args... );
+			}
+			template< class... Args >
+			bool debug( const char* const format, const Args&... args )
+			{
+				return write( details::message_level::debug, format, args... );
+			}
+			template< class... Args >
+			bool fatal( const char* const format, const Args&... args )
+			{
+				return write( details::message_level::fatal, format, args... );
+			}
+			// write method: returns false if message was dropped (ring of writing thread is full)
+			// message with level lower than runtime log level (set_log_level) is not written, arguments are not packed
+			template< class... Args >
+			bool write( const details::message_level::value value, const char* const format, const Args&... args )
+			{
+				if ( details::message_level::severity( value ) < details::log_threshold::severity.load( std::memory_order_relaxed ) )
+					return true;
+				const size_t arguments_size = details::packed_size( args... );
+				spsc_byte_ring& ring = thread_ring_();
+				char* const to = ring.reserve( sizeof( details::binary_record ) + arguments_size );
+				if ( !to )
+				{
+					dropped_.fetch_add( 1, std::memory_order_relaxed );
+					return false;
+				}
+				details::binary_record record;
+				record.timestamp = std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::system_clock::now().time_since_epoch() ).count();
+				record.format = format;
+				record.arguments_size = static_cast< unsigned int >( arguments_size );
+				record.level = static_cast< unsigned int >( value );
+				std::memcpy( to, &record, sizeof( record ) );
+				details::pack_arguments( to + sizeof( record ), args... );
+				ring.commit();
+				return true;
+			}
+			// flush method: writes all messages that were written before call and flushes stream
+			void flush();
+			// dropped method: amount of messages that were dropped because of full ring
+			size_t dropped() const;
+
+		private:
+			spsc_byte_ring& thread_ring_()
+			{
+				static thread_local thread_cache cache = {};
+				for ( size_t i = 0 ; i < thread_cache_size ; ++i )
+					if ( cache.rings[ i ].logger_id == id_ )
+						return *cache.rings[ i ].ring;
+				thread_ring& slot = cache.rings[ cache.next++ % thread_cache_size ];
+				slot.logger_id = id_;
+				slot.ring = &register_thread_();
+				return *slot.ring;
+			}
+			spsc_byte_ring& register_thread_();
+			void process_();
+			size_t drain_();
+			void write_record_( const char* const record );
+		};
+	}
+}
+
+#endif // _SYSTEM_UTILITIES_COMMON_BINARY_LOGGER_H_
@@ -0,0 +1,187 @@
+#include "mpsc_logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iterator>
+
+namespace system_utilities
+{
+	namespace common
+	{
+		namespace
+		{
+			const size_t batch_size = 256;
+
+			long long now_microseconds()
+			{
+				return std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::system_clock::now().time_since_epoch() ).count();
+			}
+			// thread_timestamp: timestamp of thread does not go back, so messages of one thread are not reordered
+			long long thread_timestamp()
+			{
+				static thread_local long long last = 0;
+				const long long now = now_microseconds();
+				if ( now > last )
+					last = now;
+				return last;
+			}
+		}
+
+		const size_t mpsc_log_sink::queue_capacity;
+		const size_t mpsc_log_sink::default_reorder_microseconds;
+		const size_t mpsc_log_sink::record_pool_capacity;
+		const size_t mpsc_log_sink::max_reused_message_capacity;
+
+		mpsc_log_sink::mpsc_log_sink( std::ostream& stream, const bool print_prefix, const size_t reorder_microseconds )
+			: stream_( stream )
+			, print_prefix_( print_prefix )
+			, reorder_microseconds_( static_cast< long long >( reorder_microseconds ) )
+			, stopped_( false )
+		{
+			logger<>::init_message_levels();
+			batch_.reserve( batch_size );
+			thread_ = boost::thread( [this]() { process_(); } );
+		}
+		mpsc_log_sink::~mpsc_log_sink()
+		{
+			stopped_ = true;
+			queue_.stop();
+			thread_.join();
+			while ( record* const r = queue_.pop() )
+				take_( r );
+			write_all_();
+			stream_.flush();
+		}
+		void mpsc_log_sink::publish( const details::message_level::value value, const std::string& message )
+		{
+			record* const r = acquire_( value );
+			r->message.assign( message );
+			publish_( r );
+		}
+		void mpsc_log_sink::publish( const details::message_level::value value, std::string&& message )
+		{
+			record* const r = acquire_( value );
+			r->message = std::move( message );
+			publish_( r );
+		}
+		void mpsc_log_sink::flush()
+		{
+			// marker is taken by writer thread after all messages that were published before call
+			record marker;
+			marker.timestamp = 0;
+			marker.level = details::message_level::note;
+			marker.flush_marker = true;
+			marker.flushed = false;
+			if ( !queue_.push( &marker ) )
+				return;
+			boost::mutex::scoped_lock lock( flush_protector_ );
+			while ( !marker.flushed )
+				flushed_condition_.wait( lock );
+		}
+		mpsc_log_sink::record* mpsc_log_sink::acquire_( const details::message_level::value value )
+		{
+			record* r = free_records_.pop();
+			if ( !r )
+			{
+				r = new record;
+				r->flush_marker = false;
+				r->flushed = false;
+			}
+			r->level = value;
+			return r;
+		}
+		void mpsc_log_sink::publish_( record* const r )
+		{
+			r->timestamp = thread_timestamp();
+			if ( !queue_.push( r ) )
+				delete r;
+		}
+		void mpsc_log_sink::release_( record* const r )
+		{
+			// writer thread is the only one that pushes into free_records_, so push does not wait for free cell
+			if ( r->message.capacity() <= max_reused_message_capacity && free_records_.ts_size() < record_pool_capacity && free_records_.push( r ) )
+				return;
+			delete r;
+		}
+		void mpsc_log_sink::process_()
+		{
+			while ( !stopped_ )
+			{
+				batch_.clear();
+				// writer thread sleeps until message is published if there is nothing to write
+				if ( pending_.empty() )
+					queue_.wait_pop_bulk( std::back_inserter( batch_ ), batch_size );
+				else
+				{
+					const long long wait = std::max( pending_.begin()->first + reorder_microseconds_ - now_microseconds(), 1LL );
+					queue_.wait_pop_bulk( std::back_inserter( batch_ ), batch_size, std::chrono::microseconds( wait ) );
+				}
+				for ( size_t i = 0 ; i < batch_.size() ; ++i )
+					take_( batch_[ i ] );
+				write_ready_( now_microseconds() );
+			}
+		}
+		void mpsc_log_sink::take_( record* const r )
+		{
+			if ( r->flush_marker )
+			{
+				flush_( *r );
+				return;
+			}
+			pending_.insert( reorder_buffer::value_type( r->timestamp, r ) );
+			// reorder buffer is bounded by queue capacity, oldest message is written if it is full
+			if ( pending_.size() > queue_capacity )
+			{
+				write_( *pending_.begin()->second );
+				release_( pending_.begin()->second );
+				pending_.erase( pending_.begin() );
+			}
+		}
+		void mpsc_log_sink::write_ready_( const long long now )
+		{
+			bool written = false;
+			while ( !pending_.empty() && pending_.begin()->first + reorder_microseconds_ <= now )
+			{
+				write_( *pending_.begin()->second );
+				release_( pending_.begin()->second );
+				pending_.erase( pending_.begin() );
+				written = true;
+			}
+			if ( written )
+				stream_.flush();
+		}
+		void mpsc_log_sink::write_all_()
+		{
+			for ( reorder_buffer::iterator i = pending_.begin() ; i != pending_.end() ; ++i )
+			{
+				write_( *i->second );
+				release_( i->second );
+			}
+			pending_.clear();
+		}
+		void mpsc_log_sink::flush_( record& marker )
+		{
+			write_all_();
+			stream_.flush();
+			// marker lives on stack of flush(), it is not touched after notification
+			boost::mutex::scoped_lock lock( flush_protector_ );
+			marker.flushed = true;
+			flushed_condition_.notify_all();
+		}
+		void mpsc_log_sink::write_( const record& r )
+		{
+			line_.clear();
+			if ( print_prefix_ )
+			{
+				details::timestamp_formatter& formatter = details::timestamp_formatter::thread_formatter();
+				const size_t time_size = formatter.format( r.timestamp );
+				line_.push_back( '[' );
+				line_.append( formatter.data(), time_size );
+				line_.append( logger<>::message_levels[ r.level ] );
+			}
+			line_.append( r.message );
+			line_.push_back( '\n' );
+			stream_.write( line_.data(), static_cast< std::streamsize >( line_.size() ) );
+		}
+	}
+}
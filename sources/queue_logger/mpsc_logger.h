@@ -0,0 +1,132 @@
+#ifndef _SYSTEM_UTILITIES_COMMON_MPSC_LOGGER_H_
+#define _SYSTEM_UTILITIES_COMMON_MPSC_LOGGER_H_
+
+#include <atomic>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <boost/thread.hpp>
+
+#include <logger.h>
+#include <lock_free_queue.h>
+
+namespace system_utilities
+{
+	namespace common
+	{
+		// mpsc_log_sink: shared log sink of many writing threads and one writer thread
+		// writing thread takes timestamp and publishes finished message into lock-free multi-producer queue (lock_free_queue), no mutex on write path
+		// writer thread keeps messages in reorder buffer for reorder_microseconds and writes them ordered by timestamp (prefix is formatted by writer thread)
+		// messages of one thread are always written in write order (timestamps of thread do not go back, messages with equal timestamps keep publish order)
+		// messages of different threads are ordered by timestamp if message was published not later than reorder_microseconds after its timestamp,
+		// late message is written as soon as writer thread gets it
+		// push waits if queue is full (queue_capacity messages are not taken by writer thread yet)
+		// sink should not be destroyed while other threads write to it
+
+		class mpsc_log_sink : protected virtual boost::noncopyable
+		{
+		public:
+			static const size_t queue_capacity = 65536;
+			static const size_t default_reorder_microseconds = 1000;
+			// written records are reused by writing threads, so message is copied into buffer of reused record without allocation
+			static const size_t record_pool_capacity = 4096;
+			static const size_t max_reused_message_capacity = 1024;
+
+		private:
+			struct record
+			{
+				long long timestamp;
+				details::message_level::value level;
+				std::string message;
+				// flush marker is published by flush() from its stack, writer thread sets flushed after writing of all taken messages
+				bool flush_marker;
+				bool flushed;
+			};
+			typedef lock_free_queue< record, queue_capacity > queue;
+			typedef std::multimap< long long, record* > reorder_buffer;
+
+			std::ostream& stream_;
+			const bool print_prefix_;
+			const long long reorder_microseconds_;
+
+			queue queue_;
+			queue free_records_;
+			reorder_buffer pending_;
+			std::vector< record* > batch_;
+			std::string line_;
+
+			boost::mutex flush_protector_;
+			boost::condition flushed_condition_;
+
+			std::atomic< bool > stopped_;
+			boost::thread thread_;
+
+		public:
+			explicit mpsc_log_sink( std::ostream& stream, const bool print_prefix = true, const size_t reorder_microseconds = default_reorder_microseconds );
+			// !not a virtual destructor
+			// writes all published messages
+			~mpsc_log_sink();
+
+			// publish method: thread safe, copies message into reused record
+			void publish( const details::message_level::value value, const std::string& message );
+			// publish method: thread safe, takes message without copy
+			void publish( const details::message_level::value value, std::string&& message );
+			// flush method: writes all messages that were published before call (reorder window is not waited) and flushes stream
+			// does not wait for messages that are published by other threads after call
+			void flush();
+
+		private:
+			record* acquire_( const details::message_level::value value );
+			void publish_( record* const r );
+			void release_( record* const r );
+			void process_();
+			void take_( record* const r );
+			void flush_( record& marker );
+			void write_ready_( const long long now );
+			void write_all_();
+			void write_( const record& r );
+		};
+
+		// mpsc_logger: thread safe logger on mpsc_log_sink
+		// message is formatted by writing thread into its thread buffer (see logger_streamer) outside of any lock, and published into sink
+		// use it instead of ts_logger when many threads write to one log: threads do not wait for each other and for stream
+		// see mpsc_log_sink for messages order
+
+		template< bool print_prefix = true, details::message_level::value min_level = details::message_level::debug >
+		class mpsc_logger : public logger< true, false, print_prefix, min_level >
+		{
+			typedef logger< true, false, print_prefix, min_level > base_type;
+
+			mpsc_log_sink sink_;
+
+			explicit mpsc_logger( const mpsc_logger& );
+		public:
+			explicit mpsc_logger( std::ostream& stream, const size_t reorder_microseconds = mpsc_log_sink::default_reorder_microseconds )
+				: base_type( stream )
+				, sink_( stream, print_prefix, reorder_microseconds )
+			{
+			}
+			virtual ~mpsc_logger()
+			{
+			}
+			// flush method: writes all messages that were written before call and flushes stream
+			void flush()
+			{
+				sink_.flush();
+			}
+		protected:
+			virtual void write( const details::message_level::value value, const std::string& message )
+			{
+				sink_.publish( value, message );
+			}
+			virtual void write( const details::message_level::value value, std::string&& message )
+			{
+				sink_.publish( value, std::move( message ) );
+			}
+		};
+	}
+}
+
+#endif // _SYSTEM_UTILITIES_COMMON_MPSC_LOGGER_H_
@@ -1,9 +1,14 @@
 #ifndef _SYSTEM_UTILITIES_COMMON_QUEUE_LOGGER_H_
 #define _SYSTEM_UTILITIES_COMMON_QUEUE_LOGGER_H_
 
+#include <atomic>
+#include <string>
+
 #include <logger.h>
 #include <task_processor.h>
 
+#include <boost/lexical_cast.hpp>
+
 namespace system_utilities
 {
 	namespace tests_
@@ -19,29 +24,42 @@ namespace system_utilities
 		// use this class if you need as most performance write as only possible (to write a big ammount of messages)
 		// better to set print_prefix = false
 		// better to set flush_stream = false
+		// task_queue - queue that tasker uses, one parameter template (see details::default_logger_queue)
+		// for example: template< class T > using lock_free_logger_queue = lock_free_queue< T, 4096 >;
+		// task_allocator - allocator of logger tasks, one parameter template, pool_allocator removes malloc/free per message
+		// min_level - messages with lower level are removed at compile time, as min_level of logger
+		// bounded tasker (tasker::set_capacity) could drop messages, when tasker stops dropping, next write adds warning "N messages dropped"
+		// to the log (drops are counted per tasker, so every queue_logger of shared tasker reports them)
 		// thread safe logger
 
-		template< bool turn_on = true, bool flush_stream = true, bool print_prefix = true >
+		namespace details
+		{
+			template< class T >
+			using default_logger_queue = ts_queue< T >;
+		}
+
+		template< bool turn_on = true, bool flush_stream = true, bool print_prefix = true, template< class > class task_queue = details::default_logger_queue, template< class > class task_allocator = std::allocator, details::message_level::value min_level = details::message_level::debug >
 		class queue_logger;
 
 		namespace details
 		{
-			template< bool turn_on, bool flush_stream, bool print_prefix >
+			template< bool turn_on, bool flush_stream, bool print_prefix, template< class > class task_queue, template< class > class task_allocator, details::message_level::value min_level >
 			class queue_logger_task
 			{
-				typedef queue_logger< turn_on, flush_stream, print_prefix > logger;
-				friend class queue_logger< turn_on, flush_stream, print_prefix >;
-				typedef queue_logger_task< turn_on, flush_stream, print_prefix > self_task;
-				friend class task_processor< self_task >;
+				typedef queue_logger< turn_on, flush_stream, print_prefix, task_queue, task_allocator, min_level > logger;
+				friend class queue_logger< turn_on, flush_stream, print_prefix, task_queue, task_allocator, min_level >;
+				typedef queue_logger_task< turn_on, flush_stream, print_prefix, task_queue, task_allocator, min_level > self_task;
+				template< class, class, class, size_t, bool >
+				friend class system_utilities::common::task_processor;
 
 				logger& logger_;
 
 				const message_level::value message_level_;
 				const std::string message_;
-				explicit queue_logger_task( logger& l, const message_level::value message_level, const std::string& message )
+				explicit queue_logger_task( logger& l, const message_level::value message_level, std::string&& message )
 					: logger_( l )
 					, message_level_( message_level )
-					, message_( message )
+					, message_( std::move( message ) )
 				{
 				}
 			public:
@@ -54,26 +72,33 @@ namespace system_utilities
 				}
 			};
 		}
-		template< bool turn_on, bool flush_stream, bool print_prefix >
-		class queue_logger : public logger< turn_on, flush_stream, print_prefix >
+		template< bool turn_on, bool flush_stream, bool print_prefix, template< class > class task_queue, template< class > class task_allocator, details::message_level::value min_level >
+		class queue_logger : public logger< turn_on, flush_stream, print_prefix, min_level >
 		{
-			typedef details::queue_logger_task< turn_on, flush_stream, print_prefix > logger_task;
-			friend class details::queue_logger_task< turn_on, flush_stream, print_prefix >;
+			typedef details::queue_logger_task< turn_on, flush_stream, print_prefix, task_queue, task_allocator, min_level > logger_task;
+			friend class details::queue_logger_task< turn_on, flush_stream, print_prefix, task_queue, task_allocator, min_level >;
 		public:
-			typedef task_processor< logger_task > tasker;
+			typedef task_processor< logger_task, task_queue< logger_task >, task_allocator< logger_task > > tasker;
 		private:
 			mutable boost::mutex protect_write_;
 			tasker& task_processor_;
+			// observed_dropped_: tasker dropped() at previous write, reported_dropped_: dropped() value that was reported last time
+			std::atomic< size_t > observed_dropped_;
+			std::atomic< size_t > reported_dropped_;
 		protected:
 			explicit queue_logger( const queue_logger& copy_from )
 				: protect_write_()
 				, task_processor_( copy_from.task_processor_ )
+				, observed_dropped_( copy_from.observed_dropped_.load() )
+				, reported_dropped_( copy_from.reported_dropped_.load() )
 			{
 			}
 		public:
 			explicit queue_logger( std::ostream& out, tasker& tp )
-				: logger< turn_on, flush_stream, print_prefix >( out )
+				: logger< turn_on, flush_stream, print_prefix, min_level >( out )
 				, task_processor_( tp )
+				, observed_dropped_( tp.dropped() )
+				, reported_dropped_( tp.dropped() )
 			{
 			}
 			virtual ~queue_logger()
@@ -82,14 +107,34 @@ namespace system_utilities
 		private:
 			void write( const details::message_level::value value, const std::string& message )
 			{
-				logger_task* task = task_processor_.create_task( *this, value, message );
-				if (!task_processor_.add_task( task ))
-					delete task;
+				task_processor_.emplace_task( *this, value, std::string( message ) );
+				report_dropped_();
+			}
+			// message is moved into logger task (streamer and formatted messages go here)
+			void write( const details::message_level::value value, std::string&& message )
+			{
+				task_processor_.emplace_task( *this, value, std::move( message ) );
+				report_dropped_();
+			}
+			// report_dropped_ method: tasker recovered if nothing was dropped since previous write
+			// shared counters are only read while nothing is dropped, so writing threads do not contend on their cache line
+			void report_dropped_()
+			{
+				const size_t dropped = task_processor_.dropped();
+				if ( observed_dropped_.load( std::memory_order_relaxed ) != dropped )
+				{
+					observed_dropped_.store( dropped, std::memory_order_relaxed );
+					return;
+				}
+				size_t reported = reported_dropped_.load( std::memory_order_relaxed );
+				if ( reported == dropped || !reported_dropped_.compare_exchange_strong( reported, dropped ) )
+					return;
+				task_processor_.emplace_task( *this, details::message_level::warn, boost::lexical_cast< std::string >( dropped - reported ) + " messages dropped" );
 			}
 			void real_write( const details::message_level::value value, const std::string& message )
 			{
 				boost::mutex::scoped_lock lock( protect_write_ );
-				logger< turn_on, flush_stream, print_prefix >::write( value, message );
+				logger< turn_on, flush_stream, print_prefix, min_level >::write( value, message );
 			}
 		};
 	}
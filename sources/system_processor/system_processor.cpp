@@ -40,6 +40,7 @@ namespace system_utilities
 				//
 				sp_impl::sp_impl( const std::string& binary_path )
 					: stopping_( false )
+					, stats_stopping_( false )
 				{
 					check_binary_path( binary_path );
 					logs_path_ = logs_path_ = binary_path_ + "logs/";
@@ -47,6 +48,7 @@ namespace system_utilities
 				}
 				sp_impl::sp_impl( const std::string& binary_path, const std::string& config_path )
 					: stopping_( false )
+					, stats_stopping_( false )
 				{
 					check_binary_path( binary_path );
 					std::string config_full_path = config_path;
@@ -106,7 +108,7 @@ namespace system_utilities
 					std::string system_logger_name = "_engine.log";
 					if ( properties_.get() )
 						system_logger_name = properties_->get_value( "System.log.name", system_logger_name );
-					engine_logger_.reset( new file_logger<>( logs_path_ + system_logger_name, std::ios_base::app ) );
+					engine_logger_.reset( new engine_logger( logs_path_ + system_logger_name, std::ios_base::app ) );
 				}
 				void sp_impl::load_predefined_logs_settings()
 				{
@@ -117,15 +119,80 @@ namespace system_utilities
 						engine_logger_->note( "System.stop_by_ctrl_c is set to yes" );
 						add_exit_handlers();
 					}
+					if ( properties_->check_value( "System.log.level" ) )
+					{
+						const std::string level_name = properties_->get_value( "System.log.level", "debug" );
+						common::details::message_level::value level = common::details::message_level::debug;
+						if ( !parse_log_level( level_name, level ) )
+							throw std::logic_error( "System.log.level setting: " + level_name + " incorrect. it should be debug, note, warn, error or fatal" );
+						engine_logger_->note( "System.log.level is set to " + level_name );
+						set_log_level( level );
+					}
+					if ( properties_->check_value( "System.threads.affinity" ) )
+					{
+						const std::string affinity = properties_->get_value( "System.threads.affinity", "none" );
+						try
+						{
+							thread_affinity::from_string( affinity );
+						}
+						catch ( const std::exception& ex )
+						{
+							throw std::logic_error( "System.threads.affinity setting: " + affinity + " incorrect (" + ex.what() + "). it should be none, compact, scatter, numa_node or cpu list" );
+						}
+						engine_logger_->note( "System.threads.affinity is set to " + affinity );
+					}
+					const size_t stats_period = properties_->get_value( "System.stats.period", size_t( 0 ) );
+					if ( stats_period )
+					{
+						engine_logger_->note( "System.stats.period is set to " + properties_->get_value( "System.stats.period", "0" ) + " milliseconds" );
+						start_stats_reporter( stats_period );
+					}
 				}
 				void sp_impl::add_exit_handlers()
 				{
 					signal( SIGINT, exit_handler );
 					signal( SIGTERM, exit_handler );
 				}
+				void sp_impl::start_stats_reporter( const size_t period_milliseconds )
+				{
+					stats_reporter_.reset( new boost::thread( boost::bind( &sp_impl::stats_reporting, this, period_milliseconds ) ) );
+				}
+				void sp_impl::stop_stats_reporter()
+				{
+					if ( !stats_reporter_ )
+						return;
+					{
+						boost::mutex::scoped_lock lock( stats_protector_ );
+						stats_stopping_ = true;
+						stats_waiter_.notify_all();
+					}
+					stats_reporter_->join();
+					stats_reporter_.reset();
+				}
+				void sp_impl::stats_reporting( const size_t period_milliseconds )
+				{
+					boost::mutex::scoped_lock lock( stats_protector_ );
+					boost::system_time next = boost::get_system_time() + boost::posix_time::milliseconds( period_milliseconds );
+					while ( !stats_stopping_ )
+					{
+						if ( stats_waiter_.timed_wait( lock, next ) )
+							continue;
+						write_stats();
+						next = boost::get_system_time() + boost::posix_time::milliseconds( period_milliseconds );
+					}
+				}
+				// should be called under stats_protector_ lock, so removed provider could not be called
+				void sp_impl::write_stats()
+				{
+					if ( !engine_logger_ )
+						return;
+					for ( stats_providers::const_iterator i = stats_providers_.begin() ; i != stats_providers_.end() ; ++i )
+						engine_logger_->stats( "stats " + i->first + ": " + i->second() );
+				}
 				//
 				sp_impl::~sp_impl()
 				{
+					stop_stats_reporter();
 					boost::mutex::scoped_lock lock( instance_protector_ );
 					instance_ = NULL;
 				}
@@ -320,6 +387,43 @@ namespace system_utilities
 			{
 				return details::config_check_value( name );
 			}
+			//
+			thread_affinity threads_affinity()
+			{
+				{
+					boost::mutex::scoped_lock lock( details::sp_impl::instance_protector_ );
+					if ( !details::sp_impl::instance_ )
+						throw std::logic_error( "system processor was not create, call init first" );
+					if ( !details::sp_impl::instance_->properties_.get() )
+						return thread_affinity();
+				}
+				return thread_affinity::from_string( config( "System.threads.affinity", "none" ) );
+			}
+			//
+			void add_stats_provider( const std::string& name, const stats_provider& provider )
+			{
+				boost::mutex::scoped_lock lock( details::sp_impl::instance_protector_ );
+				if ( !details::sp_impl::instance_ )
+					throw std::logic_error( "system processor was not create, call init first" );
+				boost::mutex::scoped_lock stats_lock( details::sp_impl::instance_->stats_protector_ );
+				details::sp_impl::instance_->stats_providers_[ name ] = provider;
+			}
+			void remove_stats_provider( const std::string& name )
+			{
+				boost::mutex::scoped_lock lock( details::sp_impl::instance_protector_ );
+				if ( !details::sp_impl::instance_ )
+					throw std::logic_error( "system processor was not create, call init first" );
+				boost::mutex::scoped_lock stats_lock( details::sp_impl::instance_->stats_protector_ );
+				details::sp_impl::instance_->stats_providers_.erase( name );
+			}
+			void dump_stats()
+			{
+				boost::mutex::scoped_lock lock( details::sp_impl::instance_protector_ );
+				if ( !details::sp_impl::instance_ )
+					throw std::logic_error( "system processor was not create, call init first" );
+				boost::mutex::scoped_lock stats_lock( details::sp_impl::instance_->stats_protector_ );
+				details::sp_impl::instance_->write_stats();
+			}
 
 		}
 	}
@@ -3,7 +3,12 @@
 
 #include <property_reader.h>
 #include <file_logger.h>
+#include <thread_affinity.h>
 
+#include <map>
+
+#include <boost/bind.hpp>
+#include <boost/function.hpp>
 #include <boost/noncopyable.hpp>
 #include <boost/thread.hpp>
 #include <boost/thread/condition.hpp>
@@ -35,7 +40,10 @@ namespace system_utilities
 			// You can use into your configuration file next strings:
 			// * System.log.path = logs (will save all logs to 'logs' folder )
 			// * System.log.name = engine.log - will create engine log file, with settings (system log file)
+			// * System.log.level = warn - runtime log level of all loggers: debug, note, warn, error or fatal (see set_log_level() of logger module)
 			// * System.stop_by_ctrl_c = true - this settings says - that ctrl+c - should call stop() method and stop application
+			// * System.threads.affinity = compact - placement of task_processor threads: none, compact, scatter, numa_node or cpu list like 0,2,4-7 (see threads_affinity())
+			// * System.stats.period = 10000 - every 10000 milliseconds statistics of added stats providers are written to engine log regardless of System.log.level (0 or absent - turned off, see add_stats_provider())
 			// * include new_file.ini - will include new_file.ini as a part of config
 		
 			namespace details
@@ -73,6 +81,22 @@ namespace system_utilities
 			bool config_rename_parameter( const std::string& old_name, const std::string& new_name );
 			//
 			bool config_check_value( const std::string& name );
+			//
+			// threads_affinity method: System.threads.affinity setting, could be given to task_processor constructor
+			// returns affinity_policy::none if setting is absent, throws std::logic_error on bad setting
+			thread_affinity threads_affinity();
+			//
+			// stats_provider: returns one line statistics description, is called by stats reporting thread
+			typedef boost::function< std::string () > stats_provider;
+			// add_stats_provider method: provider with the same name is replaced
+			void add_stats_provider( const std::string& name, const stats_provider& provider );
+			// remove_stats_provider method: provider is not called after return, call it before provider owner is destroyed
+			void remove_stats_provider( const std::string& name );
+			// dump_stats method: writes statistics of all providers to engine log immediately
+			void dump_stats();
+
+			template< class processor >
+			void add_task_processor_stats( const std::string& name, const processor& tp );
 
 			namespace details
 			{
@@ -89,6 +113,21 @@ namespace system_utilities
 
 				property_reader::strings config_values_impl( const std::string& name, const std::string& delimeters = "," );
 
+				// engine_logger: engine log of system processor, statistics is written to it regardless of runtime log level
+				class engine_logger : public file_logger<>
+				{
+				public:
+					explicit engine_logger( const std::string& file_path, std::ios_base::openmode mode )
+						: file_logger<>( file_path, mode )
+					{
+					}
+					// stats method: writes note message even if System.log.level is higher than note
+					void stats( const std::string& message )
+					{
+						write( common::details::message_level::note, message );
+					}
+				};
+
 				class sp_impl : protected virtual boost::noncopyable
 				{
 					friend void tests_::common::system_processor_constructor_tests();
@@ -122,13 +161,17 @@ namespace system_utilities
 					//
 					friend std::string system_processor::binary_path();
 					friend std::string system_processor::logs_path();
+					friend thread_affinity system_processor::threads_affinity();
+					friend void system_processor::add_stats_provider( const std::string& name, const stats_provider& provider );
+					friend void system_processor::remove_stats_provider( const std::string& name );
+					friend void system_processor::dump_stats();
 
 					//
 					static boost::mutex instance_protector_;
 					static sp_impl* instance_;
 				public:
 					boost::shared_ptr< property_reader > properties_;
-					boost::shared_ptr< file_logger<> > engine_logger_;
+					boost::shared_ptr< engine_logger > engine_logger_;
 				private:
 					mutable boost::mutex stop_protector_;
 					mutable boost::condition stop_waiter_;
@@ -137,6 +180,13 @@ namespace system_utilities
 					std::string binary_path_;
 					std::string logs_path_;
 
+					typedef std::map< std::string, stats_provider > stats_providers;
+					mutable boost::mutex stats_protector_;
+					boost::condition stats_waiter_;
+					stats_providers stats_providers_;
+					bool stats_stopping_;
+					boost::shared_ptr< boost::thread > stats_reporter_;
+
 					static std::string parse_config_file_name(const int argc, char* const argv[]);
 
 					explicit sp_impl( const std::string& binary_path );
@@ -148,6 +198,10 @@ namespace system_utilities
 					void create_system_logger();
 					void load_predefined_logs_settings();
 					void add_exit_handlers();
+					void start_stats_reporter( const size_t period_milliseconds );
+					void stop_stats_reporter();
+					void stats_reporting( const size_t period_milliseconds );
+					void write_stats();
 					//
 				public:
 					~sp_impl();
@@ -205,6 +259,12 @@ namespace system_utilities
 					details::sp_impl::instance_->properties_->reset_value( name, default_value );
 				}
 				property_reader::strings config_values_impl( const std::string& name, const std::string& delimeters );
+
+				template< class processor >
+				std::string task_processor_stats_string( const processor* const tp )
+				{
+					return tp->stats().to_string();
+				}
 			}
 			//
 			template< class result_type >
@@ -226,6 +286,12 @@ namespace system_utilities
 				details::config_reset_value< value_type >( name, default_value );
 			}
 			
+			// add_task_processor_stats method: adds stats provider for task_processor with statistics turned on (see task_statistics.h)
+			template< class processor >
+			void add_task_processor_stats( const std::string& name, const processor& tp )
+			{
+				add_stats_provider( name, boost::bind( &details::task_processor_stats_string< processor >, &tp ) );
+			}
 			//
 			template< class T >
 			boost::shared_ptr< file_logger< T > > create_log( const std::string& file_name )
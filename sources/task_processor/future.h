@@ -0,0 +1,427 @@
+#ifndef _SYSTEM_UTILITIES_COMMON_FUTURE_H_
+#define _SYSTEM_UTILITIES_COMMON_FUTURE_H_
+
+#include <atomic>
+#include <chrono>
+#include <exception>
+#include <iterator>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/thread_time.hpp>
+
+#include <deadline.h>
+
+namespace system_utilities
+{
+	// future: result of task_processor::submit(), lightweight replacement of std::future
+	// shared state (result, exception, callable) is allocated once per submit and is reference counted by future and task
+	// exception that goes out of callable is stored into shared state and rethrown by future::get()
+	// if task was destroyed without processing (task_processor was stopped) get() throws broken_task exception
+	// when_all( first, last ) returns future< void > that is ready when all futures of range are ready (fan-out/fan-in jobs), all futures should be valid
+
+	namespace common
+	{
+		// broken_task: exception of future which task was not processed
+		class broken_task : public std::logic_error
+		{
+		public:
+			explicit broken_task()
+				: std::logic_error( "task was destroyed without processing" )
+			{
+			}
+		};
+
+		template< class R >
+		class future;
+
+		namespace details
+		{
+			// completion_listener: intrusive node of shared state listeners list, completed() is called once, after shared state becomes ready
+			class completion_listener
+			{
+			public:
+				completion_listener* next_listener;
+				explicit completion_listener()
+					: next_listener( NULL )
+				{
+				}
+				virtual void completed() = 0;
+			protected:
+				~completion_listener()
+				{
+				}
+			};
+
+			class shared_state_base
+			{
+				explicit shared_state_base( const shared_state_base& );
+				shared_state_base& operator=( const shared_state_base& );
+
+				std::atomic< size_t > references_;
+				mutable boost::mutex protector_;
+				mutable boost::condition_variable ready_condition_;
+				bool ready_;
+				std::exception_ptr exception_;
+				completion_listener* listeners_;
+
+			protected:
+				explicit shared_state_base()
+					: references_( 1 )
+					, ready_( false )
+					, listeners_( NULL )
+				{
+				}
+				virtual ~shared_state_base()
+				{
+				}
+				// should be called once, after result was stored
+				void set_ready_()
+				{
+					completion_listener* listeners = NULL;
+					{
+						boost::mutex::scoped_lock lock( protector_ );
+						ready_ = true;
+						listeners = listeners_;
+						listeners_ = NULL;
+						ready_condition_.notify_all();
+					}
+					while ( listeners )
+					{
+						completion_listener* const next = listeners->next_listener;
+						listeners->completed();
+						listeners = next;
+					}
+				}
+			public:
+				// run method: calls stored callable and stores its result or exception
+				virtual void run()
+				{
+				}
+				void add_reference()
+				{
+					references_.fetch_add( 1, std::memory_order_relaxed );
+				}
+				void release()
+				{
+					if ( references_.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+						delete this;
+				}
+				void set_exception( const std::exception_ptr& exception )
+				{
+					exception_ = exception;
+					set_ready_();
+				}
+				// abandon method: task was destroyed without run()
+				void abandon()
+				{
+					set_exception( std::make_exception_ptr( broken_task() ) );
+				}
+				bool ready() const
+				{
+					boost::mutex::scoped_lock lock( protector_ );
+					return ready_;
+				}
+				void wait() const
+				{
+					boost::mutex::scoped_lock lock( protector_ );
+					while ( !ready_ )
+						ready_condition_.wait( lock );
+				}
+				bool timed_wait( const boost::system_time& deadline ) const
+				{
+					boost::mutex::scoped_lock lock( protector_ );
+					while ( !ready_ )
+						if ( !ready_condition_.timed_wait( lock, deadline ) )
+							return ready_;
+					return true;
+				}
+				// listener is called immediately if state is ready
+				void add_listener( completion_listener* const listener )
+				{
+					{
+						boost::mutex::scoped_lock lock( protector_ );
+						if ( !ready_ )
+						{
+							listener->next_listener = listeners_;
+							listeners_ = listener;
+							return;
+						}
+					}
+					listener->completed();
+				}
+				// should be called after wait()
+				void rethrow_exception() const
+				{
+					if ( exception_ )
+						std::rethrow_exception( exception_ );
+				}
+			};
+
+			template< class R >
+			class shared_state : public shared_state_base
+			{
+				typename std::aligned_storage< sizeof( R ), std::alignment_of< R >::value >::type value_;
+				bool has_value_;
+			protected:
+				explicit shared_state()
+					: has_value_( false )
+				{
+				}
+				virtual ~shared_state()
+				{
+					if ( has_value_ )
+						reinterpret_cast< R* >( &value_ )->~R();
+				}
+			public:
+				template< class V >
+				void set_value( V&& value )
+				{
+					::new( static_cast< void* >( &value_ ) ) R( std::forward< V >( value ) );
+					has_value_ = true;
+					set_ready_();
+				}
+				// should be called after wait(), moves result out of state
+				R take_value()
+				{
+					rethrow_exception();
+					return std::move( *reinterpret_cast< R* >( &value_ ) );
+				}
+			};
+
+			template<>
+			class shared_state< void > : public shared_state_base
+			{
+			protected:
+				explicit shared_state()
+				{
+				}
+			public:
+				void set_value()
+				{
+					set_ready_();
+				}
+				void take_value()
+				{
+					rethrow_exception();
+				}
+			};
+
+			// function_state: shared state that owns callable
+			template< class R, class F >
+			class function_state : public shared_state< R >
+			{
+				F function_;
+			public:
+				explicit function_state( F&& function )
+					: function_( std::move( function ) )
+				{
+				}
+				virtual void run()
+				{
+					try
+					{
+						this->set_value( function_() );
+					}
+					catch( ... )
+					{
+						this->set_exception( std::current_exception() );
+					}
+				}
+			};
+
+			template< class F >
+			class function_state< void, F > : public shared_state< void >
+			{
+				F function_;
+			public:
+				explicit function_state( F&& function )
+					: function_( std::move( function ) )
+				{
+				}
+				virtual void run()
+				{
+					try
+					{
+						function_();
+						this->set_value();
+					}
+					catch( ... )
+					{
+						this->set_exception( std::current_exception() );
+					}
+				}
+			};
+
+			// when_all_state: becomes ready when all watched states are ready
+			class when_all_state : public shared_state< void >
+			{
+				class watcher : public completion_listener
+				{
+					when_all_state* owner_;
+				public:
+					explicit watcher()
+						: owner_( NULL )
+					{
+					}
+					void watch( when_all_state* const owner, shared_state_base* const state )
+					{
+						owner_ = owner;
+						owner_->add_reference();
+						state->add_listener( this );
+					}
+					virtual void completed()
+					{
+						when_all_state* const owner = owner_;
+						owner->one_completed_();
+						owner->release();
+					}
+				};
+
+				std::vector< watcher > watchers_;
+				std::atomic< size_t > remaining_;
+
+				void one_completed_()
+				{
+					if ( remaining_.fetch_sub( 1, std::memory_order_acq_rel ) == 1 )
+						set_value();
+				}
+			public:
+				explicit when_all_state( const size_t size )
+					: watchers_( size )
+					, remaining_( size + 1 )
+				{
+				}
+				void watch( const size_t index, shared_state_base* const state )
+				{
+					watchers_[ index ].watch( this, state );
+				}
+				// should be called after all watch() calls
+				void watch_finished()
+				{
+					one_completed_();
+				}
+			};
+		}
+
+		// function_task: task type of task_processor that runs callables given to task_processor::submit()
+		// use task_processor< function_task > (allocator could be pool_allocator< function_task >)
+		class function_task
+		{
+			explicit function_task( const function_task& );
+			function_task& operator=( const function_task& );
+
+			details::shared_state_base* const state_;
+			bool processed_;
+		public:
+			// function_task takes one reference of state
+			explicit function_task( details::shared_state_base* state )
+				: state_( state )
+				, processed_( false )
+			{
+			}
+			~function_task()
+			{
+				if ( !processed_ )
+					state_->abandon();
+				state_->release();
+			}
+			void operator()()
+			{
+				processed_ = true;
+				state_->run();
+			}
+		};
+
+		template< class R >
+		class future
+		{
+			template< class iterator >
+			friend future< void > when_all( iterator first, iterator last );
+
+			explicit future( const future& );
+			future& operator=( const future& );
+
+			details::shared_state< R >* state_;
+		public:
+			typedef R value_type;
+
+			explicit future()
+				: state_( NULL )
+			{
+			}
+			// takes one reference of state
+			explicit future( details::shared_state< R >* state )
+				: state_( state )
+			{
+			}
+			future( future&& other )
+				: state_( other.state_ )
+			{
+				other.state_ = NULL;
+			}
+			future& operator=( future&& other )
+			{
+				if ( this != &other )
+				{
+					if ( state_ )
+						state_->release();
+					state_ = other.state_;
+					other.state_ = NULL;
+				}
+				return *this;
+			}
+			~future()
+			{
+				if ( state_ )
+					state_->release();
+			}
+			bool valid() const
+			{
+				return state_ != NULL;
+			}
+			bool ready() const
+			{
+				return state_->ready();
+			}
+			void wait() const
+			{
+				state_->wait();
+			}
+			// wait_for method: returns true if result is ready
+			template< class rep, class period >
+			bool wait_for( const std::chrono::duration< rep, period >& timeout ) const
+			{
+				return state_->timed_wait( details::deadline_after( timeout ) );
+			}
+			// get method: waits for result, returns it (result is moved out, call get() once) or rethrows exception of callable
+			R get()
+			{
+				state_->wait();
+				return state_->take_value();
+			}
+		};
+
+		// when_all method: returns future that is ready when all futures of [first, last) range are ready
+		// results and exceptions stay in original futures, throws std::logic_error if any future of range is not valid (default constructed or moved from)
+		template< class iterator >
+		future< void > when_all( iterator first, iterator last )
+		{
+			for ( iterator i = first ; i != last ; ++i )
+				if ( !i->valid() )
+					throw std::logic_error( "when_all: future is not valid" );
+			details::when_all_state* const state = new details::when_all_state( static_cast< size_t >( std::distance( first, last ) ) );
+			for ( size_t i = 0 ; first != last ; ++first, ++i )
+				state->watch( i, first->state_ );
+			state->watch_finished();
+			return future< void >( state );
+		}
+	}
+}
+
+#endif // _SYSTEM_UTILITIES_COMMON_FUTURE_H_
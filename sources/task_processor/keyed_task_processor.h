@@ -0,0 +1,325 @@
+#ifndef _SYSTEM_UTILITIES_COMMON_KEYED_TASK_PROCESSOR_H_
+#define _SYSTEM_UTILITIES_COMMON_KEYED_TASK_PROCESSOR_H_
+
+#include <atomic>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+#include <boost/functional/hash.hpp>
+
+#include "task_processor.h"
+
+namespace system_utilities
+{
+	// keyed_task_processor: task_processor with serial lanes (strands), tasks added with the same key are processed one by one in add order,
+	// tasks with different keys are processed in parallel
+	// lane of busy key is a list of tasks linked through keyed_task, only head of lane is in task queue, next task is added to queue
+	// by processing thread after head is processed, so processing thread is never blocked by busy key
+	// processing thread adds next task without waiting (task_processor::try_add_task), head that does not fit into full task queue waits in retry list,
+	// retry list is taken by processing threads after every processed task (queue was full, so there are tasks that will be processed)
+	// head of lane that was dropped by overflow policy of task queue (set_capacity) is skipped, lane goes on with next task
+	// lane exists only while key has not processed tasks, idle key takes no memory
+	// lanes are kept in hash maps, divided into stripes with own mutex to decrease contention of producers
+	// task could be created only by create_task (task object is the first member of keyed_task, task* is used as keyed_task*)
+	// key should be default constructible, copyable and hashable by hash template parameter
+	// task_queue, task_allocator - one parameter templates (see details::default_keyed_queue), like task_queue and task_allocator of queue_logger
+	// task_queue should have try_push method (ts_queue, ts_priority_queue, lock_free_queue)
+
+	namespace common
+	{
+		namespace details
+		{
+			template< class T >
+			using default_keyed_queue = ts_queue< T >;
+		}
+
+		template< class task, class key, template< class > class task_queue = details::default_keyed_queue, template< class > class task_allocator = std::allocator, class hash = boost::hash< key > >
+		class keyed_task_processor;
+
+		namespace details
+		{
+			template< class task, class owner >
+			class keyed_task
+			{
+				friend owner;
+
+				task task_;
+				owner& owner_;
+				typename owner::key_type key_;
+				keyed_task* next_;
+				// queued_: task is head of lane that is in task queue, changed only by thread that owns the head
+				bool queued_;
+
+				explicit keyed_task( const keyed_task& );
+				keyed_task& operator=( const keyed_task& );
+			public:
+				template< class... Args >
+				explicit keyed_task( owner& o, Args&&... args )
+					: task_( std::forward< Args >( args )... )
+					, owner_( o )
+					, next_( NULL )
+					, queued_( false )
+				{
+				}
+				// head that is destroyed by task queue without processing (overflow policy) passes lane to next task
+				~keyed_task()
+				{
+					if ( queued_ )
+						owner_.processed_( this );
+				}
+				void operator()()
+				{
+					queued_ = false;
+					task_();
+					owner_.processed_( this );
+				}
+			};
+		}
+
+		template< class task, class key, template< class > class task_queue, template< class > class task_allocator, class hash >
+		class keyed_task_processor : protected virtual boost::noncopyable
+		{
+		public:
+			typedef key key_type;
+			typedef keyed_task_processor< task, key, task_queue, task_allocator, hash > self_type;
+			typedef details::keyed_task< task, self_type > keyed_task;
+			friend class details::keyed_task< task, self_type >;
+
+		private:
+			// lane: head is in task queue or in processing, tail is the last added task of key
+			struct lane
+			{
+				keyed_task* head;
+				keyed_task* tail;
+			};
+			typedef std::unordered_map< key, lane, hash > lanes;
+			struct stripe
+			{
+				boost::mutex protector;
+				lanes lanes_;
+			};
+			static const size_t stripes_size = 64;
+
+			stripe stripes_[ stripes_size ];
+			hash hash_;
+			// heads of lanes that were not added because task queue was full
+			boost::mutex retries_protector_;
+			std::list< keyed_task* > retries_;
+			std::atomic< size_t > retries_size_;
+			std::atomic< size_t > active_keys_;
+			std::atomic< bool > stopped_;
+			const bool process_on_stop_;
+			task_processor< keyed_task, task_queue< keyed_task >, task_allocator< keyed_task > > processor_;
+
+		public:
+			// constructor
+			// process_on_stop bool parameter: stop() waits until all tasks of all lanes will be processed
+			explicit keyed_task_processor( const size_t thread_amount, const bool process_on_stop = false )
+				: retries_size_( 0 )
+				, active_keys_( 0 )
+				, stopped_( false )
+				, process_on_stop_( process_on_stop )
+				, processor_( thread_amount )
+			{
+			}
+			// !not a virtual destructor
+			~keyed_task_processor()
+			{
+				stop();
+				processor_.wait();
+				{
+					boost::mutex::scoped_lock lock( retries_protector_ );
+					retries_.clear();
+				}
+				// heads of lanes in task queue are destroyed by processor_ destructor through allocator (task_processor::destroy_task),
+				// they do not pass lane to next task, heads from retry list are destroyed with their lanes
+				for ( size_t i = 0 ; i < stripes_size ; ++i )
+				{
+					boost::mutex::scoped_lock lock( stripes_[ i ].protector );
+					for ( typename lanes::iterator l = stripes_[ i ].lanes_.begin() ; l != stripes_[ i ].lanes_.end() ; ++l )
+					{
+						keyed_task* const head = l->second.head;
+						if ( head->queued_ )
+						{
+							head->queued_ = false;
+							destroy_lane_( head->next_ );
+						}
+						else
+							destroy_lane_( head );
+					}
+					stripes_[ i ].lanes_.clear();
+				}
+			}
+			template< class... Args >
+			task* create_task( Args&&... args )
+			{
+				return reinterpret_cast< task* >( processor_.create_task( *this, std::forward< Args >( args )... ) );
+			}
+			// destroy_task method: destroys task that was created by create_task and was not added (add_task returned false)
+			void destroy_task( task* const t )
+			{
+				processor_.destroy_task( reinterpret_cast< keyed_task* >( t ) );
+			}
+			// add_task method: task is processed after all tasks that were added with the same key before
+			// returns false if keyed_task_processor is stopped or task queue rejected task (full queue with fail or block_for policy)
+			// could wait for free place in task queue (blocking task queue), stripe lock is not held while it waits
+			bool add_task( const key& k, task* const t )
+			{
+				if ( stopped_ )
+					return false;
+				keyed_task* const kt = reinterpret_cast< keyed_task* >( t );
+				kt->key_ = k;
+				kt->next_ = NULL;
+				{
+					stripe& s = stripe_( k );
+					boost::mutex::scoped_lock lock( s.protector );
+					const typename lanes::iterator l = s.lanes_.find( k );
+					if ( l != s.lanes_.end() )
+					{
+						l->second.tail->next_ = kt;
+						l->second.tail = kt;
+						return true;
+					}
+					const lane new_lane = { kt, kt };
+					s.lanes_.insert( std::make_pair( k, new_lane ) );
+					++active_keys_;
+					kt->queued_ = true;
+				}
+				if ( processor_.add_task( kt ) )
+					return true;
+				// tasks that were appended to lane after its head are accepted, lane goes on with next task
+				kt->queued_ = false;
+				keyed_task* const next = pass_lane_( kt );
+				if ( next )
+					queue_head_( next );
+				return false;
+			}
+			// set_capacity method: bounded task queue (ts_queue, ts_priority_queue), see task_processor::set_capacity
+			// head of lane that is dropped by overflow policy is skipped, next task of lane is added to task queue
+			void set_capacity( const capacity_settings& settings )
+			{
+				processor_.set_capacity( settings );
+			}
+			// dropped method: amount of tasks that were lost because of full task queue
+			size_t dropped() const
+			{
+				return processor_.dropped();
+			}
+			// emplace_task method: create_task + add_task in one call, task is destroyed if it was not added
+			template< class... Args >
+			bool emplace_task( const key& k, Args&&... args )
+			{
+				task* const t = create_task( std::forward< Args >( args )... );
+				if ( add_task( k, t ) )
+					return true;
+				destroy_task( t );
+				return false;
+			}
+			// active_keys method: amount of keys that have not processed tasks
+			size_t active_keys() const
+			{
+				return active_keys_.load();
+			}
+			// size method: amount of lanes heads in task queue, tasks waiting behind busy key are not counted
+			size_t size() const
+			{
+				return processor_.size();
+			}
+			// wait method: wait until all lanes are processed
+			// next task of lane is added to task queue before previous one is finished, so task_processor::wait() could not miss it
+			void wait()
+			{
+				processor_.wait();
+			}
+			void stop()
+			{
+				if ( process_on_stop_ && !stopped_ )
+					processor_.wait();
+				stopped_ = true;
+				processor_.stop();
+			}
+		private:
+			stripe& stripe_( const key& k )
+			{
+				return stripes_[ hash_( k ) % stripes_size ];
+			}
+			void destroy_lane_( keyed_task* kt )
+			{
+				while ( kt )
+				{
+					keyed_task* const next = kt->next_;
+					processor_.destroy_task( kt );
+					kt = next;
+				}
+			}
+			// pass_lane_ method: head kt of lane was processed, dropped or rejected, next task becomes head, lane is erased if kt was the last one
+			// returns new head, that should be added to task queue
+			keyed_task* pass_lane_( keyed_task* const kt )
+			{
+				keyed_task* next = NULL;
+				{
+					stripe& s = stripe_( kt->key_ );
+					boost::mutex::scoped_lock lock( s.protector );
+					const typename lanes::iterator l = s.lanes_.find( kt->key_ );
+					next = kt->next_;
+					if ( next )
+						l->second.head = next;
+					else
+						s.lanes_.erase( l );
+				}
+				if ( !next )
+					--active_keys_;
+				return next;
+			}
+			// queue_head_ method: adds new head of lane to task queue without waiting, head that does not fit goes to retry list
+			// head is owned by calling thread until it is added
+			void queue_head_( keyed_task* const head )
+			{
+				head->queued_ = true;
+				if ( processor_.try_add_task( head ) )
+					return;
+				head->queued_ = false;
+				{
+					boost::mutex::scoped_lock lock( retries_protector_ );
+					retries_.push_back( head );
+					++retries_size_;
+				}
+				// queue could become empty before head was put to retry list
+				retry_();
+			}
+			// retry_ method: adds heads from retry list to task queue while it has free place
+			// after stop() heads stay in retry list and are destroyed by destructor
+			void retry_()
+			{
+				if ( retries_size_.load() == 0 )
+					return;
+				boost::mutex::scoped_lock lock( retries_protector_ );
+				while ( !retries_.empty() && !stopped_ )
+				{
+					keyed_task* const head = retries_.front();
+					head->queued_ = true;
+					if ( !processor_.try_add_task( head ) )
+					{
+						head->queued_ = false;
+						return;
+					}
+					retries_.pop_front();
+					--retries_size_;
+				}
+			}
+			// processed_ method: called by processing thread after head of lane was processed (or by task queue that dropped head),
+			// adds next task of lane to task queue, processing thread never waits for free place in task queue
+			// keyed_task is freed by task_processor after return
+			void processed_( keyed_task* const kt )
+			{
+				keyed_task* const next = pass_lane_( kt );
+				if ( next )
+					queue_head_( next );
+				retry_();
+			}
+		};
+	}
+}
+
+#endif // _SYSTEM_UTILITIES_COMMON_KEYED_TASK_PROCESSOR_H_
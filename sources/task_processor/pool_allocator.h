@@ -0,0 +1,244 @@
+#ifndef _SYSTEM_UTILITIES_COMMON_POOL_ALLOCATOR_H_
+#define _SYSTEM_UTILITIES_COMMON_POOL_ALLOCATOR_H_
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+namespace system_utilities
+{
+	// pool_allocator: thread-caching fixed-size object pool allocator, could be used as allocator parameter of task_processor (and queue_logger)
+	// every thread keeps own free list of objects, so allocate(1) and deallocate(p, 1) do not take locks in steady state
+	// objects freed by other thread (processing thread of task_processor) go to its free list, full free list returns batch of objects to global pool,
+	// empty free list takes batch from global pool, memory is taken from system by chunks of batch_size objects and is never returned till application exit
+	// allocate(n) with n != 1 goes to operator new
+	// stateless: all pool_allocator< T > objects share one pool
+
+	namespace common
+	{
+		namespace details
+		{
+			struct pool_node
+			{
+				pool_node* next;
+			};
+
+			// object_pool: global part of pool_allocator, list of free batches protected by mutex
+			template< size_t object_size >
+			class object_pool
+			{
+				explicit object_pool( const object_pool& );
+				object_pool& operator=( const object_pool& );
+
+				boost::mutex protector_;
+				std::vector< pool_node* > batches_;
+				std::atomic< size_t > chunks_allocated_;
+
+				explicit object_pool()
+					: chunks_allocated_( 0 )
+				{
+				}
+			public:
+				static const size_t batch_size = 64;
+
+				// pool is never destroyed: objects could be freed by static objects destructors or by thread caches after static objects destruction
+				static object_pool& instance()
+				{
+					static object_pool* const pool = new object_pool();
+					return *pool;
+				}
+				// returns list of batch_size free objects
+				pool_node* take_batch()
+				{
+					boost::mutex::scoped_lock lock( protector_ );
+					if ( !batches_.empty() )
+					{
+						pool_node* const result = batches_.back();
+						batches_.pop_back();
+						return result;
+					}
+					char* const chunk = static_cast< char* >( ::operator new( object_size * batch_size ) );
+					++chunks_allocated_;
+					pool_node* result = NULL;
+					for ( size_t i = batch_size ; i > 0 ; --i )
+					{
+						pool_node* const node = reinterpret_cast< pool_node* >( chunk + ( i - 1 ) * object_size );
+						node->next = result;
+						result = node;
+					}
+					return result;
+				}
+				// takes list of batch_size free objects
+				void return_batch( pool_node* const batch )
+				{
+					boost::mutex::scoped_lock lock( protector_ );
+					batches_.push_back( batch );
+				}
+				// amount of chunks that were taken from system, could be used to check steady state
+				size_t chunks_allocated() const
+				{
+					return chunks_allocated_.load( std::memory_order_relaxed );
+				}
+			};
+
+			// thread_object_cache: thread local part of pool_allocator
+			template< size_t object_size >
+			class thread_object_cache
+			{
+				typedef object_pool< object_size > pool;
+
+				pool& pool_;
+				pool_node* free_;
+				size_t size_;
+			public:
+				explicit thread_object_cache()
+					: pool_( pool::instance() )
+					, free_( NULL )
+					, size_( 0 )
+				{
+				}
+				~thread_object_cache()
+				{
+					while ( size_ >= pool::batch_size )
+						pool_.return_batch( cut_batch_() );
+					// not full batch is kept in pool as well, pool treats it as batch with less objects
+					if ( free_ )
+						pool_.return_batch( free_ );
+				}
+				void* allocate()
+				{
+					if ( !free_ )
+					{
+						free_ = pool_.take_batch();
+						size_ = count_( free_ );
+					}
+					pool_node* const result = free_;
+					free_ = free_->next;
+					--size_;
+					return result;
+				}
+				void deallocate( void* const p )
+				{
+					pool_node* const node = static_cast< pool_node* >( p );
+					node->next = free_;
+					free_ = node;
+					if ( ++size_ >= 2 * pool::batch_size )
+						pool_.return_batch( cut_batch_() );
+				}
+			private:
+				pool_node* cut_batch_()
+				{
+					pool_node* const result = free_;
+					pool_node* last = free_;
+					for ( size_t i = 1 ; i < pool::batch_size ; ++i )
+						last = last->next;
+					free_ = last->next;
+					last->next = NULL;
+					size_ -= pool::batch_size;
+					return result;
+				}
+				static size_t count_( pool_node* node )
+				{
+					size_t result = 0;
+					for ( ; node ; node = node->next )
+						++result;
+					return result;
+				}
+			};
+
+			template< class T >
+			struct pool_object_size
+			{
+				static const size_t alignment = alignof( T ) > alignof( pool_node ) ? alignof( T ) : alignof( pool_node );
+				static const size_t size = sizeof( T ) > sizeof( pool_node ) ? sizeof( T ) : sizeof( pool_node );
+				static const size_t value = ( size + alignment - 1 ) / alignment * alignment;
+			};
+		}
+
+		template< class T >
+		class pool_allocator
+		{
+			static const size_t object_size = details::pool_object_size< T >::value;
+			typedef details::object_pool< object_size > pool;
+			typedef details::thread_object_cache< object_size > cache;
+
+		public:
+			typedef T value_type;
+			typedef T* pointer;
+			typedef const T* const_pointer;
+			typedef T& reference;
+			typedef const T& const_reference;
+			typedef size_t size_type;
+			typedef std::ptrdiff_t difference_type;
+
+			template< class U >
+			struct rebind
+			{
+				typedef pool_allocator< U > other;
+			};
+
+			pool_allocator()
+			{
+			}
+			template< class U >
+			pool_allocator( const pool_allocator< U >& )
+			{
+			}
+			T* allocate( const size_t n )
+			{
+				if ( n != 1 )
+					return static_cast< T* >( ::operator new( n * sizeof( T ) ) );
+				return static_cast< T* >( thread_cache_().allocate() );
+			}
+			void deallocate( T* const p, const size_t n )
+			{
+				if ( n != 1 )
+					::operator delete( p );
+				else
+					thread_cache_().deallocate( p );
+			}
+			template< class U, class... Args >
+			void construct( U* const p, Args&&... args )
+			{
+				::new( static_cast< void* >( p ) ) U( std::forward< Args >( args )... );
+			}
+			template< class U >
+			void destroy( U* const p )
+			{
+				p->~U();
+			}
+			size_t max_size() const
+			{
+				return static_cast< size_t >( -1 ) / sizeof( T );
+			}
+			// amount of memory chunks (batch of objects) that were taken from system by all pool_allocator with the same object size
+			static size_t chunks_allocated()
+			{
+				return pool::instance().chunks_allocated();
+			}
+		private:
+			static cache& thread_cache_()
+			{
+				static thread_local cache thread_cache;
+				return thread_cache;
+			}
+		};
+
+		template< class T, class U >
+		bool operator==( const pool_allocator< T >&, const pool_allocator< U >& )
+		{
+			return true;
+		}
+		template< class T, class U >
+		bool operator!=( const pool_allocator< T >&, const pool_allocator< U >& )
+		{
+			return false;
+		}
+	}
+}
+
+#endif // _SYSTEM_UTILITIES_COMMON_POOL_ALLOCATOR_H_
@@ -1,4 +1,6 @@
 #include "task_processor.h"
+#include "pool_allocator.h"
+#include "future.h"
 
 namespace task_processor_compilation_checker
 {
@@ -1,8 +1,21 @@
 #ifndef _SYSTEM_UTILITIES_COMMON_TASK_PROCESSOR_H_
 #define _SYSTEM_UTILITIES_COMMON_TASK_PROCESSOR_H_
 
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 #include <ts_queue.h>
 
+#include "future.h"
+#include "task_statistics.h"
+#include "thread_affinity.h"
+
+#include <boost/type_traits/integral_constant.hpp>
+
 namespace system_utilities
 {
 	namespace common
@@ -11,6 +24,7 @@ namespace system_utilities
 		// task processor class was created in "fast-to-release" implementation.
 		// please be carefull with next: task_processor does not have virtual destructor - please be sure that you don't delete child of task_processor class by pointer.
 		// please create you task with next assumption: operator() of task class should not produce any exception. Exception that going out of task will terminate the application.
+		// task_processor< function_task > accepts any callable by submit() method, result or exception of callable goes to returned future (see future.h)
 
 		// task class example: 
 		// class task_example
@@ -23,21 +37,94 @@ namespace system_utilities
 		// };
 		// you can find other method usage examples at task_processor.cpp
 
+		// batch_size template parameter: if greater than 1, processing threads take up to batch_size tasks per one queue access (task_queue::wait_pop_bulk)
+		// and process them one by one, it amortizes queue lock and wake up cost for small tasks
+
+		// thread_affinity constructor parameter: processing threads pin themselves to cpus before processing (see thread_affinity.h)
+
+		// elastic mode (constructor with elastic_settings): amount of processing threads changes between min_threads and max_threads
+		// every time previous sample was processed, next added task is sampled (one timestamp per sample): when sampled task waits in queue longer
+		// than latency_threshold (measured by processing thread or observed by add_task) or queue size is greater than depth_threshold,
+		// one more processing thread is spawned (not more than one per latency_threshold)
+		// processing thread that had no tasks during idle_timeout retires while there are more than min_threads processing threads
+		// resize( min, max ) and resize( n ) change limits, threads above max_threads retire after current batch or after idle_timeout
+		// elastic mode uses task_queue::wait_pop_bulk with timeout (ts_queue, ts_priority_queue, lock_free_queue, spsc_queue)
+
+		// statistics template parameter: if true, task_processor counts submitted, completed and rejected tasks and records histograms
+		// of queue latency and execution time (see task_statistics.h), stats() returns snapshot
+		// time of add_task is kept after task object, so tasks should be created by create_task (allocator is rebound to bigger slot)
+		// if false, stats() returns empty snapshot and there is no overhead
+
+		// set_capacity method (ts_queue, ts_priority_queue): bounded task queue with overflow policy (see capacity_settings in ts_queue.h)
+		// tasks dropped by overflow policy are destroyed, add_task returns true for them (task was accepted and dropped later or immediately)
+		// dropped() counts tasks that were dropped or were not added because of full queue (add_task returned false before stop())
+
+		struct elastic_settings
+		{
+			size_t min_threads;
+			size_t max_threads;
+			std::chrono::microseconds latency_threshold;
+			std::chrono::milliseconds idle_timeout;
+			// 0 - queue size is not checked
+			size_t depth_threshold;
+
+			explicit elastic_settings( const size_t min_threads_amount, const size_t max_threads_amount,
+				const std::chrono::microseconds latency_threshold_value = std::chrono::milliseconds( 1 ),
+				const std::chrono::milliseconds idle_timeout_value = std::chrono::seconds( 1 ),
+				const size_t depth_threshold_value = 0 )
+				: min_threads( min_threads_amount )
+				, max_threads( max_threads_amount > min_threads_amount ? max_threads_amount : min_threads_amount )
+				, latency_threshold( latency_threshold_value )
+				, idle_timeout( idle_timeout_value )
+				, depth_threshold( depth_threshold_value )
+			{
+			}
+		};
+
 		template< 
 			class task, 
 			class task_queue = ts_queue< task >, 
-			class allocator = std::allocator< task > >
+			class allocator = std::allocator< task >,
+			size_t batch_size = 1,
+			bool statistics = false >
 		class task_processor : protected virtual boost::noncopyable
 		{
-			allocator allocator_;
+			typedef details::task_slot< task, statistics > slot_traits;
+			typedef typename slot_traits::type slot;
+			typedef details::task_statistics< statistics > statistics_type;
+			typedef details::statistics_thread_guard< statistics > statistics_guard;
+
+			typename details::slot_allocator< allocator, slot, statistics >::type allocator_;
+			statistics_type statistics_;
+			const thread_affinity affinity_;
 			boost::thread_group threads_;
 			task_queue task_queue_;
 			bool stopping_;
 			bool process_on_stop_;
 
+			// pending_tasks_: amount of added and not finished tasks (in queue or in processing)
+			// processing threads touch wait_ mutex only if wait() is called (waiters_ != 0)
+			std::atomic< size_t > pending_tasks_;
+			std::atomic< size_t > waiters_;
+			std::atomic< size_t > dropped_;
+			std::atomic< bool > stopped_;
 			boost::condition wait_condition_;
 			mutable boost::mutex wait_;
-			volatile size_t working_threads_;
+
+			// elastic mode, grow_ is NULL in fixed mode, so elastic code is not instantiated for fixed task_processor
+			typedef void ( task_processor::*grow_method )( const bool no_workers );
+			const grow_method grow_;
+			const elastic_settings elastic_;
+			std::atomic< size_t > threads_amount_;
+			std::atomic< size_t > min_threads_;
+			std::atomic< size_t > max_threads_;
+			mutable boost::mutex threads_protector_;
+			std::vector< boost::thread* > workers_;
+			std::vector< boost::thread* > retired_;
+			std::chrono::steady_clock::time_point last_spawn_;
+			std::atomic< task* > sampled_task_;
+			std::atomic< long long > sampled_time_;
+			std::atomic< long long > queue_latency_;
 
 			explicit task_processor();
 			explicit task_processor( const task_processor& );
@@ -50,68 +137,198 @@ namespace system_utilities
 				: allocator_( allocator_object )
                 , stopping_( false )
 				, process_on_stop_( process_on_stop )
-				, working_threads_( 0 )
+				, pending_tasks_( 0 )
+				, waiters_( 0 )
+				, dropped_( 0 )
+				, stopped_( false )
+				, grow_( NULL )
+				, elastic_( thread_amount, thread_amount )
+				, threads_amount_( thread_amount )
+				, min_threads_( thread_amount )
+				, max_threads_( thread_amount )
+				, sampled_task_( NULL )
+				, sampled_time_( 0 )
+				, queue_latency_( 0 )
 			{
 				for( size_t i = 0 ; i < thread_amount ; ++i )
 					threads_.create_thread( boost::bind( &task_processor::processing, this ) );
 			}
+			// affinity parameter: placement of processing threads on cpus
+			explicit task_processor( const size_t thread_amount, const thread_affinity& affinity, bool process_on_stop = false, allocator allocator_object = allocator() )
+				: allocator_( allocator_object )
+				, affinity_( affinity )
+				, stopping_( false )
+				, process_on_stop_( process_on_stop )
+				, pending_tasks_( 0 )
+				, waiters_( 0 )
+				, dropped_( 0 )
+				, stopped_( false )
+				, grow_( NULL )
+				, elastic_( thread_amount, thread_amount )
+				, threads_amount_( thread_amount )
+				, min_threads_( thread_amount )
+				, max_threads_( thread_amount )
+				, sampled_task_( NULL )
+				, sampled_time_( 0 )
+				, queue_latency_( 0 )
+			{
+				for( size_t i = 0 ; i < thread_amount ; ++i )
+					threads_.create_thread( boost::bind( &task_processor::pinned_processing, this, i ) );
+			}
+			// elastic mode constructor, min_threads processing threads are started
+			explicit task_processor( const elastic_settings& settings, const thread_affinity& affinity = thread_affinity(), bool process_on_stop = false, allocator allocator_object = allocator() )
+				: allocator_( allocator_object )
+				, affinity_( affinity )
+				, stopping_( false )
+				, process_on_stop_( process_on_stop )
+				, pending_tasks_( 0 )
+				, waiters_( 0 )
+				, dropped_( 0 )
+				, stopped_( false )
+				, grow_( &task_processor::grow_elastic_ )
+				, elastic_( settings )
+				, threads_amount_( 0 )
+				, min_threads_( settings.min_threads )
+				, max_threads_( settings.max_threads )
+				, last_spawn_( std::chrono::steady_clock::now() )
+				, sampled_task_( NULL )
+				, sampled_time_( 0 )
+				, queue_latency_( 0 )
+			{
+				resize( settings.min_threads, settings.max_threads );
+			}
 			// !not a virtual destructor
 			~task_processor()
 			{
 				stop();
 				threads_.join_all();
+				join_elastic_workers_();
+				destroy_queued_tasks_();
 			}
-			task* create_task()
+			// create_task method: allocates task by allocator and constructs it in place, arguments are perfectly forwarded to task constructor
+			// (lvalues are passed as references, temporaries and move-only payloads are moved)
+			template< class... Args >
+			task* create_task( Args&&... args )
 			{
-				task* new_task = allocator_.allocate( 1 );
-				new( new_task ) task();
+				slot* const new_slot = allocator_.allocate( 1 );
+				task* const new_task = reinterpret_cast< task* >( new_slot );
+				try
+				{
+					new( new_task ) task( std::forward< Args >( args )... );
+				}
+				catch( ... )
+				{
+					allocator_.deallocate( new_slot, 1 );
+					throw;
+				}
 				return new_task;
 			}
-			template< typename P1 >
-			task* create_task( P1& p1 )
+			// destroy_task method: destroys task that was created by create_task and was not added (add_task returned false)
+			void destroy_task( task* const t )
 			{
-				task* new_task = allocator_.allocate( 1 );
-				new( new_task ) task( p1 );
-				return new_task;
+				allocator_.destroy( t );
+				allocator_.deallocate( reinterpret_cast< slot* >( t ), 1 );
 			}
-			template< typename P1, typename P2 >
-			task* create_task( P1& p1, P2& p2 )
+
+			bool add_task( task* const t )
 			{
-				task* new_task = allocator_.allocate( 1 );
-				new( new_task ) task( p1, p2 );
-				return new_task;
+				return add_task_( t, [ this ]( task* const added ) { return task_queue_.push( added ); }, true );
 			}
-			template< typename P1, typename P2, typename P3 >
-			task* create_task( P1& p1, P2& p2, P3& p3 )
+			// add_task with priority: for task queues with priority lanes (ts_priority_queue), 0 is the highest priority
+			bool add_task( task* const t, const size_t priority )
 			{
-				task* new_task = allocator_.allocate( 1 );
-				new( new_task ) task( p1, p2, p3 );
-				return new_task;
+				return add_task_( t, [ this, priority ]( task* const added ) { return task_queue_.push( added, priority ); }, true );
 			}
-			template< typename P1, typename P2, typename P3, typename P4 >
-			task* create_task( P1& p1, P2& p2, P3& p3, P4& p4 )
+			// try_add_task method: add_task that never waits for free place and never drops task (task_queue::try_push: ts_queue, ts_priority_queue, lock_free_queue)
+			// returns false if task queue is full or task_processor is stopping, task is not counted as dropped
+			bool try_add_task( task* const t )
 			{
-				task* new_task = allocator_.allocate( 1 );
-				new( new_task ) task( p1, p2, p3, p4 );
-				return new_task;
+				return add_task_( t, [ this ]( task* const added ) { return task_queue_.try_push( added ); }, false );
 			}
-
-			bool add_task( task* const t )
+			// submit method: for task_processor< function_task >, wraps callable into task and adds it
+			// returns future of callable result, exception that goes out of callable is rethrown by future::get()
+			// if task was not added (task_processor is stopping) future::get() throws broken_task
+			template< class F >
+			future< typename std::result_of< typename std::decay< F >::type() >::type > submit( F&& function )
 			{
-				if (stopping_)
-					return false;
-				return task_queue_.push( t );
+				typedef typename std::decay< F >::type function_type;
+				typedef typename std::result_of< function_type() >::type result_type;
+				details::function_state< result_type, function_type >* const state = new details::function_state< result_type, function_type >( function_type( std::forward< F >( function ) ) );
+				future< result_type > result( state );
+				// if create_task throws, result releases the only reference of state
+				task* const t = create_task( static_cast< details::shared_state_base* >( state ) );
+				// second reference is owned by task
+				state->add_reference();
+				if ( !add_task( t ) )
+					destroy_task( t );
+				return result;
+			}
+			// emplace_task method: create_task + add_task in one call, task is destroyed if it was not added
+			// returns add_task result
+			template< class... Args >
+			bool emplace_task( Args&&... args )
+			{
+				task* const t = create_task( std::forward< Args >( args )... );
+				if ( add_task( t ) )
+					return true;
+				destroy_task( t );
+				return false;
 			}
 			size_t size() const
 			{
 				return task_queue_.size();
 			}
+			// threads method: amount of processing threads
+			size_t threads() const
+			{
+				return threads_amount_.load();
+			}
+			// queue_latency method: time that last sampled task waited in queue (elastic mode only)
+			std::chrono::microseconds queue_latency() const
+			{
+				return std::chrono::microseconds( queue_latency_.load( std::memory_order_relaxed ) );
+			}
+			// set_capacity method: for task queues with capacity limit (ts_queue, ts_priority_queue)
+			void set_capacity( const capacity_settings& settings )
+			{
+				task_queue_.set_capacity( settings, [ this ]( task* const t ) { drop_task_( t ); } );
+			}
+			// dropped method: amount of tasks that were lost because of full task queue
+			size_t dropped() const
+			{
+				return dropped_.load( std::memory_order_relaxed );
+			}
+			// stats method: snapshot of counters and histograms, empty if statistics template parameter is false
+			task_processor_stats stats() const
+			{
+				return statistics_.snapshot();
+			}
+			// resize method: elastic mode only, changes thread amount limits, starts threads up to min_threads immediately
+			// threads above max_threads retire after current batch or after idle_timeout
+			void resize( const size_t min_threads, const size_t max_threads )
+			{
+				if ( !grow_ )
+					throw std::logic_error( "task_processor::resize is available in elastic mode only" );
+				boost::mutex::scoped_lock lock( threads_protector_ );
+				min_threads_ = min_threads;
+				max_threads_ = max_threads > min_threads ? max_threads : min_threads;
+				while ( !stopped_ && threads_amount_.load() < min_threads )
+					spawn_worker_();
+			}
+			// resize method: fixed amount of threads in elastic mode
+			void resize( const size_t thread_amount )
+			{
+				resize( thread_amount, thread_amount );
+			}
+			// wait method: wait until queue is empty and there is no task in processing
+			// after stop() - wait until there is no task in processing
 			void wait()
 			{
-				task_queue_.wait();
 				boost::mutex::scoped_lock lock( wait_ );
-				while ( working_threads_ != 0 )
+				++waiters_;
+				while ( !all_tasks_finished_() )
 					wait_condition_.wait( lock );
+				--waiters_;
 			}
 			void stop()
 			{
@@ -120,29 +337,262 @@ namespace system_utilities
 					stopping_ = true;
 					task_queue_.wait();
 				}
+				stopped_ = true;
 				task_queue_.stop();
+				boost::mutex::scoped_lock lock( wait_ );
+				wait_condition_.notify_all();
 			}
 		private:
-			void processing()
+			// add_task_ method: push is push method of task queue, pending, sampling and statistics bookkeeping is shared by add_task overloads
+			// count_dropped: task that was not pushed before stop() is counted by dropped()
+			template< class push_function >
+			bool add_task_( task* const t, const push_function& push, const bool count_dropped )
 			{
-				for (;;)
+				if (stopping_)
 				{
-					task* const t = task_queue_.wait_pop();
-					if ( !t )
+					statistics_.rejected();
+					return false;
+				}
+				++pending_tasks_;
+				if ( grow_ )
+					sample_( t );
+				slot_traits::set_added_time( t, statistics_.now() );
+				statistics_.submitted();
+				if ( push( t ) )
+				{
+					if ( grow_ )
+						added_();
+					return true;
+				}
+				statistics_.not_submitted();
+				if ( count_dropped && !stopped_ )
+					++dropped_;
+				unsample_( t );
+				tasks_finished_( 1 );
+				return false;
+			}
+			// waiters_ is incremented under wait_ lock before the check and pending_tasks_ is decremented before waiters_ is read,
+			// both are sequentially consistent, so notification could not be lost
+			void tasks_finished_( const size_t amount )
+			{
+				const size_t pending = pending_tasks_.fetch_sub( amount ) - amount;
+				if ( waiters_.load() != 0 && ( pending == 0 || stopped_ ) )
+				{
+					boost::mutex::scoped_lock lock( wait_ );
+					wait_condition_.notify_all();
+				}
+			}
+			// should be called under wait_ lock
+			// after stop() not processed tasks stay in queue, so only tasks in processing are waited for
+			bool all_tasks_finished_() const
+			{
+				const size_t pending = pending_tasks_.load();
+				if ( pending == 0 )
+					return true;
+				return stopped_ && pending <= task_queue_.ts_size();
+			}
+			static long long now_()
+			{
+				return std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::steady_clock::now().time_since_epoch() ).count();
+			}
+			// sample_ method: task becomes sampled if previous sample was processed
+			// otherwise if previous sampled task waits longer than latency_threshold - processing threads are not enough
+			void sample_( task* const t )
+			{
+				task* sampled = sampled_task_.load( std::memory_order_acquire );
+				if ( sampled )
+				{
+					if ( now_() - sampled_time_.load( std::memory_order_relaxed ) > elastic_.latency_threshold.count() )
+						(this->*grow_)( false );
+					return;
+				}
+				sampled_time_.store( now_(), std::memory_order_relaxed );
+				if ( !sampled_task_.compare_exchange_strong( sampled, t, std::memory_order_release, std::memory_order_relaxed ) )
+					return;
+				if ( elastic_.depth_threshold && task_queue_.size() > elastic_.depth_threshold )
+					(this->*grow_)( false );
+			}
+			// added_ method: with min_threads == 0 last processing thread could retire, while task is added
+			// last thread retires under threads_protector_ lock only if queue is empty, so check under the same lock after push could not miss it
+			void added_()
+			{
+				if ( min_threads_.load() == 0 && threads_amount_.load() <= 1 )
+					(this->*grow_)( true );
+			}
+			void unsample_( task* t )
+			{
+				sampled_task_.compare_exchange_strong( t, NULL );
+			}
+			// check_sample_ method: measures queue latency of sampled task
+			void check_sample_( task* const* tasks, const size_t size )
+			{
+				task* sampled = sampled_task_.load( std::memory_order_acquire );
+				if ( !sampled )
+					return;
+				for ( size_t i = 0 ; i < size ; ++i )
+					if ( tasks[ i ] == sampled )
+					{
+						const long long latency = now_() - sampled_time_.load( std::memory_order_relaxed );
+						queue_latency_.store( latency, std::memory_order_relaxed );
+						sampled_task_.compare_exchange_strong( sampled, NULL );
+						if ( latency > elastic_.latency_threshold.count() )
+							grow_elastic_( false );
 						return;
+					}
+			}
+			// grow_elastic_ method: spawns one processing thread if limits allow, not more than one per latency_threshold
+			// no_workers: spawns processing thread only if there is no one
+			void grow_elastic_( const bool no_workers )
+			{
+				if ( no_workers )
+				{
+					boost::mutex::scoped_lock lock( threads_protector_ );
+					if ( !stopped_ && threads_amount_.load() == 0 && max_threads_.load() != 0 )
+						spawn_worker_();
+					return;
+				}
+				boost::mutex::scoped_try_lock lock( threads_protector_ );
+				if ( !lock.owns_lock() || stopped_ || threads_amount_.load() >= max_threads_.load() )
+					return;
+				const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+				if ( now - last_spawn_ < elastic_.latency_threshold )
+					return;
+				last_spawn_ = now;
+				spawn_worker_();
+			}
+			// should be called under threads_protector_ lock
+			void spawn_worker_()
+			{
+				join_retired_();
+				size_t index = 0;
+				while ( index < workers_.size() && workers_[ index ] )
+					++index;
+				if ( index == workers_.size() )
+					workers_.push_back( NULL );
+				workers_[ index ] = new boost::thread( boost::bind( &task_processor::elastic_processing, this, index ) );
+				++threads_amount_;
+			}
+			// should be called under threads_protector_ lock
+			// retired threads do not take threads_protector_ after retirement, so join could not dead lock
+			void join_retired_()
+			{
+				for ( size_t i = 0 ; i < retired_.size() ; ++i )
+				{
+					retired_[ i ]->join();
+					delete retired_[ i ];
+				}
+				retired_.clear();
+			}
+			// retire_ method: returns true if processing thread should exit
+			bool retire_( const size_t worker_index, const size_t limit )
+			{
+				boost::mutex::scoped_lock lock( threads_protector_ );
+				if ( stopped_ || threads_amount_.load() <= limit )
+					return false;
+				if ( threads_amount_.load() == 1 && task_queue_.size() != 0 )
+					return false;
+				retired_.push_back( workers_[ worker_index ] );
+				workers_[ worker_index ] = NULL;
+				--threads_amount_;
+				return true;
+			}
+			void join_elastic_workers_()
+			{
+				std::vector< boost::thread* > workers;
+				{
+					boost::mutex::scoped_lock lock( threads_protector_ );
+					join_retired_();
+					workers.swap( workers_ );
+				}
+				for ( size_t i = 0 ; i < workers.size() ; ++i )
+					if ( workers[ i ] )
 					{
-						boost::mutex::scoped_lock lock( wait_ );
-						++working_threads_;
+						workers[ i ]->join();
+						delete workers[ i ];
 					}
-					(*t)();
-					allocator_.destroy( t );
-					allocator_.deallocate( t, 1 );
+			}
+			void elastic_processing( const size_t worker_index )
+			{
+				affinity_.pin_current_thread( worker_index );
+				const statistics_guard guard( statistics_ );
+				task* tasks[ batch_size ];
+				for (;;)
+				{
+					const size_t size = task_queue_.wait_pop_bulk( tasks, batch_size, elastic_.idle_timeout );
+					if ( !size )
 					{
-						boost::mutex::scoped_lock lock( wait_ );
-						--working_threads_;
-						if ( working_threads_ == 0 )
-							wait_condition_.notify_all();
+						if ( stopped_ )
+							return;
+						if ( retire_( worker_index, min_threads_.load() ) )
+							return;
+						continue;
 					}
+					check_sample_( tasks, size );
+					for ( size_t i = 0 ; i < size ; ++i )
+						process_task_( tasks[ i ], guard.shard );
+					tasks_finished_( size );
+					if ( threads_amount_.load() > max_threads_.load() && retire_( worker_index, max_threads_.load() ) )
+						return;
+				}
+			}
+			// destroy_queued_tasks_ method: not processed tasks are destroyed by allocator after processing threads are joined,
+			// task queue would free them by delete
+			void destroy_queued_tasks_()
+			{
+				while ( task* const t = task_queue_.pop() )
+					destroy_task( t );
+			}
+			// drop_task_ method: called by task queue for task that was dropped by overflow policy
+			void drop_task_( task* const t )
+			{
+				statistics_.not_submitted();
+				++dropped_;
+				unsample_( t );
+				destroy_task( t );
+				tasks_finished_( 1 );
+			}
+			// process_task_ method: runs and destroys task, with statistics turned off time is not measured
+			void process_task_( task* const t, const typename statistics_type::shard shard )
+			{
+				const long long started = statistics_.now();
+				(*t)();
+				statistics_.processed( shard, slot_traits::added_time( t ), started );
+				destroy_task( t );
+			}
+			// worker pins itself before processing, tasks and queue are allocated by producers and are not moved to worker node
+			void pinned_processing( const size_t worker_index )
+			{
+				affinity_.pin_current_thread( worker_index );
+				processing();
+			}
+			void processing()
+			{
+				processing_( boost::integral_constant< bool, ( batch_size > 1 ) >() );
+			}
+			void processing_( boost::false_type )
+			{
+				const statistics_guard guard( statistics_ );
+				for (;;)
+				{
+					task* const t = task_queue_.wait_pop();
+					if ( !t )
+						return;
+					process_task_( t, guard.shard );
+					tasks_finished_( 1 );
+				}
+			}
+			void processing_( boost::true_type )
+			{
+				const statistics_guard guard( statistics_ );
+				task* tasks[ batch_size ];
+				for (;;)
+				{
+					const size_t size = task_queue_.wait_pop_bulk( tasks, batch_size );
+					if ( !size )
+						return;
+					for ( size_t i = 0 ; i < size ; ++i )
+						process_task_( tasks[ i ], guard.shard );
+					tasks_finished_( size );
 				}
 			}
 		};
@@ -0,0 +1,140 @@
+#include "task_statistics.h"
+
+#include <sstream>
+
+namespace system_utilities
+{
+	namespace common
+	{
+		namespace
+		{
+			size_t most_significant_bit( latency_histogram::value_type value )
+			{
+				size_t result = 0;
+				while ( value >>= 1 )
+					++result;
+				return result;
+			}
+		}
+
+		const size_t latency_histogram::sub_buckets;
+		const size_t latency_histogram::buckets_size;
+
+		latency_histogram::latency_histogram()
+			: counts_( buckets_size, 0 )
+			, count_( 0 )
+			, sum_( 0 )
+			, max_( 0 )
+		{
+		}
+		size_t latency_histogram::bucket_index( const value_type value )
+		{
+			if ( value < sub_buckets )
+				return static_cast< size_t >( value );
+			// sub_buckets is 2^4: value has msb >= 4, next 4 bits select linear sub bucket
+			const size_t msb = most_significant_bit( value );
+			return ( msb - 3 ) * sub_buckets + static_cast< size_t >( ( value >> ( msb - 4 ) ) & ( sub_buckets - 1 ) );
+		}
+		latency_histogram::value_type latency_histogram::bucket_lower_bound( const size_t index )
+		{
+			if ( index < sub_buckets )
+				return index;
+			const size_t msb = index / sub_buckets + 3;
+			return ( static_cast< value_type >( sub_buckets + index % sub_buckets ) ) << ( msb - 4 );
+		}
+		latency_histogram::value_type latency_histogram::bucket_upper_bound( const size_t index )
+		{
+			if ( index < sub_buckets )
+				return index;
+			const size_t msb = index / sub_buckets + 3;
+			return bucket_lower_bound( index ) + ( ( static_cast< value_type >( 1 ) << ( msb - 4 ) ) - 1 );
+		}
+		void latency_histogram::record( const value_type value, const value_type amount )
+		{
+			counts_[ bucket_index( value ) ] += amount;
+			count_ += amount;
+			sum_ += value * amount;
+			if ( value > max_ )
+				max_ = value;
+		}
+		void latency_histogram::add_bucket( const size_t index, const value_type amount )
+		{
+			counts_[ index ] += amount;
+			count_ += amount;
+		}
+		void latency_histogram::add_summary( const value_type sum, const value_type max )
+		{
+			sum_ += sum;
+			if ( max > max_ )
+				max_ = max;
+		}
+		void latency_histogram::merge( const latency_histogram& other )
+		{
+			for ( size_t i = 0 ; i < buckets_size ; ++i )
+				counts_[ i ] += other.counts_[ i ];
+			count_ += other.count_;
+			add_summary( other.sum_, other.max_ );
+		}
+		latency_histogram::value_type latency_histogram::percentile( const double percent ) const
+		{
+			if ( count_ == 0 )
+				return 0;
+			value_type rank = static_cast< value_type >( static_cast< double >( count_ ) * percent / 100.0 + 0.5 );
+			if ( rank == 0 )
+				rank = 1;
+			value_type seen = 0;
+			for ( size_t i = 0 ; i < buckets_size ; ++i )
+			{
+				seen += counts_[ i ];
+				if ( seen >= rank )
+				{
+					const value_type result = bucket_upper_bound( i );
+					return result < max_ ? result : max_;
+				}
+			}
+			return max_;
+		}
+
+		task_processor_stats::task_processor_stats()
+			: submitted( 0 )
+			, completed( 0 )
+			, rejected( 0 )
+		{
+		}
+		std::string task_processor_stats::to_string() const
+		{
+			std::stringstream result;
+			result << "submitted " << submitted << ", completed " << completed << ", rejected " << rejected;
+			const latency_histogram* const histograms[] = { &queue_latency, &execution_time };
+			const char* const names[] = { "queue latency", "execution time" };
+			for ( size_t i = 0 ; i < 2 ; ++i )
+			{
+				const latency_histogram& h = *histograms[ i ];
+				result << ", " << names[ i ] << " us: p50 " << h.percentile( 50.0 ) / 1000 << ", p99 " << h.percentile( 99.0 ) / 1000
+					<< ", p99.9 " << h.percentile( 99.9 ) / 1000 << ", max " << h.max() / 1000;
+			}
+			return result.str();
+		}
+
+		namespace details
+		{
+			histogram_shard::histogram_shard()
+			{
+				for ( size_t i = 0 ; i < latency_histogram::buckets_size ; ++i )
+					counts_[ i ].store( 0, std::memory_order_relaxed );
+				sum_.store( 0, std::memory_order_relaxed );
+				max_.store( 0, std::memory_order_relaxed );
+			}
+			void histogram_shard::add_to( latency_histogram& histogram ) const
+			{
+				for ( size_t i = 0 ; i < latency_histogram::buckets_size ; ++i )
+				{
+					const value_type count = counts_[ i ].load( std::memory_order_relaxed );
+					if ( count )
+						histogram.add_bucket( i, count );
+				}
+				histogram.add_summary( sum_.load( std::memory_order_relaxed ), max_.load( std::memory_order_relaxed ) );
+			}
+		}
+	}
+}
@@ -0,0 +1,322 @@
+#ifndef _SYSTEM_UTILITIES_COMMON_TASK_STATISTICS_H_
+#define _SYSTEM_UTILITIES_COMMON_TASK_STATISTICS_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <boost/thread/mutex.hpp>
+
+#include <cache_line.h>
+
+namespace system_utilities
+{
+	// task_statistics: instrumentation of task_processor, turned on by statistics template parameter of task_processor
+	// task_processor< ..., true >::stats() returns snapshot: submitted, completed, rejected tasks counters and histograms of
+	// queue latency (time from add_task to start of processing) and execution time, in nanoseconds
+	// every processing thread records into own shard without locks, stats() sums shards
+	// with statistics turned off all recording methods are empty, task_processor has no overhead
+
+	namespace common
+	{
+		// latency_histogram: log-linear (HDR-style) histogram, values below sub_buckets have own buckets,
+		// every power of two range above is split into sub_buckets linear buckets (relative error is less than 1 / sub_buckets)
+		class latency_histogram
+		{
+		public:
+			typedef unsigned long long value_type;
+			static const size_t sub_buckets = 16;
+			static const size_t buckets_size = 61 * sub_buckets;
+
+		private:
+			std::vector< value_type > counts_;
+			value_type count_;
+			value_type sum_;
+			value_type max_;
+
+		public:
+			explicit latency_histogram();
+
+			static size_t bucket_index( const value_type value );
+			// smallest value of bucket
+			static value_type bucket_lower_bound( const size_t index );
+			// greatest value of bucket
+			static value_type bucket_upper_bound( const size_t index );
+
+			void record( const value_type value, const value_type amount = 1 );
+			void add_bucket( const size_t index, const value_type amount );
+			void add_summary( const value_type sum, const value_type max );
+			void merge( const latency_histogram& other );
+
+			value_type count() const
+			{
+				return count_;
+			}
+			value_type max() const
+			{
+				return max_;
+			}
+			value_type mean() const
+			{
+				return count_ ? sum_ / count_ : 0;
+			}
+			value_type bucket_count( const size_t index ) const
+			{
+				return counts_[ index ];
+			}
+			// percentile method: upper bound of bucket that contains percentile ( 0.0 - 100.0 ), not greater than max()
+			value_type percentile( const double percent ) const;
+		};
+
+		struct task_processor_stats
+		{
+			size_t submitted;
+			size_t completed;
+			size_t rejected;
+			latency_histogram queue_latency;
+			latency_histogram execution_time;
+
+			explicit task_processor_stats();
+			// to_string method: one line description, times are in microseconds
+			std::string to_string() const;
+		};
+
+		namespace details
+		{
+			// histogram_shard: histogram with one writer thread, could be read by other threads at any time
+			class histogram_shard
+			{
+				typedef latency_histogram::value_type value_type;
+
+				std::atomic< value_type > counts_[ latency_histogram::buckets_size ];
+				std::atomic< value_type > sum_;
+				std::atomic< value_type > max_;
+
+				static void increment_( std::atomic< value_type >& value, const value_type amount )
+				{
+					value.store( value.load( std::memory_order_relaxed ) + amount, std::memory_order_relaxed );
+				}
+			public:
+				explicit histogram_shard();
+				void record( const value_type value )
+				{
+					increment_( counts_[ latency_histogram::bucket_index( value ) ], 1 );
+					increment_( sum_, value );
+					if ( value > max_.load( std::memory_order_relaxed ) )
+						max_.store( value, std::memory_order_relaxed );
+				}
+				void add_to( latency_histogram& histogram ) const;
+			};
+
+			// statistics_shard: statistics of one processing thread
+			struct statistics_shard
+			{
+				histogram_shard queue_latency;
+				histogram_shard execution_time;
+				std::atomic< size_t > completed;
+
+				explicit statistics_shard()
+					: completed( 0 )
+				{
+				}
+			};
+
+			inline long long statistics_now()
+			{
+				return std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now().time_since_epoch() ).count();
+			}
+
+			template< bool enabled >
+			class task_statistics;
+
+			template<>
+			class task_statistics< false >
+			{
+			public:
+				typedef void* shard;
+				static shard register_thread()
+				{
+					return NULL;
+				}
+				static void release_thread( shard )
+				{
+				}
+				static long long now()
+				{
+					return 0;
+				}
+				static void submitted()
+				{
+				}
+				static void rejected()
+				{
+				}
+				static void not_submitted()
+				{
+				}
+				static void processed( shard, const long long, const long long )
+				{
+				}
+				static task_processor_stats snapshot()
+				{
+					return task_processor_stats();
+				}
+			};
+
+			template<>
+			class task_statistics< true >
+			{
+				explicit task_statistics( const task_statistics& );
+				task_statistics& operator=( const task_statistics& );
+
+				padded_atomic< size_t > submitted_;
+				padded_atomic< size_t > rejected_;
+				mutable boost::mutex shards_protector_;
+				std::vector< statistics_shard* > shards_;
+				std::vector< statistics_shard* > free_shards_;
+
+			public:
+				typedef statistics_shard* shard;
+
+				explicit task_statistics()
+				{
+					submitted_.value.store( 0 );
+					rejected_.value.store( 0 );
+				}
+				~task_statistics()
+				{
+					for ( size_t i = 0 ; i < shards_.size() ; ++i )
+						delete shards_[ i ];
+				}
+				// register_thread method: returns shard for processing thread, shard of retired thread is reused
+				shard register_thread()
+				{
+					boost::mutex::scoped_lock lock( shards_protector_ );
+					if ( !free_shards_.empty() )
+					{
+						shard result = free_shards_.back();
+						free_shards_.pop_back();
+						return result;
+					}
+					shards_.push_back( new statistics_shard() );
+					return shards_.back();
+				}
+				void release_thread( shard s )
+				{
+					boost::mutex::scoped_lock lock( shards_protector_ );
+					free_shards_.push_back( s );
+				}
+				static long long now()
+				{
+					return statistics_now();
+				}
+				void submitted()
+				{
+					submitted_.value.fetch_add( 1, std::memory_order_relaxed );
+				}
+				void rejected()
+				{
+					rejected_.value.fetch_add( 1, std::memory_order_relaxed );
+				}
+				// not_submitted method: task was counted as submitted, but queue did not accept it
+				void not_submitted()
+				{
+					submitted_.value.fetch_sub( 1, std::memory_order_relaxed );
+					rejected();
+				}
+				// processed method: task was added at added time, started at started time and finished now
+				static void processed( shard s, const long long added, const long long started )
+				{
+					const long long finished = statistics_now();
+					s->queue_latency.record( started > added ? static_cast< latency_histogram::value_type >( started - added ) : 0 );
+					s->execution_time.record( finished > started ? static_cast< latency_histogram::value_type >( finished - started ) : 0 );
+					s->completed.store( s->completed.load( std::memory_order_relaxed ) + 1, std::memory_order_release );
+				}
+				task_processor_stats snapshot() const
+				{
+					task_processor_stats result;
+					boost::mutex::scoped_lock lock( shards_protector_ );
+					for ( size_t i = 0 ; i < shards_.size() ; ++i )
+					{
+						result.completed += shards_[ i ]->completed.load( std::memory_order_acquire );
+						shards_[ i ]->queue_latency.add_to( result.queue_latency );
+						shards_[ i ]->execution_time.add_to( result.execution_time );
+					}
+					result.submitted = submitted_.value.load( std::memory_order_relaxed );
+					result.rejected = rejected_.value.load( std::memory_order_relaxed );
+					return result;
+				}
+			};
+
+			// statistics_thread_guard: shard of processing thread for the time of processing loop
+			template< bool enabled >
+			class statistics_thread_guard
+			{
+				task_statistics< enabled >& statistics_;
+			public:
+				const typename task_statistics< enabled >::shard shard;
+
+				explicit statistics_thread_guard( task_statistics< enabled >& statistics )
+					: statistics_( statistics )
+					, shard( statistics.register_thread() )
+				{
+				}
+				~statistics_thread_guard()
+				{
+					statistics_.release_thread( shard );
+				}
+			};
+
+			// task_slot: memory of task, with statistics turned on it keeps time of add_task after task object
+			// task is the first member, so task* and slot* have the same address
+			// slot should be freed as slot by slot allocator only (task_processor::destroy_task), never by delete of task pointer,
+			// so task_processor destroys not processed tasks itself and task queue has nothing to delete
+			template< class task, bool enabled >
+			struct task_slot
+			{
+				typedef task type;
+				static void set_added_time( task*, const long long )
+				{
+				}
+				static long long added_time( const task* )
+				{
+					return 0;
+				}
+			};
+			template< class task >
+			struct task_slot< task, true >
+			{
+				struct type
+				{
+					typename std::aligned_storage< sizeof( task ), std::alignment_of< task >::value >::type task_storage;
+					long long added_time;
+				};
+				static void set_added_time( task* const t, const long long time )
+				{
+					reinterpret_cast< type* >( t )->added_time = time;
+				}
+				static long long added_time( const task* const t )
+				{
+					return reinterpret_cast< const type* >( t )->added_time;
+				}
+			};
+
+			// slot_allocator: allocator of task_slot, rebinds allocator only if statistics are turned on
+			template< class allocator, class slot, bool enabled >
+			struct slot_allocator
+			{
+				typedef allocator type;
+			};
+			template< class allocator, class slot >
+			struct slot_allocator< allocator, slot, true >
+			{
+				typedef typename allocator::template rebind< slot >::other type;
+			};
+		}
+	}
+}
+
+#endif // _SYSTEM_UTILITIES_COMMON_TASK_STATISTICS_H_
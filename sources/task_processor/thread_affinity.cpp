@@ -0,0 +1,215 @@
+#include "thread_affinity.h"
+
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/lexical_cast.hpp>
+#include <boost/thread.hpp>
+
+#ifdef _LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace system_utilities
+{
+	namespace common
+	{
+		namespace details
+		{
+			namespace
+			{
+				bool cpu_info_less( const cpu_info& left, const cpu_info& right )
+				{
+					if ( left.node != right.node )
+						return left.node < right.node;
+					return left.cpu < right.cpu;
+				}
+#ifdef _LINUX
+				bool read_first_line( const std::string& file_name, std::string& line )
+				{
+					std::ifstream file( file_name.c_str() );
+					return file.is_open() && std::getline( file, line );
+				}
+				cpu_infos read_system_cpus()
+				{
+					cpu_infos result;
+					std::string line;
+					if ( !read_first_line( "/sys/devices/system/cpu/online", line ) )
+						return result;
+					const std::vector< size_t > online = parse_cpu_list( line );
+					std::vector< size_t > nodes;
+					if ( read_first_line( "/sys/devices/system/node/online", line ) )
+						nodes = parse_cpu_list( line );
+					for ( size_t i = 0 ; i < online.size() ; ++i )
+					{
+						cpu_info info = { online[ i ], 0 };
+						result.push_back( info );
+					}
+					for ( size_t n = 0 ; n < nodes.size() ; ++n )
+					{
+						const std::string node = boost::lexical_cast< std::string >( nodes[ n ] );
+						if ( !read_first_line( "/sys/devices/system/node/node" + node + "/cpulist", line ) )
+							continue;
+						const std::vector< size_t > node_cpus = parse_cpu_list( line );
+						for ( size_t i = 0 ; i < result.size() ; ++i )
+							if ( std::find( node_cpus.begin(), node_cpus.end(), result[ i ].cpu ) != node_cpus.end() )
+								result[ i ].node = nodes[ n ];
+					}
+					return result;
+				}
+#else
+				cpu_infos read_system_cpus()
+				{
+					cpu_infos result;
+					const size_t size = boost::thread::hardware_concurrency();
+					for ( size_t i = 0 ; i < size ; ++i )
+					{
+						cpu_info info = { i, 0 };
+						result.push_back( info );
+					}
+					return result;
+				}
+#endif
+				cpu_infos sorted_system_cpus()
+				{
+					cpu_infos result = read_system_cpus();
+					if ( result.empty() )
+					{
+						cpu_info info = { 0, 0 };
+						result.push_back( info );
+					}
+					std::sort( result.begin(), result.end(), cpu_info_less );
+					return result;
+				}
+			}
+
+			const cpu_infos& system_cpus()
+			{
+				static const cpu_infos cpus = sorted_system_cpus();
+				return cpus;
+			}
+			std::vector< size_t > parse_cpu_list( const std::string& cpu_list )
+			{
+				std::vector< size_t > result;
+				std::vector< std::string > ranges;
+				const std::string list = boost::trim_copy( cpu_list );
+				if ( list.empty() )
+					return result;
+				boost::split( ranges, list, boost::is_any_of( "," ) );
+				try
+				{
+					for ( size_t i = 0 ; i < ranges.size() ; ++i )
+					{
+						std::vector< std::string > bounds;
+						boost::split( bounds, ranges[ i ], boost::is_any_of( "-" ) );
+						if ( bounds.size() > 2 )
+							throw std::logic_error( "bad cpu list: '" + cpu_list + "'" );
+						const size_t first = boost::lexical_cast< size_t >( boost::trim_copy( bounds.front() ) );
+						const size_t last = boost::lexical_cast< size_t >( boost::trim_copy( bounds.back() ) );
+						if ( last < first )
+							throw std::logic_error( "bad cpu list: '" + cpu_list + "'" );
+						for ( size_t cpu = first ; cpu <= last ; ++cpu )
+							result.push_back( cpu );
+					}
+				}
+				catch ( const boost::bad_lexical_cast& )
+				{
+					throw std::logic_error( "bad cpu list: '" + cpu_list + "'" );
+				}
+				return result;
+			}
+#ifdef _LINUX
+			bool set_current_thread_affinity( const std::vector< size_t >& cpus )
+			{
+				if ( cpus.empty() )
+					return false;
+				cpu_set_t cpu_set;
+				CPU_ZERO( &cpu_set );
+				for ( size_t i = 0 ; i < cpus.size() ; ++i )
+				{
+					if ( cpus[ i ] >= CPU_SETSIZE )
+						return false;
+					CPU_SET( cpus[ i ], &cpu_set );
+				}
+				return pthread_setaffinity_np( pthread_self(), sizeof( cpu_set ), &cpu_set ) == 0;
+			}
+#else
+			bool set_current_thread_affinity( const std::vector< size_t >& )
+			{
+				return false;
+			}
+#endif
+		}
+
+		thread_affinity::thread_affinity( const affinity_policy::value policy )
+			: policy_( policy )
+		{
+			if ( policy_ == affinity_policy::cpu_list )
+				throw std::logic_error( "thread_affinity: cpu_list policy should be created with cpus" );
+		}
+		thread_affinity::thread_affinity( const cpus& cpu_list )
+			: policy_( affinity_policy::cpu_list )
+			, cpus_( cpu_list )
+		{
+			if ( cpus_.empty() )
+				throw std::logic_error( "thread_affinity: cpu list should not be empty" );
+		}
+		thread_affinity thread_affinity::from_string( const std::string& setting )
+		{
+			const std::string value = boost::to_lower_copy( boost::trim_copy( setting ) );
+			if ( value.empty() || value == "none" )
+				return thread_affinity( affinity_policy::none );
+			if ( value == "compact" )
+				return thread_affinity( affinity_policy::compact );
+			if ( value == "scatter" )
+				return thread_affinity( affinity_policy::scatter );
+			if ( value == "numa_node" )
+				return thread_affinity( affinity_policy::numa_node );
+			return thread_affinity( details::parse_cpu_list( value ) );
+		}
+		thread_affinity::cpus thread_affinity::worker_cpus( const size_t worker_index ) const
+		{
+			cpus result;
+			const details::cpu_infos& system = details::system_cpus();
+			switch ( policy_ )
+			{
+			case affinity_policy::none:
+				break;
+			case affinity_policy::compact:
+				result.push_back( system[ worker_index % system.size() ].cpu );
+				break;
+			case affinity_policy::scatter:
+			case affinity_policy::numa_node:
+				{
+					std::vector< size_t > nodes;
+					for ( size_t i = 0 ; i < system.size() ; ++i )
+						if ( nodes.empty() || nodes.back() != system[ i ].node )
+							nodes.push_back( system[ i ].node );
+					const size_t node = nodes[ worker_index % nodes.size() ];
+					cpus node_cpus;
+					for ( size_t i = 0 ; i < system.size() ; ++i )
+						if ( system[ i ].node == node )
+							node_cpus.push_back( system[ i ].cpu );
+					if ( policy_ == affinity_policy::numa_node )
+						result.swap( node_cpus );
+					else
+						result.push_back( node_cpus[ ( worker_index / nodes.size() ) % node_cpus.size() ] );
+				}
+				break;
+			case affinity_policy::cpu_list:
+				result.push_back( cpus_[ worker_index % cpus_.size() ] );
+				break;
+			}
+			return result;
+		}
+		bool thread_affinity::pin_current_thread( const size_t worker_index ) const
+		{
+			if ( policy_ == affinity_policy::none )
+				return false;
+			return details::set_current_thread_affinity( worker_cpus( worker_index ) );
+		}
+	}
+}
@@ -0,0 +1,81 @@
+#ifndef _SYSTEM_UTILITIES_COMMON_THREAD_AFFINITY_H_
+#define _SYSTEM_UTILITIES_COMMON_THREAD_AFFINITY_H_
+
+#include <string>
+#include <vector>
+
+namespace system_utilities
+{
+	// thread_affinity: placement of task_processor processing threads (workers) on cpus, worker pins itself before it starts processing
+	// policies:
+	// none - workers are not pinned (default)
+	// compact - worker i is pinned to i-th cpu, cpus are ordered by numa node, so neighbour workers share node and caches
+	// scatter - workers are distributed round robin over numa nodes, each worker is pinned to one cpu of its node
+	// numa_node - worker i is pinned to all cpus of numa node i % nodes (worker could migrate only inside its node)
+	// cpu_list - worker i is pinned to cpus[ i % cpus.size() ]
+	// only threads are placed, memory is not: own deque of work_stealing_queue is allocated by worker after pinning and so lands on worker node by first-touch policy of OS,
+	// but shared queues and pool_allocator chunks are allocated by threads that add tasks and stay on their nodes
+	// pinning is implemented for linux (pthread_setaffinity_np), on other platforms pin_current_thread() does nothing and returns false
+	// from_string() parses "none", "compact", "scatter", "numa_node" or cpu list like "0,2,4-7" (System.threads.affinity setting of system_processor)
+
+	namespace common
+	{
+		namespace affinity_policy
+		{
+			enum value
+			{
+				none = 0,
+				compact = 1,
+				scatter = 2,
+				numa_node = 3,
+				cpu_list = 4
+			};
+		}
+
+		namespace details
+		{
+			struct cpu_info
+			{
+				size_t cpu;
+				size_t node;
+			};
+			typedef std::vector< cpu_info > cpu_infos;
+
+			// online cpus with their numa nodes, ordered by node and cpu, is read once
+			const cpu_infos& system_cpus();
+			// parses "0,2,4-7" cpu list format (linux sysfs format), throws std::logic_error on bad format
+			std::vector< size_t > parse_cpu_list( const std::string& cpu_list );
+			// returns false if affinity could not be set
+			bool set_current_thread_affinity( const std::vector< size_t >& cpus );
+		}
+
+		class thread_affinity
+		{
+		public:
+			typedef std::vector< size_t > cpus;
+
+		private:
+			affinity_policy::value policy_;
+			cpus cpus_;
+
+		public:
+			explicit thread_affinity( const affinity_policy::value policy = affinity_policy::none );
+			explicit thread_affinity( const cpus& cpu_list );
+
+			// from_string method: throws std::logic_error on unknown setting
+			static thread_affinity from_string( const std::string& setting );
+
+			affinity_policy::value policy() const
+			{
+				return policy_;
+			}
+			// worker_cpus method: cpus for worker with worker_index, empty - worker should not be pinned
+			cpus worker_cpus( const size_t worker_index ) const;
+			// pin_current_thread method: pins calling thread as worker with worker_index
+			// returns true if thread was pinned
+			bool pin_current_thread( const size_t worker_index ) const;
+		};
+	}
+}
+
+#endif // _SYSTEM_UTILITIES_COMMON_THREAD_AFFINITY_H_
@@ -0,0 +1,36 @@
+#ifndef _SYSTEM_UTILITIES_COMMON_CACHE_LINE_H_
+#define _SYSTEM_UTILITIES_COMMON_CACHE_LINE_H_
+
+#include <atomic>
+#include <cstddef>
+
+namespace system_utilities
+{
+	namespace common
+	{
+		namespace details
+		{
+			// cache_line_size: size of cache line on x86/x64 processors
+			static const size_t cache_line_size = 64;
+
+			// padded_atomic: atomic value that owns whole cache line
+			// used to prevent false sharing between counters that are changed by different threads
+			template< class T >
+			struct padded_atomic
+			{
+				std::atomic< T > value;
+			private:
+				char padding_[ cache_line_size - sizeof( std::atomic< T > ) ];
+			};
+
+			// cache_line_padding: put it between fields that should not share one cache line
+			struct cache_line_padding
+			{
+			private:
+				char padding_[ cache_line_size ];
+			};
+		}
+	}
+}
+
+#endif // _SYSTEM_UTILITIES_COMMON_CACHE_LINE_H_
@@ -0,0 +1,32 @@
+#ifndef _SYSTEM_UTILITIES_COMMON_DEADLINE_H_
+#define _SYSTEM_UTILITIES_COMMON_DEADLINE_H_
+
+#include <chrono>
+
+#include <boost/thread/thread_time.hpp>
+
+namespace system_utilities
+{
+	namespace common
+	{
+		namespace details
+		{
+			// deadline_after: converts std::chrono timeout to absolute boost time, that boost::condition::timed_wait understands
+			template< class rep, class period >
+			boost::system_time deadline_after( const std::chrono::duration< rep, period >& timeout )
+			{
+				using namespace std::chrono;
+				const long long timeout_microseconds = duration_cast< microseconds >( timeout ).count();
+				return boost::get_system_time() + boost::posix_time::microseconds( timeout_microseconds > 0 ? timeout_microseconds : 0 );
+			}
+			// deadline_at: converts std::chrono time point of any clock to absolute boost time
+			template< class clock, class duration >
+			boost::system_time deadline_at( const std::chrono::time_point< clock, duration >& time_point )
+			{
+				return deadline_after( time_point - clock::now() );
+			}
+		}
+	}
+}
+
+#endif // _SYSTEM_UTILITIES_COMMON_DEADLINE_H_
@@ -0,0 +1,395 @@
+#ifndef _SYSTEM_UTILITIES_COMMON_LOCK_FREE_QUEUE_H_
+#define _SYSTEM_UTILITIES_COMMON_LOCK_FREE_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+
+#include "cache_line.h"
+#include "deadline.h"
+
+namespace system_utilities
+{
+	// lock_free_queue: bounded lock-free multi-producer multi-consumer queue
+	// ring of cells with sequence numbers (D.Vyukov algorithm), push and pop take one CAS on their own cache line
+	// has the same interface as ts_queue, so it could be used as task_queue parameter of task_processor (and queue_logger)
+	// capacity should be a power of two, push() waits while queue is full
+	// mutex is used only to park threads that wait for message, for free cell or for empty queue
+	// non virtual destructor, please inherit only if you know what are you doing
+
+	namespace common
+	{
+		template< class T, size_t capacity = 65536 >
+		class lock_free_queue
+		{
+			typedef T* element_ptr;
+
+			struct cell
+			{
+				std::atomic< size_t > sequence_;
+				element_ptr element_;
+			};
+
+			static_assert( capacity >= 2 && ( capacity & ( capacity - 1 ) ) == 0, "lock_free_queue capacity should be a power of two" );
+			static const size_t mask_ = capacity - 1;
+
+			explicit lock_free_queue( const lock_free_queue& );
+			lock_free_queue& operator=( const lock_free_queue& );
+		public:
+			typedef element_ptr value_type;
+			typedef size_t size_type;
+			static const size_t capacity_value = capacity;
+
+		private:
+			details::cache_line_padding front_padding_;
+			details::padded_atomic< size_t > enqueue_position_;
+			details::padded_atomic< size_t > dequeue_position_;
+			cell* const cells_;
+
+			std::atomic< bool > stopping_;
+
+			mutable boost::mutex park_protector_;
+			boost::condition push_;
+			boost::condition pop_;
+			boost::condition wait_;
+			std::atomic< size_t > waiting_for_push_;
+			std::atomic< size_t > waiting_for_pop_;
+			std::atomic< size_t > waiting_for_empty_;
+
+		public:
+			explicit lock_free_queue()
+				: cells_( new cell[ capacity ] )
+				, stopping_( false )
+				, waiting_for_push_( 0 )
+				, waiting_for_pop_( 0 )
+				, waiting_for_empty_( 0 )
+			{
+				for ( size_t i = 0 ; i < capacity ; ++i )
+					cells_[ i ].sequence_.store( i, std::memory_order_relaxed );
+				enqueue_position_.value.store( 0 );
+				dequeue_position_.value.store( 0 );
+			}
+			// restart method: stop queue from processing, clear queue (with deleting not processed elements by delete)
+			void restart()
+			{
+				stop_processing();
+				stopping_ = false;
+			}
+			// stop method: stop queue, notify wait(), wait_pop() and push() methods that wait for messages, free cell or result of processing
+			// this method is thread safe
+			void stop()
+			{
+				stopping_ = true;
+				notify_all_();
+			}
+			// stop_processing method: stop queue, notify waiting methods and flush not poped messages with delete.
+			// this method is thread safe
+			void stop_processing()
+			{
+				stopping_ = true;
+				element_ptr element = NULL;
+				while ( try_pop_( element ) )
+					delete element;
+				notify_all_();
+			}
+			// non virtual destructor
+			~lock_free_queue()
+			{
+				stop_processing();
+				delete [] cells_;
+			}
+			// wait method: wait while user call stop(), stop_processing(), ~destructor() methods OR all messages will be poped out queue
+			// if stop(), stop_processing() method was called before - returns immediatly
+			// this method is thread safe
+			void wait()
+			{
+				if ( stopping_ )
+					return;
+				boost::mutex::scoped_lock lock( park_protector_ );
+				++waiting_for_empty_;
+				while ( !empty_() && !stopping_ )
+					wait_.wait( lock );
+				--waiting_for_empty_;
+			}
+			// push() method: push message into queue, if queue is full - wait for free cell
+			// if stop(), stop_processing() method was called before - returns immediatly
+			// returns true - if message was added to queue
+			// returns false - if message was not added to queue, check this parameter it could be reason of memory leak
+			// this method is thread safe
+			bool push( value_type val )
+			{
+				for (;;)
+				{
+					if ( stopping_ )
+						return false;
+					if ( try_push_( val ) )
+					{
+						after_push_();
+						return true;
+					}
+					if ( !full_() )
+					{
+						boost::this_thread::yield();
+						continue;
+					}
+					boost::mutex::scoped_lock lock( park_protector_ );
+					++waiting_for_pop_;
+					while ( full_() && !stopping_ )
+						pop_.wait( lock );
+					--waiting_for_pop_;
+				}
+			}
+			// try_push() method: push() that does not wait for free cell
+			// returns false - if queue is full or stop(), stop_processing() method was called before
+			// this method is thread safe
+			bool try_push( value_type val )
+			{
+				if ( stopping_ || !try_push_( val ) )
+					return false;
+				after_push_();
+				return true;
+			}
+			// push_range() method: push messages [first, last) into queue
+			// returns amount of messages that were added to queue, check this parameter it could be reason of memory leak
+			// this method is thread safe
+			template< class input_iterator >
+			size_t push_range( input_iterator first, input_iterator last )
+			{
+				size_t pushed = 0;
+				for ( ; first != last ; ++first, ++pushed )
+					if ( !push( *first ) )
+						break;
+				return pushed;
+			}
+			// pop() method returns pointer to message that was in queue
+			// if queue is empty - returns NULL
+			// it does not wait for push - just return NULL if there is no messages into queue
+			// this method is thread safe
+			value_type pop()
+			{
+				element_ptr result = NULL;
+				if ( !try_pop_( result ) )
+					return NULL;
+				after_pop_();
+				return result;
+			}
+			// ts_pop() method returns pointer to message that was in queue
+			// if queue is empty or stopping - returns NULL
+			// it does not wait for push - just return NULL if there is no messages into queue
+			// this method is thread safe
+			value_type ts_pop()
+			{
+				if ( stopping_ )
+					return NULL;
+				return pop();
+			}
+			// wait_pop() method returns pointer to message that was in queue
+			// if queue is empty, wait until stop(), stop_processing(), push() will be called.
+			// if queue is stopping - return NULL
+			// this method is thread safe
+			value_type wait_pop()
+			{
+				for (;;)
+				{
+					if ( stopping_ )
+						return NULL;
+					element_ptr result = NULL;
+					if ( try_pop_( result ) )
+					{
+						after_pop_();
+						return result;
+					}
+					wait_for_push_( NULL );
+				}
+			}
+			// wait_pop_bulk() method moves up to max_count messages to out iterator
+			// returns amount of poped messages
+			// if queue is empty, wait until stop(), stop_processing(), push() will be called.
+			// if queue is stopping - return 0
+			// this method is thread safe
+			template< class output_iterator >
+			size_t wait_pop_bulk( output_iterator out, const size_t max_count )
+			{
+				for (;;)
+				{
+					if ( stopping_ )
+						return 0;
+					const size_t poped = pop_bulk_( out, max_count );
+					if ( poped )
+						return poped;
+					wait_for_push_( NULL );
+				}
+			}
+			// wait_pop_bulk() method with timeout: returns 0 if there were no messages during timeout
+			// this method is thread safe
+			template< class output_iterator, class rep, class period >
+			size_t wait_pop_bulk( output_iterator out, const size_t max_count, const std::chrono::duration< rep, period >& timeout )
+			{
+				const boost::system_time deadline = details::deadline_after( timeout );
+				for (;;)
+				{
+					if ( stopping_ )
+						return 0;
+					const size_t poped = pop_bulk_( out, max_count );
+					if ( poped )
+						return poped;
+					if ( !wait_for_push_( &deadline ) )
+						return 0;
+				}
+			}
+			// size() method: returns 0 if queue is going to stop
+			size_t size() const
+			{
+				if ( stopping_ )
+					return 0;
+				return size_();
+			}
+			// ts_size() method: returns queue size
+			// thread safe method
+			size_t ts_size() const
+			{
+				return size_();
+			}
+			// empty() method: return true if queue is going to stop
+			// returns false is queue.size() > 0
+			bool empty() const
+			{
+				if ( stopping_ )
+					return true;
+				return empty_();
+			}
+
+		private:
+			bool try_push_( element_ptr element )
+			{
+				size_t position = enqueue_position_.value.load( std::memory_order_relaxed );
+				cell* c = NULL;
+				for (;;)
+				{
+					c = cells_ + ( position & mask_ );
+					const size_t sequence = c->sequence_.load( std::memory_order_acquire );
+					const std::ptrdiff_t difference = static_cast< std::ptrdiff_t >( sequence - position );
+					if ( difference == 0 )
+					{
+						if ( enqueue_position_.value.compare_exchange_weak( position, position + 1 ) )
+							break;
+					}
+					else if ( difference < 0 )
+						return false;
+					else
+						position = enqueue_position_.value.load( std::memory_order_relaxed );
+				}
+				c->element_ = element;
+				c->sequence_.store( position + 1, std::memory_order_release );
+				return true;
+			}
+			bool try_pop_( element_ptr& element )
+			{
+				size_t position = dequeue_position_.value.load( std::memory_order_relaxed );
+				cell* c = NULL;
+				for (;;)
+				{
+					c = cells_ + ( position & mask_ );
+					const size_t sequence = c->sequence_.load( std::memory_order_acquire );
+					const std::ptrdiff_t difference = static_cast< std::ptrdiff_t >( sequence - ( position + 1 ) );
+					if ( difference == 0 )
+					{
+						if ( dequeue_position_.value.compare_exchange_weak( position, position + 1 ) )
+							break;
+					}
+					else if ( difference < 0 )
+						return false;
+					else
+						position = dequeue_position_.value.load( std::memory_order_relaxed );
+				}
+				element = c->element_;
+				c->sequence_.store( position + capacity, std::memory_order_release );
+				return true;
+			}
+			// waiting counters are incremented under park_protector_ before the state check,
+			// positions are changed by seq_cst CAS before the counters are read, so wake up could not be lost
+			void after_push_()
+			{
+				if ( waiting_for_push_.load() != 0 )
+				{
+					boost::mutex::scoped_lock lock( park_protector_ );
+					push_.notify_one();
+				}
+			}
+			void after_pop_()
+			{
+				if ( waiting_for_pop_.load() != 0 )
+				{
+					boost::mutex::scoped_lock lock( park_protector_ );
+					pop_.notify_one();
+				}
+				if ( waiting_for_empty_.load() != 0 && empty_() )
+				{
+					boost::mutex::scoped_lock lock( park_protector_ );
+					wait_.notify_all();
+				}
+			}
+			template< class output_iterator >
+			size_t pop_bulk_( output_iterator& out, const size_t max_count )
+			{
+				size_t poped = 0;
+				element_ptr element = NULL;
+				while ( poped < max_count && try_pop_( element ) )
+				{
+					*out++ = element;
+					++poped;
+				}
+				if ( poped )
+					after_pop_();
+				return poped;
+			}
+			// wait_for_push_() method: parks thread while queue is empty
+			// returns false if deadline was reached
+			bool wait_for_push_( const boost::system_time* deadline )
+			{
+				if ( !empty_() )
+				{
+					boost::this_thread::yield();
+					return true;
+				}
+				bool result = true;
+				boost::mutex::scoped_lock lock( park_protector_ );
+				++waiting_for_push_;
+				while ( result && empty_() && !stopping_ )
+				{
+					if ( deadline )
+						result = push_.timed_wait( lock, *deadline );
+					else
+						push_.wait( lock );
+				}
+				--waiting_for_push_;
+				return result || !empty_();
+			}
+			void notify_all_()
+			{
+				boost::mutex::scoped_lock lock( park_protector_ );
+				push_.notify_all();
+				pop_.notify_all();
+				wait_.notify_all();
+			}
+			size_t size_() const
+			{
+				const size_t dequeue_position = dequeue_position_.value.load();
+				const size_t enqueue_position = enqueue_position_.value.load();
+				return enqueue_position - dequeue_position;
+			}
+			bool empty_() const
+			{
+				return size_() == 0;
+			}
+			bool full_() const
+			{
+				return size_() >= capacity;
+			}
+		};
+	}
+}
+
+#endif // _SYSTEM_UTILITIES_COMMON_LOCK_FREE_QUEUE_H_
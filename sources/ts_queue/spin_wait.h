@@ -0,0 +1,27 @@
+#ifndef _SYSTEM_UTILITIES_COMMON_SPIN_WAIT_H_
+#define _SYSTEM_UTILITIES_COMMON_SPIN_WAIT_H_
+
+#if defined( _MSC_VER )
+#include <intrin.h>
+#endif
+
+namespace system_utilities
+{
+	namespace common
+	{
+		namespace details
+		{
+			// spin_pause: hint to processor that thread is in busy-wait loop (pause instruction on x86/x64)
+			inline void spin_pause()
+			{
+#if defined( _MSC_VER )
+				_mm_pause();
+#elif defined( __GNUC__ ) && ( defined( __i386__ ) || defined( __x86_64__ ) )
+				__builtin_ia32_pause();
+#endif
+			}
+		}
+	}
+}
+
+#endif // _SYSTEM_UTILITIES_COMMON_SPIN_WAIT_H_
@@ -0,0 +1,154 @@
+#ifndef _SYSTEM_UTILITIES_COMMON_SPSC_BYTE_RING_H_
+#define _SYSTEM_UTILITIES_COMMON_SPSC_BYTE_RING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+#include "cache_line.h"
+
+namespace system_utilities
+{
+	// spsc_byte_ring: bounded single-producer single-consumer ring of variable size records (byte messages)
+	// producer reserves space for record, writes record in place and commits it, there is no allocation and no copy
+	// consumer reads records in place and releases them by one store after callback
+	// records are aligned to record_alignment, record that does not fit into the end of ring starts from ring begin (end of ring is skipped by wrap marker)
+	// record could not be bigger than capacity / 2
+	// reserve() / commit() should be called from one producer thread, consume() from one consumer thread, other methods are thread safe
+	// capacity should be a power of two
+	// non virtual destructor, please inherit only if you know what are you doing
+
+	namespace common
+	{
+		class spsc_byte_ring
+		{
+			typedef unsigned int header_type;
+			static const header_type wrap_marker = ~0u;
+
+			explicit spsc_byte_ring( const spsc_byte_ring& );
+			spsc_byte_ring& operator=( const spsc_byte_ring& );
+		public:
+			static const size_t record_alignment = 8;
+			static const size_t header_size = record_alignment;
+
+		private:
+			const size_t capacity_;
+			const size_t mask_;
+			char* const buffer_;
+			details::cache_line_padding front_padding_;
+			std::atomic< size_t > head_;
+			size_t tail_cache_;
+			details::cache_line_padding head_padding_;
+			std::atomic< size_t > tail_;
+			size_t head_cache_;
+			size_t reserved_tail_;
+			details::cache_line_padding tail_padding_;
+
+			static size_t aligned_( const size_t size )
+			{
+				return ( size + record_alignment - 1 ) & ~( record_alignment - 1 );
+			}
+		public:
+			// capacity is rounded up to power of two
+			explicit spsc_byte_ring( const size_t capacity )
+				: capacity_( round_capacity_( capacity ) )
+				, mask_( capacity_ - 1 )
+				, buffer_( new char[ capacity_ ] )
+				, head_( 0 )
+				, tail_cache_( 0 )
+				, tail_( 0 )
+				, head_cache_( 0 )
+				, reserved_tail_( 0 )
+			{
+			}
+			~spsc_byte_ring()
+			{
+				delete [] buffer_;
+			}
+			size_t capacity() const
+			{
+				return capacity_;
+			}
+			// max_record_size method: biggest record size (without header) that could be reserved
+			size_t max_record_size() const
+			{
+				return capacity_ / 2 - header_size;
+			}
+			// reserve method: returns pointer to size bytes for record or NULL if ring is full (record is not written)
+			// reserved record should be committed before next reserve
+			char* reserve( const size_t size )
+			{
+				if ( size > max_record_size() )
+					return NULL;
+				const size_t record_size = aligned_( size + header_size );
+				size_t tail = tail_.load( std::memory_order_relaxed );
+				const size_t to_end = capacity_ - ( tail & mask_ );
+				const size_t needed = to_end < record_size ? to_end + record_size : record_size;
+				if ( capacity_ - ( tail - head_cache_ ) < needed )
+				{
+					head_cache_ = head_.load( std::memory_order_acquire );
+					if ( capacity_ - ( tail - head_cache_ ) < needed )
+						return NULL;
+				}
+				if ( to_end < record_size )
+				{
+					const header_type marker = wrap_marker;
+					std::memcpy( buffer_ + ( tail & mask_ ), &marker, sizeof( marker ) );
+					tail += to_end;
+				}
+				const header_type header = static_cast< header_type >( record_size );
+				std::memcpy( buffer_ + ( tail & mask_ ), &header, sizeof( header ) );
+				reserved_tail_ = tail + record_size;
+				return buffer_ + ( tail & mask_ ) + header_size;
+			}
+			// commit method: publishes reserved record to consumer
+			void commit()
+			{
+				tail_.store( reserved_tail_, std::memory_order_release );
+			}
+			// consume method: calls handler( const char* record ) for every committed record, returns amount of records
+			// record memory is valid only inside handler
+			template< class handler >
+			size_t consume( handler& h )
+			{
+				size_t head = head_.load( std::memory_order_relaxed );
+				if ( head == tail_cache_ )
+				{
+					tail_cache_ = tail_.load( std::memory_order_acquire );
+					if ( head == tail_cache_ )
+						return 0;
+				}
+				size_t consumed = 0;
+				while ( head != tail_cache_ )
+				{
+					header_type header = 0;
+					std::memcpy( &header, buffer_ + ( head & mask_ ), sizeof( header ) );
+					if ( header == wrap_marker )
+					{
+						head += capacity_ - ( head & mask_ );
+						continue;
+					}
+					h( static_cast< const char* >( buffer_ + ( head & mask_ ) + header_size ) );
+					head += header;
+					++consumed;
+				}
+				head_.store( head, std::memory_order_release );
+				return consumed;
+			}
+			bool empty() const
+			{
+				return head_.load( std::memory_order_acquire ) == tail_.load( std::memory_order_acquire );
+			}
+		private:
+			static size_t round_capacity_( const size_t capacity )
+			{
+				size_t result = 64;
+				while ( result < capacity )
+					result <<= 1;
+				return result;
+			}
+		};
+	}
+}
+
+#endif // _SYSTEM_UTILITIES_COMMON_SPSC_BYTE_RING_H_
@@ -0,0 +1,378 @@
+#ifndef _SYSTEM_UTILITIES_COMMON_SPSC_QUEUE_H_
+#define _SYSTEM_UTILITIES_COMMON_SPSC_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+
+#include "cache_line.h"
+#include "deadline.h"
+
+namespace system_utilities
+{
+	// spsc_queue: bounded single-producer single-consumer queue
+	// push() and pop() are wait-free: one acquire load (only when cached position is exhausted), one release store and one seq_cst fence
+	// the fence is a departure from acquire/release only design: it is the price of parking without polling (mfence or locked instruction on x86, tens of cycles per call,
+	// pop_bulk() pays it once per batch), without it store of position and load of waiting flag could be reordered and wake up of parked side could be lost
+	// consumer position (head) and producer position (tail) are placed on separate cache lines, each side keeps cached copy of other side position
+	// has the same interface as ts_queue, so it could be used as task_queue parameter of task_processor with one processing thread and one producer
+	// push(), pop(), ts_pop(), wait_pop() should be called from one producer and one consumer thread only, other methods are thread safe
+	// stop_processing() flushes not poped messages, so it should not be called concurrently with consumer
+	// capacity should be a power of two, push() waits while queue is full
+	// waiting threads spin (yield) park_spins times before they are parked on condition, so short gaps between messages do not cost mutex and condition
+	// parked side and publishing side separate waiting flag and queue position by seq_cst fences,
+	// so either side that changes position sees waiting flag or waiting side sees new position, wake up could not be lost
+	// non virtual destructor, please inherit only if you know what are you doing
+
+	namespace common
+	{
+		template< class T, size_t capacity = 65536 >
+		class spsc_queue
+		{
+			typedef T* element_ptr;
+
+			static_assert( capacity >= 2 && ( capacity & ( capacity - 1 ) ) == 0, "spsc_queue capacity should be a power of two" );
+			static const size_t mask_ = capacity - 1;
+			static const size_t park_spins = 16;
+
+			explicit spsc_queue( const spsc_queue& );
+			spsc_queue& operator=( const spsc_queue& );
+		public:
+			typedef element_ptr value_type;
+			typedef size_t size_type;
+			static const size_t capacity_value = capacity;
+
+		private:
+			details::cache_line_padding front_padding_;
+			std::atomic< size_t > head_;
+			size_t tail_cache_;
+			details::cache_line_padding head_padding_;
+			std::atomic< size_t > tail_;
+			size_t head_cache_;
+			details::cache_line_padding tail_padding_;
+			element_ptr* const elements_;
+
+			std::atomic< bool > stopping_;
+
+			mutable boost::mutex park_protector_;
+			boost::condition push_;
+			boost::condition pop_;
+			boost::condition wait_;
+			std::atomic< bool > consumer_waiting_;
+			std::atomic< bool > producer_waiting_;
+			std::atomic< size_t > waiting_for_empty_;
+
+		public:
+			explicit spsc_queue()
+				: head_( 0 )
+				, tail_cache_( 0 )
+				, tail_( 0 )
+				, head_cache_( 0 )
+				, elements_( new element_ptr[ capacity ] )
+				, stopping_( false )
+				, consumer_waiting_( false )
+				, producer_waiting_( false )
+				, waiting_for_empty_( 0 )
+			{
+			}
+			// restart method: stop queue from processing, clear queue (with deleting not processed elements by delete)
+			void restart()
+			{
+				stop_processing();
+				stopping_.store( false, std::memory_order_release );
+			}
+			// stop method: stop queue, notify wait(), wait_pop() and push() methods that wait for messages, free cell or result of processing
+			// this method is thread safe
+			void stop()
+			{
+				stopping_.store( true, std::memory_order_release );
+				notify_all_();
+			}
+			// stop_processing method: stop queue, notify waiting methods and flush not poped messages with delete.
+			void stop_processing()
+			{
+				stopping_.store( true, std::memory_order_release );
+				element_ptr element = NULL;
+				while ( try_pop_( element ) )
+					delete element;
+				notify_all_();
+			}
+			// non virtual destructor
+			~spsc_queue()
+			{
+				stop_processing();
+				delete [] elements_;
+			}
+			// wait method: wait while user call stop(), stop_processing(), ~destructor() methods OR all messages will be poped out queue
+			// if stop(), stop_processing() method was called before - returns immediatly
+			// this method is thread safe
+			void wait()
+			{
+				if ( stopping_.load( std::memory_order_acquire ) )
+					return;
+				boost::mutex::scoped_lock lock( park_protector_ );
+				waiting_for_empty_.fetch_add( 1, std::memory_order_relaxed );
+				std::atomic_thread_fence( std::memory_order_seq_cst );
+				while ( !empty_() && !stopping_.load( std::memory_order_acquire ) )
+					wait_.wait( lock );
+				waiting_for_empty_.fetch_sub( 1, std::memory_order_relaxed );
+			}
+			// push() method: push message into queue, if queue is full - wait for free cell
+			// if stop(), stop_processing() method was called before - returns immediatly
+			// returns true - if message was added to queue
+			// returns false - if message was not added to queue, check this parameter it could be reason of memory leak
+			// producer thread only
+			bool push( value_type val )
+			{
+				for (;;)
+				{
+					if ( stopping_.load( std::memory_order_acquire ) )
+						return false;
+					if ( try_push_( val ) )
+					{
+						after_push_();
+						return true;
+					}
+					if ( spin_while_( &spsc_queue::full_ ) )
+						continue;
+					boost::mutex::scoped_lock lock( park_protector_ );
+					producer_waiting_.store( true, std::memory_order_relaxed );
+					std::atomic_thread_fence( std::memory_order_seq_cst );
+					while ( full_() && !stopping_.load( std::memory_order_acquire ) )
+						pop_.wait( lock );
+					producer_waiting_.store( false, std::memory_order_relaxed );
+				}
+			}
+			// push_range() method: push messages [first, last) into queue
+			// returns amount of messages that were added to queue, check this parameter it could be reason of memory leak
+			// producer thread only
+			template< class input_iterator >
+			size_t push_range( input_iterator first, input_iterator last )
+			{
+				size_t pushed = 0;
+				for ( ; first != last ; ++first, ++pushed )
+					if ( !push( *first ) )
+						break;
+				return pushed;
+			}
+			// pop() method returns pointer to message that was in queue
+			// if queue is empty - returns NULL
+			// it does not wait for push - just return NULL if there is no messages into queue
+			// consumer thread only
+			value_type pop()
+			{
+				element_ptr result = NULL;
+				if ( !try_pop_( result ) )
+					return NULL;
+				after_pop_();
+				return result;
+			}
+			// ts_pop() method returns pointer to message that was in queue
+			// if queue is empty or stopping - returns NULL
+			// consumer thread only
+			value_type ts_pop()
+			{
+				if ( stopping_.load( std::memory_order_acquire ) )
+					return NULL;
+				return pop();
+			}
+			// wait_pop() method returns pointer to message that was in queue
+			// if queue is empty, wait until stop(), stop_processing(), push() will be called.
+			// if queue is stopping - return NULL
+			// consumer thread only
+			value_type wait_pop()
+			{
+				for (;;)
+				{
+					if ( stopping_.load( std::memory_order_acquire ) )
+						return NULL;
+					element_ptr result = NULL;
+					if ( try_pop_( result ) )
+					{
+						after_pop_();
+						return result;
+					}
+					wait_for_push_( NULL );
+				}
+			}
+			// wait_pop_bulk() method moves up to max_count messages to out iterator
+			// returns amount of poped messages
+			// if queue is empty, wait until stop(), stop_processing(), push() will be called.
+			// if queue is stopping - return 0
+			// consumer thread only
+			template< class output_iterator >
+			size_t wait_pop_bulk( output_iterator out, const size_t max_count )
+			{
+				for (;;)
+				{
+					if ( stopping_.load( std::memory_order_acquire ) )
+						return 0;
+					const size_t poped = pop_bulk_( out, max_count );
+					if ( poped )
+						return poped;
+					wait_for_push_( NULL );
+				}
+			}
+			// wait_pop_bulk() method with timeout: returns 0 if there were no messages during timeout
+			// consumer thread only
+			template< class output_iterator, class rep, class period >
+			size_t wait_pop_bulk( output_iterator out, const size_t max_count, const std::chrono::duration< rep, period >& timeout )
+			{
+				const boost::system_time deadline = details::deadline_after( timeout );
+				for (;;)
+				{
+					if ( stopping_.load( std::memory_order_acquire ) )
+						return 0;
+					const size_t poped = pop_bulk_( out, max_count );
+					if ( poped )
+						return poped;
+					if ( !wait_for_push_( &deadline ) )
+						return 0;
+				}
+			}
+			// size() method: returns 0 if queue is going to stop
+			size_t size() const
+			{
+				if ( stopping_.load( std::memory_order_acquire ) )
+					return 0;
+				return size_();
+			}
+			// ts_size() method: returns queue size
+			// thread safe method
+			size_t ts_size() const
+			{
+				return size_();
+			}
+			// empty() method: return true if queue is going to stop
+			// returns false is queue.size() > 0
+			bool empty() const
+			{
+				if ( stopping_.load( std::memory_order_acquire ) )
+					return true;
+				return empty_();
+			}
+
+		private:
+			bool try_push_( element_ptr element )
+			{
+				const size_t tail = tail_.load( std::memory_order_relaxed );
+				if ( tail - head_cache_ >= capacity )
+				{
+					head_cache_ = head_.load( std::memory_order_acquire );
+					if ( tail - head_cache_ >= capacity )
+						return false;
+				}
+				elements_[ tail & mask_ ] = element;
+				tail_.store( tail + 1, std::memory_order_release );
+				return true;
+			}
+			bool try_pop_( element_ptr& element )
+			{
+				const size_t head = head_.load( std::memory_order_relaxed );
+				if ( head == tail_cache_ )
+				{
+					tail_cache_ = tail_.load( std::memory_order_acquire );
+					if ( head == tail_cache_ )
+						return false;
+				}
+				element = elements_[ head & mask_ ];
+				head_.store( head + 1, std::memory_order_release );
+				return true;
+			}
+			template< class output_iterator >
+			size_t pop_bulk_( output_iterator& out, const size_t max_count )
+			{
+				size_t poped = 0;
+				element_ptr element = NULL;
+				while ( poped < max_count && try_pop_( element ) )
+				{
+					*out++ = element;
+					++poped;
+				}
+				if ( poped )
+					after_pop_();
+				return poped;
+			}
+			// wait_for_push_() method: parks consumer while queue is empty
+			// returns false if deadline was reached
+			// waiting flag is set under park_protector_ before the fence and the check, producer notifies under the same lock
+			bool wait_for_push_( const boost::system_time* deadline )
+			{
+				if ( spin_while_( &spsc_queue::empty_ ) )
+					return true;
+				boost::mutex::scoped_lock lock( park_protector_ );
+				consumer_waiting_.store( true, std::memory_order_relaxed );
+				std::atomic_thread_fence( std::memory_order_seq_cst );
+				bool result = true;
+				while ( result && empty_() && !stopping_.load( std::memory_order_acquire ) )
+				{
+					if ( deadline )
+						result = push_.timed_wait( lock, *deadline );
+					else
+						push_.wait( lock );
+				}
+				consumer_waiting_.store( false, std::memory_order_relaxed );
+				return result || !empty_();
+			}
+			// spin_while_() method: yields while condition holds, returns true if condition was changed or queue is stopping before park_spins yields
+			bool spin_while_( bool ( spsc_queue::*condition )() const ) const
+			{
+				for ( size_t i = 0 ; i < park_spins ; ++i )
+				{
+					if ( !( this->*condition )() || stopping_.load( std::memory_order_acquire ) )
+						return true;
+					boost::this_thread::yield();
+				}
+				return false;
+			}
+			// position is published before the fence, waiting flags are read after it
+			void after_push_()
+			{
+				std::atomic_thread_fence( std::memory_order_seq_cst );
+				if ( consumer_waiting_.load( std::memory_order_relaxed ) )
+					notify_( push_ );
+			}
+			void after_pop_()
+			{
+				std::atomic_thread_fence( std::memory_order_seq_cst );
+				if ( producer_waiting_.load( std::memory_order_relaxed ) )
+					notify_( pop_ );
+				if ( waiting_for_empty_.load( std::memory_order_relaxed ) != 0 && empty_() )
+				{
+					boost::mutex::scoped_lock lock( park_protector_ );
+					wait_.notify_all();
+				}
+			}
+			void notify_( boost::condition& condition )
+			{
+				boost::mutex::scoped_lock lock( park_protector_ );
+				condition.notify_one();
+			}
+			void notify_all_()
+			{
+				boost::mutex::scoped_lock lock( park_protector_ );
+				push_.notify_all();
+				pop_.notify_all();
+				wait_.notify_all();
+			}
+			size_t size_() const
+			{
+				const size_t head = head_.load( std::memory_order_acquire );
+				const size_t tail = tail_.load( std::memory_order_acquire );
+				return tail - head;
+			}
+			bool empty_() const
+			{
+				return size_() == 0;
+			}
+			bool full_() const
+			{
+				return size_() >= capacity;
+			}
+		};
+	}
+}
+
+#endif // _SYSTEM_UTILITIES_COMMON_SPSC_QUEUE_H_
@@ -0,0 +1,390 @@
+#ifndef _SYSTEM_UTILITIES_COMMON_TS_PRIORITY_QUEUE_H_
+#define _SYSTEM_UTILITIES_COMMON_TS_PRIORITY_QUEUE_H_
+
+#include <atomic>
+#include <list>
+
+#include <boost/function.hpp>
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+
+#include "deadline.h"
+#include "ts_queue.h"
+
+namespace system_utilities
+{
+	// ts_priority_queue: thread safe queue with fixed amount of priority lanes, each lane is separate FIFO
+	// lane 0 has the highest priority, push() without priority uses the lowest priority lane (lanes_count - 1)
+	// anti-starvation aging: lane that was passed over aging_limit times while it had messages is served next, so low priority lanes still progress
+	// has the same interface as ts_queue, so it could be used as task_queue parameter of task_processor (see task_processor::add_task( task, priority )),
+	// including wait_pop_bulk() for batch and elastic modes and set_capacity() for bounded task queue, spin_count is not supported
+	// set_capacity() limits size of all lanes together, overflow policies are the same as in ts_queue (see capacity_settings),
+	// drop_oldest (and sample) drops the oldest message of the lowest priority not empty lane
+	// non virtual destructor, please inherit only if you know what are you doing
+
+	namespace common
+	{
+		template< class T, size_t lanes_count = 4 >
+		class ts_priority_queue
+		{
+			typedef T* element_ptr;
+			typedef std::list< element_ptr > lane;
+
+			static_assert( lanes_count >= 1, "ts_priority_queue should have at least one lane" );
+
+			explicit ts_priority_queue( const ts_priority_queue& );
+			ts_priority_queue& operator=( const ts_priority_queue& );
+		public:
+			typedef element_ptr value_type;
+			typedef size_t size_type;
+			static const size_t lanes = lanes_count;
+			static const size_t default_priority = lanes_count - 1;
+			typedef typename details::queue_capacity< value_type >::drop_handler drop_handler;
+
+		private:
+			lane lanes_[ lanes_count ];
+			size_t skipped_[ lanes_count ];
+			size_t size_;
+			const size_t aging_limit_;
+
+			mutable boost::mutex queue_protector_;
+			boost::condition push_;
+			boost::condition wait_;
+			size_t waiting_for_push_;
+
+			// capacity limit, changed under queue_protector_ lock
+			details::queue_capacity< value_type > capacity_;
+
+			volatile bool stopping_;
+
+		public:
+			explicit ts_priority_queue( const size_t aging_limit = 64 )
+				: size_( 0 )
+				, aging_limit_( aging_limit )
+				, waiting_for_push_( 0 )
+				, stopping_( false )
+			{
+				for ( size_t i = 0 ; i < lanes_count ; ++i )
+					skipped_[ i ] = 0;
+			}
+			// set_capacity method: limits size of all lanes, handler gets messages dropped by drop_newest, drop_oldest and sample policies
+			// empty handler - dropped messages are deleted
+			// should be called before producers start, producers that wait for free space are woken up
+			void set_capacity( const capacity_settings& settings, const drop_handler& handler = drop_handler() )
+			{
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				capacity_.set( settings, handler );
+			}
+			size_t capacity() const
+			{
+				return capacity_.capacity();
+			}
+			// dropped method: amount of messages that were not pushed (fail, block_for) or were dropped because of capacity limit
+			size_t dropped() const
+			{
+				return capacity_.dropped();
+			}
+			// restart method: stop queue from processing, clear queue (with deleting not processed elements by delete)
+			void restart()
+			{
+				stop_processing();
+				stopping_ = false;
+			}
+			// stop method: stop queue, notify wait() and wait_pop() methods that wait for messages or result of processing
+			// this method is thread safe
+			void stop()
+			{
+				stopping_ = true;
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				push_.notify_all();
+				capacity_.stop();
+				wait_.notify_all();
+			}
+			// stop_processing method: stop queue, notify wait() and wait_pop() methods and flush not poped messages with delete.
+			// this method is thread safe
+			void stop_processing()
+			{
+				stopping_ = true;
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				for ( size_t i = 0 ; i < lanes_count ; ++i )
+				{
+					while ( !lanes_[ i ].empty() )
+					{
+						delete lanes_[ i ].front();
+						lanes_[ i ].pop_front();
+					}
+					skipped_[ i ] = 0;
+				}
+				size_ = 0;
+				push_.notify_all();
+				capacity_.stop();
+				wait_.notify_all();
+			}
+			// non virtual destructor
+			~ts_priority_queue()
+			{
+				stop_processing();
+			}
+			// wait method: wait while user call stop(), stop_processing(), ~destructor() methods OR all messages will be poped out queue
+			// if stop(), stop_processing() method was called before - returns immediatly
+			// this method is thread safe
+			void wait()
+			{
+				if (stopping_)
+					return;
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				while (size_ != 0 && !stopping_)
+					wait_.wait( lock );
+			}
+			// push() method: push message into the lowest priority lane
+			// returns false - if stop(), stop_processing() method was called before, check this parameter it could be reason of memory leak
+			// this method is thread safe
+			bool push( value_type val )
+			{
+				return push( val, default_priority );
+			}
+			// push() method: push message into priority lane, 0 is the highest priority, priorities greater than lanes_count - 1 go to the lowest lane
+			// returns true - if message was added to queue (or was dropped by overflow policy)
+			// returns false - if stop(), stop_processing() method was called before or message was not added because of capacity limit,
+			// check this parameter it could be reason of memory leak
+			// this method is thread safe
+			bool push( value_type val, const size_t priority )
+			{
+				if (stopping_)
+					return false;
+				value_type dropped = NULL;
+				drop_handler handler;
+				{
+					boost::mutex::scoped_lock lock( queue_protector_ );
+					if (stopping_)
+						return false;
+					if ( capacity_.full( size_ ) )
+					{
+						switch ( capacity_.overflow( lock, [ this ]() { return size_; }, stopping_ ) )
+						{
+						case details::overflow_reject:
+							return false;
+						case details::overflow_drop_newest:
+							dropped = val;
+							break;
+						case details::overflow_drop_oldest:
+							dropped = pop_lowest_();
+							break;
+						case details::overflow_push:
+							break;
+						}
+						// handler is copied under lock, set_capacity() could change it
+						if ( dropped )
+							handler = capacity_.handler();
+					}
+					if ( dropped != val )
+					{
+						lanes_[ priority < lanes_count ? priority : default_priority ].push_back( val );
+						++size_;
+						push_.notify_one();
+					}
+				}
+				if ( dropped )
+				{
+					if ( handler )
+						handler( dropped );
+					else
+						delete dropped;
+				}
+				return true;
+			}
+			// try_push() method: push() into the lowest priority lane that never waits and never drops messages
+			// returns false - if queue is full (capacity limit, any overflow policy) or stop(), stop_processing() method was called before
+			// this method is thread safe
+			bool try_push( value_type val )
+			{
+				return try_push( val, default_priority );
+			}
+			// try_push() method: push() into priority lane that never waits and never drops messages
+			// this method is thread safe
+			bool try_push( value_type val, const size_t priority )
+			{
+				if (stopping_)
+					return false;
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				if (stopping_ || capacity_.full( size_ ))
+					return false;
+				lanes_[ priority < lanes_count ? priority : default_priority ].push_back( val );
+				++size_;
+				push_.notify_one();
+				return true;
+			}
+			// ts_pop() method returns pointer to message of the highest priority (taking aging into account)
+			// if queue is empty or stopping - returns NULL
+			// it does not wait for push
+			// this method is thread safe
+			value_type ts_pop()
+			{
+				if (stopping_)
+					return NULL;
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				if (stopping_ || size_ == 0)
+					return NULL;
+				return pop_();
+			}
+			// pop() method: the same as ts_pop() but does not check stopping flag
+			// this method is thread safe
+			value_type pop()
+			{
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				if (size_ == 0)
+					return NULL;
+				return pop_();
+			}
+			// wait_pop() method returns pointer to message of the highest priority (taking aging into account)
+			// if queue is empty, wait until stop(), stop_processing(), push() will be called.
+			// if queue is stopping - return NULL
+			// this method is thread safe
+			value_type wait_pop()
+			{
+				if (stopping_)
+					return NULL;
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				if (!wait_for_push_( lock, NULL ))
+					return NULL;
+				return pop_();
+			}
+			// wait_pop_bulk() method moves up to max_count messages to out iterator under one lock, in the same order as wait_pop() returns them
+			// returns amount of poped messages
+			// if queue is empty, wait until stop(), stop_processing(), push() will be called.
+			// if queue is stopping - return 0
+			// this method is thread safe
+			template< class output_iterator >
+			size_t wait_pop_bulk( output_iterator out, const size_t max_count )
+			{
+				return wait_pop_bulk_( out, max_count, NULL );
+			}
+			// wait_pop_bulk() method with timeout: returns 0 if there were no messages during timeout
+			// this method is thread safe
+			template< class output_iterator, class rep, class period >
+			size_t wait_pop_bulk( output_iterator out, const size_t max_count, const std::chrono::duration< rep, period >& timeout )
+			{
+				const boost::system_time deadline = details::deadline_after( timeout );
+				return wait_pop_bulk_( out, max_count, &deadline );
+			}
+			// size() method: returns 0 if queue is going to stop
+			size_t size() const
+			{
+				if (stopping_)
+					return 0;
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				return size_;
+			}
+			// ts_size() method: returns queue size
+			// thread safe method
+			size_t ts_size() const
+			{
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				return size_;
+			}
+			// lane_size() method: returns amount of messages in priority lane
+			// thread safe method
+			size_t lane_size( const size_t priority ) const
+			{
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				return lanes_[ priority < lanes_count ? priority : default_priority ].size();
+			}
+			// empty() method: return true if queue is going to stop
+			// returns false is queue.size() > 0
+			bool empty() const
+			{
+				if (stopping_)
+					return true;
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				return size_ == 0;
+			}
+
+		private:
+			// should be called under queue_protector_ lock with size_ > 0
+			// removes the oldest message of the lowest priority not empty lane
+			value_type pop_lowest_()
+			{
+				size_t selected = lanes_count - 1;
+				while ( lanes_[ selected ].empty() )
+					--selected;
+				value_type result = lanes_[ selected ].front();
+				lanes_[ selected ].pop_front();
+				--size_;
+				if ( lanes_[ selected ].empty() )
+					skipped_[ selected ] = 0;
+				return result;
+			}
+			// should be called under queue_protector_ lock
+			// returns false if queue is stopping or deadline was reached while queue is empty
+			bool wait_for_push_( boost::mutex::scoped_lock& lock, const boost::system_time* deadline )
+			{
+				if (stopping_)
+					return false;
+				while (size_ == 0)
+				{
+					++waiting_for_push_;
+					bool notified = true;
+					if (deadline)
+						notified = push_.timed_wait( lock, *deadline );
+					else
+						push_.wait( lock );
+					--waiting_for_push_;
+					if (stopping_)
+						return false;
+					if (!notified && size_ == 0)
+						return false;
+				}
+				return true;
+			}
+			template< class output_iterator >
+			size_t wait_pop_bulk_( output_iterator out, const size_t max_count, const boost::system_time* deadline )
+			{
+				if (stopping_)
+					return 0;
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				if (!wait_for_push_( lock, deadline ))
+					return 0;
+				size_t poped = 0;
+				while ( poped < max_count && size_ != 0 )
+				{
+					*out++ = pop_();
+					++poped;
+				}
+				// consumer that leaves messages behind passes notification to next waiting one
+				if ( size_ != 0 && waiting_for_push_ != 0 )
+					push_.notify_one();
+				return poped;
+			}
+			// should be called under queue_protector_ lock with size_ > 0
+			value_type pop_()
+			{
+				const size_t selected = select_lane_();
+				for ( size_t i = selected + 1 ; i < lanes_count ; ++i )
+					if ( !lanes_[ i ].empty() )
+						++skipped_[ i ];
+				skipped_[ selected ] = 0;
+				value_type result = lanes_[ selected ].front();
+				lanes_[ selected ].pop_front();
+				--size_;
+				if (size_ == 0)
+					wait_.notify_all();
+				// one place was freed, so one producer is woken up
+				capacity_.freed( 1 );
+				return result;
+			}
+			// starving lane with the lowest priority goes first, otherwise the highest priority not empty lane
+			size_t select_lane_() const
+			{
+				for ( size_t i = lanes_count - 1 ; i > 0 ; --i )
+					if ( skipped_[ i ] >= aging_limit_ && !lanes_[ i ].empty() )
+						return i;
+				size_t result = 0;
+				while ( lanes_[ result ].empty() )
+					++result;
+				return result;
+			}
+		};
+	}
+}
+
+#endif // _SYSTEM_UTILITIES_COMMON_TS_PRIORITY_QUEUE_H_
@@ -1,3 +1,10 @@
 #include "ts_queue.h"
+#include "lock_free_queue.h"
+#include "spsc_queue.h"
+#include "ts_value_queue.h"
+#include "ts_priority_queue.h"
+#include "work_stealing_queue.h"
+#include "deadline.h"
+#include "spin_wait.h"
 
 
@@ -1,21 +1,194 @@
 #ifndef _SYSTEM_UTILITIES_COMMON_TS_QUEUE_H_
 #define _SYSTEM_UTILITIES_COMMON_TS_QUEUE_H_
 
+#include <atomic>
+#include <chrono>
 #include <list>
 
+#include <boost/function.hpp>
 #include <boost/thread.hpp>
 #include <boost/thread/condition.hpp>
 
+#include "deadline.h"
+#include "spin_wait.h"
+
 namespace system_utilities
 {
 	// ts_queue: thread safe queue
 	// this queue emulate default queue with thread safe protection
 	// could be used into nultithread application
 	// on 4 PC System demonstrate 2*10^6 push-pop iterations by 10-20 threads per second
+	// spin_count constructor parameter: waiting consumers busy-poll queue size spin_count times before sleeping on condition,
+	// it removes wake up latency for bursty traffic for the price of CPU time, 0 (default) means sleep immediately
+	// spinning makes sense only when producers and consumers have their own cores
+	// set_capacity() method limits queue size, overflow_policy defines what push() does with full queue:
+	// block - waits until consumer pops message, block_for - waits not longer than block_timeout, then fails
+	// fail - returns false immediately, drop_newest - drops pushed message, drop_oldest - drops message from queue front
+	// sample - drops pushed message, but every sample_rate-th overflow drops queue front and pushes message (queue keeps sample of newest messages)
+	// dropped messages are given to drop handler (delete by default), push() returns true for them, dropped() counts all failed and dropped messages
 	// non virtual destructor, please inherit only if you know what are you doing
 
     namespace common
     {
+		namespace overflow_policy
+		{
+			enum value
+			{
+				block = 0,
+				block_for = 1,
+				fail = 2,
+				drop_newest = 3,
+				drop_oldest = 4,
+				sample = 5
+			};
+		}
+
+		struct capacity_settings
+		{
+			// 0 - queue is not limited
+			size_t capacity;
+			overflow_policy::value policy;
+			std::chrono::milliseconds block_timeout;
+			size_t sample_rate;
+
+			explicit capacity_settings( const size_t capacity_value = 0, const overflow_policy::value policy_value = overflow_policy::block,
+				const std::chrono::milliseconds block_timeout_value = std::chrono::milliseconds( 0 ), const size_t sample_rate_value = 16 )
+				: capacity( capacity_value )
+				, policy( policy_value )
+				, block_timeout( block_timeout_value )
+				, sample_rate( sample_rate_value ? sample_rate_value : 1 )
+			{
+			}
+		};
+
+		namespace details
+		{
+			enum overflow_action
+			{
+				overflow_push,
+				overflow_reject,
+				overflow_drop_newest,
+				overflow_drop_oldest
+			};
+
+			// queue_capacity: capacity limit and overflow policy of bounded queue, shared by ts_queue and ts_priority_queue
+			// all methods except capacity() and dropped() should be called under queue lock
+			template< class value_type >
+			class queue_capacity
+			{
+			public:
+				typedef boost::function< void ( value_type ) > drop_handler;
+
+			private:
+				std::atomic< size_t > capacity_;
+				capacity_settings settings_;
+				drop_handler drop_handler_;
+				boost::condition free_space_;
+				size_t waiting_for_pop_;
+				size_t overflows_;
+				std::atomic< size_t > dropped_;
+
+				explicit queue_capacity( const queue_capacity& );
+				queue_capacity& operator=( const queue_capacity& );
+			public:
+				queue_capacity()
+					: capacity_( 0 )
+					, waiting_for_pop_( 0 )
+					, overflows_( 0 )
+					, dropped_( 0 )
+				{
+				}
+				// set method: producers that wait for free space are woken up
+				void set( const capacity_settings& settings, const drop_handler& handler )
+				{
+					settings_ = settings;
+					drop_handler_ = handler;
+					capacity_ = settings.capacity;
+					free_space_.notify_all();
+				}
+				size_t capacity() const
+				{
+					return capacity_.load( std::memory_order_relaxed );
+				}
+				size_t dropped() const
+				{
+					return dropped_.load( std::memory_order_relaxed );
+				}
+				bool full( const size_t size ) const
+				{
+					const size_t capacity = capacity_.load( std::memory_order_relaxed );
+					return capacity && size >= capacity;
+				}
+				// handler method: copy of drop handler, it is called after queue lock is released
+				drop_handler handler() const
+				{
+					return drop_handler_;
+				}
+				// waiting method: there are producers that wait for free space
+				bool waiting() const
+				{
+					return waiting_for_pop_ != 0;
+				}
+				// freed method: producers that wait for free space are woken up one per freed place
+				void freed( const size_t amount )
+				{
+					if ( waiting_for_pop_ == 0 || amount == 0 )
+						return;
+					if ( amount == 1 )
+						free_space_.notify_one();
+					else
+						free_space_.notify_all();
+				}
+				void stop()
+				{
+					free_space_.notify_all();
+				}
+				// overflow method: queue is full, size returns current queue size
+				template< class size_function >
+				overflow_action overflow( boost::mutex::scoped_lock& lock, const size_function& size, const volatile bool& stopping )
+				{
+					switch ( settings_.policy )
+					{
+					case overflow_policy::block:
+					case overflow_policy::block_for:
+						{
+							const bool timed = settings_.policy == overflow_policy::block_for;
+							const boost::system_time deadline = deadline_after( settings_.block_timeout );
+							while ( full( size() ) && !stopping )
+							{
+								++waiting_for_pop_;
+								bool notified = true;
+								if ( timed )
+									notified = free_space_.timed_wait( lock, deadline );
+								else
+									free_space_.wait( lock );
+								--waiting_for_pop_;
+								if ( !notified && full( size() ) && !stopping )
+								{
+									++dropped_;
+									return overflow_reject;
+								}
+							}
+							return stopping ? overflow_reject : overflow_push;
+						}
+					case overflow_policy::fail:
+						++dropped_;
+						return overflow_reject;
+					case overflow_policy::drop_newest:
+						++dropped_;
+						return overflow_drop_newest;
+					case overflow_policy::drop_oldest:
+						++dropped_;
+						return overflow_drop_oldest;
+					case overflow_policy::sample:
+						++dropped_;
+						return ( ++overflows_ % settings_.sample_rate == 0 ) ? overflow_drop_oldest : overflow_drop_newest;
+					}
+					return overflow_push;
+				}
+			};
+		}
+
 		template< 
 			class T, 
 			template< typename, typename > class container = std::list, 
@@ -37,21 +210,55 @@ namespace system_utilities
 			typedef typename queue::size_type size_type;
 			typedef typename queue::reference reference;
 			typedef typename queue::const_reference const_reference;
+			typedef typename details::queue_capacity< value_type >::drop_handler drop_handler;
 
 		private:
 			queue queue_;
 			mutable boost::mutex queue_protector_;
 			boost::condition push_;
 			boost::condition wait_;
+			size_t waiting_for_push_;
+			// copy of queue size for spinning consumers, changed under queue_protector_ lock
+			std::atomic< size_t > published_size_;
+			std::atomic< size_t > spin_count_;
+
+			// capacity limit, changed under queue_protector_ lock
+			details::queue_capacity< value_type > capacity_;
 
 			volatile bool stopping_;
 
 		public:
-			explicit ts_queue()
+			explicit ts_queue( const size_t spin_count = 0 )
 				: queue_( )
+				, waiting_for_push_( 0 )
+				, published_size_( 0 )
+				, spin_count_( spin_count )
 				, stopping_( false )
 			{
 			}
+			// set_spin_count method: changes amount of busy-poll iterations before consumer sleeps on condition
+			// this method is thread safe
+			void set_spin_count( const size_t spin_count )
+			{
+				spin_count_.store( spin_count, std::memory_order_relaxed );
+			}
+			// set_capacity method: limits queue size, handler gets messages dropped by drop_newest, drop_oldest and sample policies
+			// empty handler - dropped messages are deleted
+			// should be called before producers start, producers that wait for free space are woken up
+			void set_capacity( const capacity_settings& settings, const drop_handler& handler = drop_handler() )
+			{
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				capacity_.set( settings, handler );
+			}
+			size_t capacity() const
+			{
+				return capacity_.capacity();
+			}
+			// dropped method: amount of messages that were not pushed (fail, block_for) or were dropped because of capacity limit
+			size_t dropped() const
+			{
+				return capacity_.dropped();
+			}
 			// restart method: stop queue from processing, clead queue (with deleting not processed elements by delete)
             void restart()
             {
@@ -65,6 +272,7 @@ namespace system_utilities
 				stopping_ = true;
 				boost::mutex::scoped_lock lock( queue_protector_ );
 				push_.notify_all();
+				capacity_.stop();
                 wait_.notify_all();
 			}
 			// stop_processing method: stop processing method stop queue, notify wait() and ts_pop() methods and flush not poped messages with delete.
@@ -78,7 +286,9 @@ namespace system_utilities
 					delete queue_.front();
 					queue_.pop_front();
 				}
+				publish_size_();
 				push_.notify_all();
+				capacity_.stop();
                 wait_.notify_all();
 			}
 			// non virtual destructor
@@ -100,22 +310,119 @@ namespace system_utilities
                 while (!queue_.empty() && !stopping_)
                     wait_.wait( lock );
             }
+			// wait_for_empty method: wait() with timeout
+			// returns true - if all messages were poped out queue or queue was stopped
+			// returns false - if timeout was reached
+			// this method is thread safe
+			template< class rep, class period >
+			bool wait_for_empty( const std::chrono::duration< rep, period >& timeout )
+			{
+				if (stopping_)
+					return true;
+				const boost::system_time deadline = details::deadline_after( timeout );
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				while (!queue_.empty() && !stopping_)
+					if (!wait_.timed_wait( lock, deadline ))
+						return queue_.empty() || stopping_;
+				return true;
+			}
 			// push() method: push message into queue
 			// if stop(), stop_processing() method was called before - returns immediatly
-			// returns true - if message was added to queue
+			// returns true - if message was added to queue (or was dropped by overflow policy)
 			// returns false - if message was not added to queue, check this parameter it could be reason of memory leak
 			// this method is thread safe
 			bool push(value_type val)
 			{
 				if (stopping_)
 					return false;
-				boost::mutex::scoped_lock lock( queue_protector_ );
+				value_type dropped = NULL;
+				drop_handler handler;
+				{
+					boost::mutex::scoped_lock lock( queue_protector_ );
+					if (stopping_)
+						return false;
+					if ( capacity_.full( queue_.size() ) )
+					{
+						switch ( capacity_.overflow( lock, [ this ]() { return queue_.size(); }, stopping_ ) )
+						{
+						case details::overflow_reject:
+							return false;
+						case details::overflow_drop_newest:
+							dropped = val;
+							break;
+						case details::overflow_drop_oldest:
+							dropped = queue_.front();
+							queue_.pop_front();
+							break;
+						case details::overflow_push:
+							break;
+						}
+						// handler is copied under lock, set_capacity() could change it
+						if ( dropped )
+							handler = capacity_.handler();
+					}
+					if ( dropped != val )
+					{
+						queue_.push_back( val );
+						publish_size_();
+						push_.notify_one();
+					}
+				}
+				if ( dropped )
+				{
+					if ( handler )
+						handler( dropped );
+					else
+						delete dropped;
+				}
+				return true;
+			}
+			// try_push() method: push() that never waits and never drops messages
+			// returns false - if queue is full (capacity limit, any overflow policy) or stop(), stop_processing() method was called before
+			// this method is thread safe
+			bool try_push(value_type val)
+			{
 				if (stopping_)
 					return false;
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				if (stopping_ || capacity_.full( queue_.size() ))
+					return false;
 				queue_.push_back( val );
+				publish_size_();
 				push_.notify_one();
 				return true;
 			}
+			// push_range() method: push messages [first, last) into queue under one lock
+			// consumers are notified only if some of them wait for push
+			// if stop(), stop_processing() method was called before - returns 0
+			// returns amount of messages that were added to queue, check this parameter it could be reason of memory leak
+			// this method is thread safe
+			// with capacity limit messages are pushed one by one, till the first one that was not pushed
+			template< class input_iterator >
+			size_t push_range( input_iterator first, input_iterator last )
+			{
+				if (stopping_)
+					return 0;
+				if ( capacity_.capacity() )
+				{
+					size_t pushed = 0;
+					for ( ; first != last && push( *first ) ; ++first )
+						++pushed;
+					return pushed;
+				}
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				if (stopping_)
+					return 0;
+				size_t pushed = 0;
+				for ( ; first != last ; ++first, ++pushed )
+					queue_.push_back( *first );
+				publish_size_();
+				if ( waiting_for_push_ != 0 && pushed == 1 )
+					push_.notify_one();
+				else if ( waiting_for_push_ != 0 && pushed > 1 )
+					push_.notify_all();
+				return pushed;
+			}
 			// pop() message returns pointer to message that was in queue
 			// returns pointer to message or NULL
 			// if queue is empty - returns NULL
@@ -127,10 +434,14 @@ namespace system_utilities
 					return NULL;
 				value_type result = queue_.front();
 				queue_.pop_front();
-                if (queue_.empty())
+				publish_size_();
+                if (queue_.empty() || capacity_.waiting())
 				{
 					boost::mutex::scoped_lock lock( queue_protector_ );
-                    wait_.notify_all();
+					if (queue_.empty())
+						wait_.notify_all();
+					// one place was freed, so one producer is woken up
+					capacity_.freed( 1 );
 				}
 				return result;
 			}
@@ -150,8 +461,10 @@ namespace system_utilities
 					return NULL;
 				value_type result = queue_.front();
 				queue_.pop_front();
+				publish_size_();
                 if (queue_.empty())
                     wait_.notify_all();
+				capacity_.freed( 1 );
 				return result;
 			}
 			// wait_pop() message returns pointer to message that was in queue
@@ -162,22 +475,43 @@ namespace system_utilities
 			// this method is not thread safe!
 			value_type wait_pop()
 			{
-				if (stopping_)
-					return NULL;
-				boost::mutex::scoped_lock lock( queue_protector_ );
-				if (stopping_)
-					return NULL;
-				while (queue_.empty())
-				{
-					push_.wait( lock );
-					if (stopping_)
-						return NULL;
-				}
-				value_type result = queue_.front();
-				queue_.pop_front();
-                if (queue_.empty())
-                    wait_.notify_all();
-				return result;
+				return wait_pop_( NULL );
+			}
+			// wait_pop_for() method: wait_pop() with timeout
+			// returns NULL if queue is stopping or there were no messages during timeout
+			// this method is thread safe
+			template< class rep, class period >
+			value_type wait_pop_for( const std::chrono::duration< rep, period >& timeout )
+			{
+				const boost::system_time deadline = details::deadline_after( timeout );
+				return wait_pop_( &deadline );
+			}
+			// wait_pop_until() method: wait_pop() with deadline
+			// returns NULL if queue is stopping or there were no messages till deadline
+			// this method is thread safe
+			template< class clock, class duration >
+			value_type wait_pop_until( const std::chrono::time_point< clock, duration >& time_point )
+			{
+				const boost::system_time deadline = details::deadline_at( time_point );
+				return wait_pop_( &deadline );
+			}
+			// wait_pop_bulk() method moves up to max_count messages to out iterator under one lock
+			// returns amount of poped messages
+			// if queue is empty, wait until stop(), stop_processing(), push() will be called.
+			// if queue is stopping - return 0
+			// this method is thread safe
+			template< class output_iterator >
+			size_t wait_pop_bulk( output_iterator out, const size_t max_count )
+			{
+				return wait_pop_bulk_( out, max_count, NULL );
+			}
+			// wait_pop_bulk() method with timeout: returns 0 if there were no messages during timeout
+			// this method is thread safe
+			template< class output_iterator, class rep, class period >
+			size_t wait_pop_bulk( output_iterator out, const size_t max_count, const std::chrono::duration< rep, period >& timeout )
+			{
+				const boost::system_time deadline = details::deadline_after( timeout );
+				return wait_pop_bulk_( out, max_count, &deadline );
 			}
 			// size() method: returns 0 if queue is going to stop
 			size_t size() const 
@@ -203,6 +537,96 @@ namespace system_utilities
 				boost::mutex::scoped_lock lock( queue_protector_ );
 				return queue_.empty();
 			}
+		private:
+			value_type wait_pop_( const boost::system_time* deadline )
+			{
+				if (stopping_)
+					return NULL;
+				spin_for_push_();
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				if (!wait_for_push_( lock, deadline ))
+					return NULL;
+				value_type result = queue_.front();
+				queue_.pop_front();
+				publish_size_();
+				after_pop_( 1 );
+				return result;
+			}
+			template< class output_iterator >
+			size_t wait_pop_bulk_( output_iterator out, const size_t max_count, const boost::system_time* deadline )
+			{
+				if (stopping_)
+					return 0;
+				spin_for_push_();
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				if (!wait_for_push_( lock, deadline ))
+					return 0;
+				return pop_bulk_( out, max_count );
+			}
+			// spin_for_push_() method: busy-polls published size, returns before spin_count iterations if message was pushed or queue was stopped
+			void spin_for_push_() const
+			{
+				const size_t spin_count = spin_count_.load( std::memory_order_relaxed );
+				for ( size_t i = 0 ; i < spin_count ; ++i )
+				{
+					if ( published_size_.load( std::memory_order_relaxed ) != 0 || stopping_ )
+						return;
+					details::spin_pause();
+				}
+			}
+			// should be called under queue_protector_ lock
+			// returns false if queue is stopping or deadline was reached while queue is empty
+			bool wait_for_push_( boost::mutex::scoped_lock& lock, const boost::system_time* deadline )
+			{
+				if (stopping_)
+					return false;
+				while (queue_.empty())
+				{
+					++waiting_for_push_;
+					bool notified = true;
+					if (deadline)
+						notified = push_.timed_wait( lock, *deadline );
+					else
+						push_.wait( lock );
+					--waiting_for_push_;
+					if (stopping_)
+						return false;
+					if (!notified && queue_.empty())
+						return false;
+				}
+				return true;
+			}
+			// should be called under queue_protector_ lock
+			void publish_size_()
+			{
+				published_size_.store( queue_.size(), std::memory_order_relaxed );
+			}
+			// should be called under queue_protector_ lock
+			template< class output_iterator >
+			size_t pop_bulk_( output_iterator out, const size_t max_count )
+			{
+				size_t poped = 0;
+				while ( poped < max_count && !queue_.empty() )
+				{
+					*out++ = queue_.front();
+					queue_.pop_front();
+					++poped;
+				}
+				publish_size_();
+				// consumer that leaves messages behind passes notification to next waiting one
+				if ( !queue_.empty() && waiting_for_push_ != 0 )
+					push_.notify_one();
+				after_pop_( poped );
+				return poped;
+			}
+			// should be called under queue_protector_ lock
+			// producers that wait for free place are woken up one per poped message
+			void after_pop_( const size_t poped )
+			{
+				if (queue_.empty())
+					wait_.notify_all();
+				capacity_.freed( poped );
+			}
 		};
 	}
 }
@@ -0,0 +1,275 @@
+#ifndef _SYSTEM_UTILITIES_COMMON_TS_VALUE_QUEUE_H_
+#define _SYSTEM_UTILITIES_COMMON_TS_VALUE_QUEUE_H_
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+
+#include "deadline.h"
+
+namespace system_utilities
+{
+	// ts_value_queue: thread safe queue that stores messages by value
+	// messages live inline in contiguous ring buffer (capacity grows twice when ring is full), so push/pop does not allocate memory per message
+	// supports move-only types and in place construction by emplace()
+	// pop methods move message to out parameter and return false if there is no message
+	// not processed messages are destroyed in place on stop_processing(), restart() and destructor
+	// non virtual destructor, please inherit only if you know what are you doing
+
+	namespace common
+	{
+		template< class T, class allocator = std::allocator< T > >
+		class ts_value_queue
+		{
+			explicit ts_value_queue( const ts_value_queue& );
+			ts_value_queue& operator=( const ts_value_queue& );
+		public:
+			typedef T value_type;
+			typedef size_t size_type;
+			typedef allocator allocator_type;
+
+		private:
+			allocator allocator_;
+			T* elements_;
+			size_t capacity_;
+			size_t head_;
+			size_t size_;
+
+			mutable boost::mutex queue_protector_;
+			boost::condition push_;
+			boost::condition wait_;
+
+			volatile bool stopping_;
+
+		public:
+			// initial_capacity is rounded up to power of two
+			explicit ts_value_queue( const size_t initial_capacity = 64, const allocator& allocator_object = allocator() )
+				: allocator_( allocator_object )
+				, elements_( NULL )
+				, capacity_( 1 )
+				, head_( 0 )
+				, size_( 0 )
+				, stopping_( false )
+			{
+				while ( capacity_ < initial_capacity )
+					capacity_ <<= 1;
+				elements_ = allocator_.allocate( capacity_ );
+			}
+			// restart method: stop queue from processing, clear queue (with destroying not processed elements)
+			void restart()
+			{
+				stop_processing();
+				stopping_ = false;
+			}
+			// stop method: stop queue, notify wait() and wait_pop() methods that wait for messages or result of processing
+			// this method is thread safe
+			void stop()
+			{
+				stopping_ = true;
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				push_.notify_all();
+				wait_.notify_all();
+			}
+			// stop_processing method: stop queue, notify wait() and wait_pop() methods and destroy not poped messages in place
+			// this method is thread safe
+			void stop_processing()
+			{
+				stopping_ = true;
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				clear_();
+				push_.notify_all();
+				wait_.notify_all();
+			}
+			// non virtual destructor
+			~ts_value_queue()
+			{
+				stop_processing();
+				allocator_.deallocate( elements_, capacity_ );
+			}
+			// wait method: wait while user call stop(), stop_processing(), ~destructor() methods OR all messages will be poped out queue
+			// if stop(), stop_processing() method was called before - returns immediatly
+			// this method is thread safe
+			void wait()
+			{
+				if (stopping_)
+					return;
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				while (size_ != 0 && !stopping_)
+					wait_.wait( lock );
+			}
+			// push() method: copy or move message into queue
+			// returns false - if stop(), stop_processing() method was called before
+			// this method is thread safe
+			bool push( const T& value )
+			{
+				return emplace( value );
+			}
+			bool push( T&& value )
+			{
+				return emplace( std::move( value ) );
+			}
+			// emplace() method: construct message in place from arguments
+			// returns false - if stop(), stop_processing() method was called before
+			// this method is thread safe
+			template< class... Args >
+			bool emplace( Args&&... args )
+			{
+				if (stopping_)
+					return false;
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				if (stopping_)
+					return false;
+				if (size_ == capacity_)
+					grow_();
+				::new( static_cast< void* >( elements_ + index_( size_ ) ) ) T( std::forward< Args >( args )... );
+				++size_;
+				push_.notify_one();
+				return true;
+			}
+			// ts_pop() method: move first message to result
+			// returns false if queue is empty or stopping
+			// it does not wait for push
+			// this method is thread safe
+			bool ts_pop( T& result )
+			{
+				if (stopping_)
+					return false;
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				if (stopping_ || size_ == 0)
+					return false;
+				pop_front_( result );
+				return true;
+			}
+			// wait_pop() method: move first message to result
+			// if queue is empty, wait until stop(), stop_processing(), push() will be called.
+			// returns false if queue is stopping
+			// this method is thread safe
+			bool wait_pop( T& result )
+			{
+				return wait_pop_( result, NULL );
+			}
+			// wait_pop_for() method: wait_pop() with timeout
+			// returns false if queue is stopping or there were no messages during timeout
+			// this method is thread safe
+			template< class rep, class period >
+			bool wait_pop_for( T& result, const std::chrono::duration< rep, period >& timeout )
+			{
+				const boost::system_time deadline = details::deadline_after( timeout );
+				return wait_pop_( result, &deadline );
+			}
+			// size() method: returns 0 if queue is going to stop
+			size_t size() const
+			{
+				if (stopping_)
+					return 0;
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				return size_;
+			}
+			// ts_size() method: returns queue size
+			// thread safe method
+			size_t ts_size() const
+			{
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				return size_;
+			}
+			// empty() method: return true if queue is going to stop
+			// returns false is queue.size() > 0
+			bool empty() const
+			{
+				if (stopping_)
+					return true;
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				return size_ == 0;
+			}
+			// capacity() method: returns current ring buffer capacity
+			// thread safe method
+			size_t capacity() const
+			{
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				return capacity_;
+			}
+
+		private:
+			bool wait_pop_( T& result, const boost::system_time* deadline )
+			{
+				if (stopping_)
+					return false;
+				boost::mutex::scoped_lock lock( queue_protector_ );
+				if (stopping_)
+					return false;
+				while (size_ == 0)
+				{
+					bool notified = true;
+					if (deadline)
+						notified = push_.timed_wait( lock, *deadline );
+					else
+						push_.wait( lock );
+					if (stopping_)
+						return false;
+					if (!notified && size_ == 0)
+						return false;
+				}
+				pop_front_( result );
+				return true;
+			}
+			// should be called under queue_protector_ lock
+			size_t index_( const size_t position ) const
+			{
+				return ( head_ + position ) & ( capacity_ - 1 );
+			}
+			// should be called under queue_protector_ lock
+			void pop_front_( T& result )
+			{
+				T* const front = elements_ + head_;
+				result = std::move( *front );
+				front->~T();
+				head_ = index_( 1 );
+				--size_;
+				if (size_ == 0)
+					wait_.notify_all();
+			}
+			// should be called under queue_protector_ lock
+			void clear_()
+			{
+				for ( ; size_ != 0 ; --size_ )
+				{
+					elements_[ head_ ].~T();
+					head_ = index_( 1 );
+				}
+				head_ = 0;
+			}
+			// should be called under queue_protector_ lock
+			// moves messages to new ring twice bigger, messages are placed from the beginning of new ring
+			void grow_()
+			{
+				const size_t new_capacity = capacity_ << 1;
+				T* const new_elements = allocator_.allocate( new_capacity );
+				size_t moved = 0;
+				try
+				{
+					for ( ; moved < size_ ; ++moved )
+						::new( static_cast< void* >( new_elements + moved ) ) T( std::move_if_noexcept( elements_[ index_( moved ) ] ) );
+				}
+				catch( ... )
+				{
+					for ( size_t i = 0 ; i < moved ; ++i )
+						new_elements[ i ].~T();
+					allocator_.deallocate( new_elements, new_capacity );
+					throw;
+				}
+				for ( size_t i = 0 ; i < size_ ; ++i )
+					elements_[ index_( i ) ].~T();
+				allocator_.deallocate( elements_, capacity_ );
+				elements_ = new_elements;
+				capacity_ = new_capacity;
+				head_ = 0;
+			}
+		};
+	}
+}
+
+#endif // _SYSTEM_UTILITIES_COMMON_TS_VALUE_QUEUE_H_
@@ -0,0 +1,102 @@
+#ifndef _SYSTEM_UTILITIES_COMMON_WORK_STEALING_DEQUE_H_
+#define _SYSTEM_UTILITIES_COMMON_WORK_STEALING_DEQUE_H_
+
+#include <atomic>
+#include <cstddef>
+
+#include "cache_line.h"
+
+namespace system_utilities
+{
+	namespace common
+	{
+		namespace details
+		{
+			// work_stealing_deque: bounded Chase-Lev deque (C11 memory model version by N.M.Le, A.Pop, A.Cohen, F.Zappa Nardelli)
+			// owner thread pushes and takes from bottom (LIFO), other threads steal from top (FIFO)
+			// push() returns false if deque is full, caller should put element to other place
+			template< class T, size_t capacity >
+			class work_stealing_deque
+			{
+				typedef T* element_ptr;
+				typedef long long index_type;
+
+				static_assert( capacity >= 2 && ( capacity & ( capacity - 1 ) ) == 0, "work_stealing_deque capacity should be a power of two" );
+				static const index_type mask_ = static_cast< index_type >( capacity - 1 );
+
+				explicit work_stealing_deque( const work_stealing_deque& );
+				work_stealing_deque& operator=( const work_stealing_deque& );
+
+				padded_atomic< index_type > top_;
+				padded_atomic< index_type > bottom_;
+				std::atomic< element_ptr > elements_[ capacity ];
+
+			public:
+				explicit work_stealing_deque()
+				{
+					top_.value.store( 0, std::memory_order_relaxed );
+					bottom_.value.store( 0, std::memory_order_relaxed );
+					for ( size_t i = 0 ; i < capacity ; ++i )
+						elements_[ i ].store( NULL, std::memory_order_relaxed );
+				}
+				// owner thread only
+				bool push( element_ptr element )
+				{
+					const index_type bottom = bottom_.value.load( std::memory_order_relaxed );
+					const index_type top = top_.value.load( std::memory_order_acquire );
+					if ( bottom - top >= static_cast< index_type >( capacity ) )
+						return false;
+					elements_[ bottom & mask_ ].store( element, std::memory_order_relaxed );
+					std::atomic_thread_fence( std::memory_order_release );
+					bottom_.value.store( bottom + 1, std::memory_order_relaxed );
+					return true;
+				}
+				// owner thread only, returns NULL if deque is empty
+				element_ptr take()
+				{
+					const index_type bottom = bottom_.value.load( std::memory_order_relaxed ) - 1;
+					bottom_.value.store( bottom, std::memory_order_relaxed );
+					std::atomic_thread_fence( std::memory_order_seq_cst );
+					index_type top = top_.value.load( std::memory_order_relaxed );
+					element_ptr result = NULL;
+					if ( top <= bottom )
+					{
+						result = elements_[ bottom & mask_ ].load( std::memory_order_relaxed );
+						if ( top == bottom )
+						{
+							// last element, race with stealers
+							if ( !top_.value.compare_exchange_strong( top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+								result = NULL;
+							bottom_.value.store( bottom + 1, std::memory_order_relaxed );
+						}
+					}
+					else
+						bottom_.value.store( bottom + 1, std::memory_order_relaxed );
+					return result;
+				}
+				// any thread, returns NULL if deque is empty or steal lost race with other thief or owner
+				element_ptr steal()
+				{
+					index_type top = top_.value.load( std::memory_order_acquire );
+					std::atomic_thread_fence( std::memory_order_seq_cst );
+					const index_type bottom = bottom_.value.load( std::memory_order_acquire );
+					if ( top >= bottom )
+						return NULL;
+					element_ptr result = elements_[ top & mask_ ].load( std::memory_order_relaxed );
+					if ( !top_.value.compare_exchange_strong( top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed ) )
+						return NULL;
+					return result;
+				}
+				// approximate size, any thread
+				size_t size() const
+				{
+					const index_type bottom = bottom_.value.load( std::memory_order_acquire );
+					const index_type top = top_.value.load( std::memory_order_acquire );
+					return bottom > top ? static_cast< size_t >( bottom - top ) : 0;
+				}
+			};
+		}
+	}
+}
+
+#endif // _SYSTEM_UTILITIES_COMMON_WORK_STEALING_DEQUE_H_
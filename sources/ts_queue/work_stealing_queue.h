@@ -0,0 +1,342 @@
+#ifndef _SYSTEM_UTILITIES_COMMON_WORK_STEALING_QUEUE_H_
+#define _SYSTEM_UTILITIES_COMMON_WORK_STEALING_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <deque>
+
+#include <boost/thread.hpp>
+#include <boost/thread/condition.hpp>
+
+#include "cache_line.h"
+#include "work_stealing_deque.h"
+
+namespace system_utilities
+{
+	// work_stealing_queue: task queue for work-stealing execution mode of task_processor (use it as task_queue parameter)
+	// every thread that calls wait_pop() becomes a worker and gets own Chase-Lev deque (up to max_workers workers)
+	// push() from worker thread (task that adds tasks) goes to bottom of worker deque, push() from other threads goes to global injection queue
+	// worker takes messages from own deque (LIFO), then from injection queue (moving up to injection_batch messages to own deque), then steals from other workers
+	// idle workers are parked on condition until next push is published, so there is no busy waiting when queue is empty
+	// or when all messages are taken by other workers and not counted off yet
+	// messages order is not FIFO, one worker thread should serve only one work_stealing_queue
+	// has the same interface as ts_queue, so wait(), stop() and process_on_stop semantic of task_processor are kept
+	// non virtual destructor, please inherit only if you know what are you doing
+
+	namespace common
+	{
+		namespace details
+		{
+			inline size_t next_work_stealing_queue_id()
+			{
+				static std::atomic< size_t > id( 0 );
+				return ++id;
+			}
+		}
+
+		template< class T, size_t max_workers = 64, size_t deque_capacity = 4096 >
+		class work_stealing_queue
+		{
+			typedef T* element_ptr;
+			typedef details::work_stealing_deque< T, deque_capacity > deque;
+
+			struct worker_slot
+			{
+				size_t queue_id;
+				size_t index;
+				deque* own_deque;
+			};
+
+			static const size_t injection_batch = 32;
+			static const size_t spin_rounds = 16;
+
+			explicit work_stealing_queue( const work_stealing_queue& );
+			work_stealing_queue& operator=( const work_stealing_queue& );
+		public:
+			typedef element_ptr value_type;
+			typedef size_t size_type;
+
+		private:
+			const size_t id_;
+			std::atomic< deque* > deques_[ max_workers ];
+			std::atomic< size_t > workers_;
+			// amount of pushed and not poped messages, it is incremented before message is published
+			details::padded_atomic< size_t > size_;
+			// amount of published messages, it is incremented after message is put into deque or injection queue
+			details::padded_atomic< size_t > published_;
+
+			boost::mutex injection_protector_;
+			std::deque< element_ptr > injection_;
+
+			std::atomic< bool > stopping_;
+
+			mutable boost::mutex park_protector_;
+			boost::condition push_;
+			boost::condition wait_;
+			std::atomic< size_t > waiting_for_push_;
+			std::atomic< size_t > waiting_for_empty_;
+
+		public:
+			explicit work_stealing_queue()
+				: id_( details::next_work_stealing_queue_id() )
+				, workers_( 0 )
+				, stopping_( false )
+				, waiting_for_push_( 0 )
+				, waiting_for_empty_( 0 )
+			{
+				for ( size_t i = 0 ; i < max_workers ; ++i )
+					deques_[ i ].store( NULL, std::memory_order_relaxed );
+				size_.value.store( 0 );
+				published_.value.store( 0 );
+			}
+			// restart method: stop queue from processing, clear queue (with deleting not processed elements by delete)
+			void restart()
+			{
+				stop_processing();
+				stopping_ = false;
+			}
+			// stop method: stop queue, notify wait() and wait_pop() methods that wait for messages or result of processing
+			// this method is thread safe
+			void stop()
+			{
+				stopping_ = true;
+				notify_all_();
+			}
+			// stop_processing method: stop queue, notify waiting methods and flush not poped messages with delete.
+			// this method is thread safe
+			void stop_processing()
+			{
+				stopping_ = true;
+				{
+					boost::mutex::scoped_lock lock( injection_protector_ );
+					while ( !injection_.empty() )
+					{
+						delete injection_.front();
+						injection_.pop_front();
+						size_.value.fetch_sub( 1 );
+					}
+				}
+				const size_t workers = workers_amount_();
+				for ( size_t i = 0 ; i < workers ; ++i )
+				{
+					deque* const d = deques_[ i ].load( std::memory_order_acquire );
+					while ( d && d->size() != 0 )
+						if ( element_ptr element = d->steal() )
+						{
+							delete element;
+							size_.value.fetch_sub( 1 );
+						}
+				}
+				notify_all_();
+			}
+			// non virtual destructor
+			~work_stealing_queue()
+			{
+				stop_processing();
+				for ( size_t i = 0 ; i < max_workers ; ++i )
+					delete deques_[ i ].load();
+			}
+			// wait method: wait while user call stop(), stop_processing(), ~destructor() methods OR all messages will be poped out queue
+			// if stop(), stop_processing() method was called before - returns immediatly
+			// this method is thread safe
+			void wait()
+			{
+				if ( stopping_ )
+					return;
+				boost::mutex::scoped_lock lock( park_protector_ );
+				++waiting_for_empty_;
+				while ( size_.value.load() != 0 && !stopping_ )
+					wait_.wait( lock );
+				--waiting_for_empty_;
+			}
+			// push() method: push message into own deque (worker thread) or into injection queue (other threads)
+			// if stop(), stop_processing() method was called before - returns immediatly
+			// returns true - if message was added to queue
+			// returns false - if message was not added to queue, check this parameter it could be reason of memory leak
+			// this method is thread safe
+			bool push( value_type val )
+			{
+				if ( stopping_ )
+					return false;
+				size_.value.fetch_add( 1 );
+				deque* const own_deque = worker_deque_();
+				if ( !own_deque || !own_deque->push( val ) )
+				{
+					boost::mutex::scoped_lock lock( injection_protector_ );
+					injection_.push_back( val );
+				}
+				// waiting_for_push_ is incremented under park_protector_ before published_ check, both are seq_cst, so wake up could not be lost
+				published_.value.fetch_add( 1 );
+				if ( waiting_for_push_.load() != 0 )
+				{
+					boost::mutex::scoped_lock lock( park_protector_ );
+					push_.notify_one();
+				}
+				return true;
+			}
+			// pop() method returns pointer to message or NULL if queue is empty
+			// it does not wait for push
+			// this method is thread safe
+			value_type pop()
+			{
+				element_ptr result = try_pop_( current_worker_() );
+				if ( result )
+					after_pop_();
+				return result;
+			}
+			// ts_pop() method: pop() that returns NULL if queue is stopping
+			// this method is thread safe
+			value_type ts_pop()
+			{
+				if ( stopping_ )
+					return NULL;
+				return pop();
+			}
+			// wait_pop() method returns pointer to message, calling thread is registered as worker
+			// if there is no message to take, wait until stop(), stop_processing(), push() will be called.
+			// if queue is stopping - return NULL
+			// this method is thread safe
+			value_type wait_pop()
+			{
+				const worker_slot& worker = register_worker_();
+				for (;;)
+				{
+					// message that is published after this point wakes worker up, messages published before are seen by try_pop_
+					const size_t published = published_.value.load();
+					for ( size_t i = 0 ; i < spin_rounds ; ++i )
+					{
+						if ( stopping_ )
+							return NULL;
+						if ( element_ptr result = try_pop_( worker ) )
+						{
+							after_pop_();
+							return result;
+						}
+						if ( size_.value.load() == 0 )
+							break;
+						boost::this_thread::yield();
+					}
+					wait_for_push_( published );
+				}
+			}
+			// size() method: returns 0 if queue is going to stop
+			size_t size() const
+			{
+				if ( stopping_ )
+					return 0;
+				return size_.value.load();
+			}
+			// ts_size() method: returns queue size
+			// thread safe method
+			size_t ts_size() const
+			{
+				return size_.value.load();
+			}
+			// empty() method: return true if queue is going to stop
+			// returns false is queue.size() > 0
+			bool empty() const
+			{
+				if ( stopping_ )
+					return true;
+				return size_.value.load() == 0;
+			}
+
+		private:
+			static worker_slot& current_worker_()
+			{
+				static thread_local worker_slot slot = { 0, 0, NULL };
+				return slot;
+			}
+			// returns calling thread deque if thread is worker of this queue, NULL otherwise
+			deque* worker_deque_() const
+			{
+				const worker_slot& slot = current_worker_();
+				return slot.queue_id == id_ ? slot.own_deque : NULL;
+			}
+			const worker_slot& register_worker_()
+			{
+				worker_slot& slot = current_worker_();
+				if ( slot.queue_id == id_ )
+					return slot;
+				slot.queue_id = id_;
+				slot.index = workers_.fetch_add( 1 );
+				slot.own_deque = NULL;
+				if ( slot.index < max_workers )
+				{
+					slot.own_deque = new deque();
+					deques_[ slot.index ].store( slot.own_deque, std::memory_order_release );
+				}
+				return slot;
+			}
+			size_t workers_amount_() const
+			{
+				const size_t workers = workers_.load( std::memory_order_acquire );
+				return workers < max_workers ? workers : max_workers;
+			}
+			element_ptr try_pop_( const worker_slot& worker )
+			{
+				deque* const own_deque = worker.queue_id == id_ ? worker.own_deque : NULL;
+				if ( own_deque )
+					if ( element_ptr result = own_deque->take() )
+						return result;
+				if ( element_ptr result = take_injected_( own_deque ) )
+					return result;
+				return steal_( worker.queue_id == id_ ? worker.index : 0 );
+			}
+			element_ptr take_injected_( deque* const own_deque )
+			{
+				boost::mutex::scoped_lock lock( injection_protector_ );
+				if ( injection_.empty() )
+					return NULL;
+				element_ptr result = injection_.front();
+				injection_.pop_front();
+				for ( size_t i = 1 ; own_deque && i < injection_batch && !injection_.empty() ; ++i )
+				{
+					if ( !own_deque->push( injection_.front() ) )
+						break;
+					injection_.pop_front();
+				}
+				return result;
+			}
+			element_ptr steal_( const size_t own_index )
+			{
+				const size_t workers = workers_amount_();
+				for ( size_t i = 1 ; i <= workers ; ++i )
+				{
+					deque* const victim = deques_[ ( own_index + i ) % workers ].load( std::memory_order_acquire );
+					if ( victim )
+						if ( element_ptr result = victim->steal() )
+							return result;
+				}
+				return NULL;
+			}
+			void after_pop_()
+			{
+				if ( size_.value.fetch_sub( 1 ) == 1 && waiting_for_empty_.load() != 0 )
+				{
+					boost::mutex::scoped_lock lock( park_protector_ );
+					wait_.notify_all();
+				}
+			}
+			// parks until message is published after published snapshot, size_ is not checked:
+			// it counts messages that are being pushed or were taken by other workers, waiting for it to drop is busy waiting
+			// messages that stay in other worker deque are taken by its owner, so parking could not lose them
+			void wait_for_push_( const size_t published )
+			{
+				boost::mutex::scoped_lock lock( park_protector_ );
+				++waiting_for_push_;
+				while ( published_.value.load() == published && !stopping_ )
+					push_.wait( lock );
+				--waiting_for_push_;
+			}
+			void notify_all_()
+			{
+				boost::mutex::scoped_lock lock( park_protector_ );
+				push_.notify_all();
+				wait_.notify_all();
+			}
+		};
+	}
+}
+
+#endif // _SYSTEM_UTILITIES_COMMON_WORK_STEALING_QUEUE_H_
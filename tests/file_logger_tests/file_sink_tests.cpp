@@ -0,0 +1,231 @@
+#include "test_registrator.h"
+
+#include <file_logger.h>
+#include <file_sink.h>
+#include <time_tracker.h>
+
+#include <boost/thread.hpp>
+
+using namespace system_utilities::common;
+
+namespace system_utilities
+{
+	namespace tests_
+	{
+		namespace common
+		{
+			namespace details
+			{
+				std::string file_sink_read_file( const std::string& file_path )
+				{
+					std::ifstream file( file_path.c_str(), std::ios::in | std::ios::binary );
+					std::stringstream result;
+					result << file.rdbuf();
+					return result.str();
+				}
+				// file_sink_write_syscalls: amount of write system calls of process (syscw of /proc/self/io), 0 if it is not available
+				size_t file_sink_write_syscalls()
+				{
+					std::ifstream io( "/proc/self/io" );
+					std::string name;
+					size_t value = 0;
+					while ( io >> name >> value )
+						if ( name == "syscw:" )
+							return value;
+					return 0;
+				}
+				template< class logger_type >
+				void file_sink_write_messages( logger_type& logger, const size_t messages_size )
+				{
+					for ( size_t i = 0 ; i < messages_size ; ++i )
+						if ( i % 1000 == 999 )
+							logger.error( "1234567890123456789012345678901" );
+						else
+							logger.note( "1234567890123456789012345678901" );
+				}
+				void file_sink_print_syscalls( const std::string& name, const size_t syscalls, const size_t messages_size, const size_t milliseconds )
+				{
+					std::cout << name << ": " << syscalls << " write syscalls for " << messages_size << " messages ("
+						<< static_cast< double >( syscalls ) / messages_size << " per message), " << milliseconds << " ms" << std::endl;
+				}
+			}
+			void file_sink_constructor_tests()
+			{
+				using namespace boost::filesystem;
+				{
+					file_sink sink( "file_sink_test_1.out" );
+					BOOST_CHECK_EQUAL( exists( "file_sink_test_1.out" ), true );
+					BOOST_CHECK_EQUAL( sink.write_calls(), 0u );
+					BOOST_CHECK_EQUAL( sink.pending(), 0u );
+				}
+				remove( "file_sink_test_1.out" );
+				BOOST_CHECK_THROW( file_sink( "not_existing_directory/file_sink_test.out" ), std::logic_error );
+			}
+			void file_sink_flush_policy_tests()
+			{
+				using namespace boost::filesystem;
+				{
+					file_sink sink( "file_sink_test_2.out", flush_settings( flush_policy::every_bytes, 16 ), std::ios_base::trunc );
+					std::ostream stream( &sink );
+					stream << "1234567890";
+					sink.message_written( system_utilities::common::details::message_level::note );
+					BOOST_CHECK_EQUAL( sink.write_calls(), 0u );
+					BOOST_CHECK_EQUAL( sink.pending(), 10u );
+					stream << "1234567890";
+					sink.message_written( system_utilities::common::details::message_level::note );
+					BOOST_CHECK_EQUAL( sink.write_calls(), 1u );
+					BOOST_CHECK_EQUAL( sink.bytes_written(), 20u );
+					BOOST_CHECK_EQUAL( details::file_sink_read_file( "file_sink_test_2.out" ), "12345678901234567890" );
+				}
+				{
+					file_sink sink( "file_sink_test_2.out", flush_settings( flush_policy::on_error ), std::ios_base::trunc );
+					std::ostream stream( &sink );
+					stream << "note\n";
+					sink.message_written( system_utilities::common::details::message_level::note );
+					stream << "warn\n" << std::flush;
+					sink.message_written( system_utilities::common::details::message_level::warn );
+					BOOST_CHECK_EQUAL( sink.write_calls(), 0u );
+					stream << "error\n";
+					sink.message_written( system_utilities::common::details::message_level::error );
+					BOOST_CHECK_EQUAL( sink.write_calls(), 1u );
+					BOOST_CHECK_EQUAL( details::file_sink_read_file( "file_sink_test_2.out" ), "note\nwarn\nerror\n" );
+				}
+				{
+					file_sink sink( "file_sink_test_2.out", flush_settings( flush_policy::every_period, 0, 20 ), std::ios_base::trunc );
+					std::ostream stream( &sink );
+					stream << "first\n";
+					sink.message_written( system_utilities::common::details::message_level::note );
+					BOOST_CHECK_EQUAL( sink.write_calls(), 0u );
+					boost::this_thread::sleep( boost::posix_time::milliseconds( 30 ) );
+					stream << "second\n";
+					sink.message_written( system_utilities::common::details::message_level::note );
+					BOOST_CHECK_EQUAL( sink.write_calls(), 1u );
+					BOOST_CHECK_EQUAL( details::file_sink_read_file( "file_sink_test_2.out" ), "first\nsecond\n" );
+				}
+				{
+					file_sink sink( "file_sink_test_2.out", flush_settings( flush_policy::on_call ), std::ios_base::trunc );
+					std::ostream stream( &sink );
+					stream << "message\n" << std::flush;
+					sink.message_written( system_utilities::common::details::message_level::fatal );
+					BOOST_CHECK_EQUAL( sink.write_calls(), 0u );
+					sink.flush();
+					BOOST_CHECK_EQUAL( sink.write_calls(), 1u );
+					sink.flush();
+					BOOST_CHECK_EQUAL( sink.write_calls(), 1u );
+					stream << "last\n";
+				}
+				// destructor writes buffered messages, app mode appends
+				{
+					file_sink sink( "file_sink_test_2.out", flush_settings( flush_policy::on_call ) );
+					std::ostream stream( &sink );
+					stream << "appended\n";
+				}
+				BOOST_CHECK_EQUAL( details::file_sink_read_file( "file_sink_test_2.out" ), "message\nlast\nappended\n" );
+				remove( "file_sink_test_2.out" );
+			}
+			void file_sink_big_message_tests()
+			{
+				using namespace boost::filesystem;
+				const std::string big( 100, 'b' );
+				{
+					file_sink sink( "file_sink_test_3.out", flush_settings( flush_policy::on_call, 64, 0, 64 ), std::ios_base::trunc );
+					std::ostream stream( &sink );
+					stream << "small";
+					// message that is bigger than buffer is written with buffered messages by one call
+					stream << big;
+					BOOST_CHECK_EQUAL( sink.write_calls(), 1u );
+					BOOST_CHECK_EQUAL( sink.pending(), 0u );
+					for ( size_t i = 0 ; i < 70 ; ++i )
+						stream << 'c';
+					BOOST_CHECK_EQUAL( sink.write_calls(), 2u );
+					BOOST_CHECK_EQUAL( sink.pending(), 6u );
+				}
+				BOOST_CHECK_EQUAL( details::file_sink_read_file( "file_sink_test_3.out" ), "small" + big + std::string( 70, 'c' ) );
+				remove( "file_sink_test_3.out" );
+			}
+			void buffered_file_logger_tests()
+			{
+				using namespace boost::filesystem;
+				{
+					buffered_file_logger< logger< true, false, false > > l( "buffered_file_logger_test.out", flush_settings( flush_policy::on_error ), std::ios_base::trunc );
+					l.note( "note" );
+					l.warn() << "warn " << 1;
+					BOOST_CHECK_EQUAL( l.sink().write_calls(), 0u );
+					l.error( "error {}", 2 );
+					BOOST_CHECK_EQUAL( l.sink().write_calls(), 1u );
+					BOOST_CHECK_EQUAL( details::file_sink_read_file( "buffered_file_logger_test.out" ), "note\nwarn 1\nerror 2\n" );
+					l.debug( "debug" );
+					l.flush();
+					BOOST_CHECK_EQUAL( l.sink().write_calls(), 2u );
+					l.fatal( "fatal" );
+					BOOST_CHECK_EQUAL( l.sink().write_calls(), 3u );
+					l.note( "last" );
+				}
+				BOOST_CHECK_EQUAL( details::file_sink_read_file( "buffered_file_logger_test.out" ), "note\nwarn 1\nerror 2\ndebug\nfatal\nlast\n" );
+				{
+					// last message is written by logger thread, without next message
+					buffered_file_logger< logger< true, false, false > > l( "buffered_file_logger_test.out", flush_settings( flush_policy::every_period, 0, 10 ), std::ios_base::trunc );
+					l.note( "first" );
+					boost::this_thread::sleep( boost::posix_time::milliseconds( 20 ) );
+					l.note( "last" );
+					for ( size_t i = 0 ; i < 100 && l.sink().pending() ; ++i )
+						boost::this_thread::sleep( boost::posix_time::milliseconds( 5 ) );
+					BOOST_CHECK_EQUAL( details::file_sink_read_file( "buffered_file_logger_test.out" ), "first\nlast\n" );
+				}
+				remove( "buffered_file_logger_test.out" );
+			}
+			void file_sink_write_error_tests()
+			{
+#ifdef _LINUX
+				if ( !boost::filesystem::exists( "/dev/full" ) )
+					return;
+				file_sink sink( "/dev/full", flush_settings( flush_policy::on_call ) );
+				std::ostream stream( &sink );
+				stream << "message\n";
+				sink.flush();
+				BOOST_CHECK_EQUAL( sink.failed_writes(), 1u );
+				BOOST_CHECK_EQUAL( sink.bytes_lost(), 8u );
+				BOOST_CHECK_EQUAL( sink.bytes_written(), 0u );
+				BOOST_CHECK_EQUAL( sink.pending(), 0u );
+#endif
+			}
+			void file_sink_performance_tests()
+			{
+				static const size_t messages_size = 200000;
+				using namespace boost::filesystem;
+				{
+					remove( "file_sink_test_4.out" );
+					const size_t syscalls = details::file_sink_write_syscalls();
+					time_tracker< std::chrono::milliseconds > tt;
+					{
+						file_logger<> l( "file_sink_test_4.out" );
+						details::file_sink_write_messages( l, messages_size );
+					}
+					details::file_sink_print_syscalls( "file_logger (flush per message)", details::file_sink_write_syscalls() - syscalls, messages_size, tt.elapsed() );
+				}
+				const std::pair< const char*, flush_settings > policies[] =
+				{
+					std::make_pair( "every_bytes (64KB)", flush_settings( flush_policy::every_bytes, 64 * 1024 ) ),
+					std::make_pair( "every_period (10 ms)", flush_settings( flush_policy::every_period, 0, 10 ) ),
+					std::make_pair( "on_error (1 of 1000 messages)", flush_settings( flush_policy::on_error ) ),
+					std::make_pair( "on_call (1MB buffer)", flush_settings( flush_policy::on_call ) )
+				};
+				for ( size_t i = 0 ; i < sizeof( policies ) / sizeof( policies[ 0 ] ) ; ++i )
+				{
+					remove( "file_sink_test_4.out" );
+					const size_t syscalls = details::file_sink_write_syscalls();
+					time_tracker< std::chrono::milliseconds > tt;
+					size_t write_calls = 0;
+					{
+						buffered_file_logger<> l( "file_sink_test_4.out", policies[ i ].second );
+						details::file_sink_write_messages( l, messages_size );
+						write_calls = l.sink().write_calls();
+					}
+					details::file_sink_print_syscalls( std::string( "buffered_file_logger " ) + policies[ i ].first, details::file_sink_write_syscalls() - syscalls, messages_size, tt.elapsed() );
+					BOOST_CHECK( write_calls < messages_size / 100 );
+				}
+				remove( "file_sink_test_4.out" );
+			}
+		}
+	}
+}
@@ -0,0 +1,153 @@
+#include "test_registrator.h"
+
+#include <file_logger.h>
+#include <mapped_file_sink.h>
+#include <ts_logger.h>
+#include <time_tracker.h>
+
+#include <boost/thread.hpp>
+
+using namespace system_utilities::common;
+
+namespace system_utilities
+{
+	namespace tests_
+	{
+		namespace common
+		{
+			namespace details
+			{
+				std::string mapped_file_read_file( const std::string& file_path )
+				{
+					std::ifstream file( file_path.c_str(), std::ios::in | std::ios::binary );
+					std::stringstream result;
+					result << file.rdbuf();
+					return result.str();
+				}
+				template< class logger_type >
+				void mapped_file_writer( logger_type* logger, const size_t writer, const size_t size )
+				{
+					for ( size_t i = 0 ; i < size ; ++i )
+						logger->note( "writer {} message {}", writer, i );
+				}
+				template< class logger_type >
+				size_t mapped_file_write_threads( logger_type& logger, const size_t threads_size, const size_t messages_size )
+				{
+					time_tracker< std::chrono::milliseconds > tt;
+					boost::thread_group tg;
+					for ( size_t i = 0 ; i < threads_size ; ++i )
+						tg.create_thread( boost::bind( &mapped_file_writer< logger_type >, &logger, i, messages_size ) );
+					tg.join_all();
+					return static_cast< size_t >( tt.elapsed() );
+				}
+			}
+			void mapped_file_sink_append_tests()
+			{
+#ifdef _LINUX
+				using namespace boost::filesystem;
+				std::string expected;
+				{
+					mapped_file_sink sink( "mapped_file_test_1.out", 1, std::ios_base::trunc );
+					const size_t window_size = sink.window_size();
+					BOOST_CHECK( window_size > 0 );
+					BOOST_CHECK_EQUAL( window_size % 4096, 0u );
+					// lines cross window bounds, windows are remapped more times than sink keeps windows
+					for ( size_t i = 0 ; expected.size() < window_size * 10 ; ++i )
+					{
+						const std::string line = "line " + boost::lexical_cast< std::string >( i ) + "\n";
+						BOOST_CHECK_EQUAL( sink.append( line.data(), line.size() ), true );
+						expected += line;
+					}
+					// append that is bigger than window
+					const std::string big( window_size * 2 + 10, 'b' );
+					BOOST_CHECK_EQUAL( sink.append( big.data(), big.size() ), true );
+					expected += big;
+					std::ostream stream( &sink );
+					stream << "stream " << 1 << '\n';
+					expected += "stream 1\n";
+					BOOST_CHECK_EQUAL( sink.size(), expected.size() );
+					BOOST_CHECK_EQUAL( sink.dropped(), 0u );
+					BOOST_CHECK_EQUAL( sink.failed(), false );
+				}
+				// file is truncated to used size
+				BOOST_CHECK_EQUAL( file_size( "mapped_file_test_1.out" ), expected.size() );
+				BOOST_CHECK( details::mapped_file_read_file( "mapped_file_test_1.out" ) == expected );
+				{
+					mapped_file_sink sink( "mapped_file_test_1.out", 1 );
+					BOOST_CHECK_EQUAL( sink.size(), expected.size() );
+					BOOST_CHECK_EQUAL( sink.append( "appended\n", 9 ), true );
+				}
+				BOOST_CHECK( details::mapped_file_read_file( "mapped_file_test_1.out" ) == expected + "appended\n" );
+				remove( "mapped_file_test_1.out" );
+				BOOST_CHECK_THROW( mapped_file_sink( "not_existing_directory/mapped_file_test.out" ), std::logic_error );
+#endif
+			}
+			void mapped_file_logger_tests()
+			{
+#ifdef _LINUX
+				using namespace boost::filesystem;
+				{
+					mapped_file_logger<> l( "mapped_file_test_2.out", 4096, std::ios_base::trunc );
+					l.warn( "message {}", 1 );
+				}
+				{
+					std::ifstream file( "mapped_file_test_2.out" );
+					std::string line;
+					BOOST_REQUIRE( std::getline( file, line ) );
+					BOOST_CHECK_EQUAL( line[ 0 ], '[' );
+					BOOST_CHECK_EQUAL( line.substr( line.size() - 20 ), ":WARNING]: message 1" );
+					BOOST_CHECK_EQUAL( std::getline( file, line ).eof(), true );
+				}
+				static const size_t threads_size = 4;
+				static const size_t messages_size = 5000;
+				{
+					mapped_file_logger< false > l( "mapped_file_test_2.out", 4096, std::ios_base::trunc );
+					details::mapped_file_write_threads( l, threads_size, messages_size );
+					BOOST_CHECK_EQUAL( l.sink().dropped(), 0u );
+				}
+				std::ifstream file( "mapped_file_test_2.out" );
+				std::vector< size_t > next( threads_size, 0 );
+				std::string line;
+				size_t messages = 0;
+				while ( std::getline( file, line ) )
+				{
+					size_t writer = 0, message = 0;
+					BOOST_REQUIRE_EQUAL( std::sscanf( line.c_str(), "writer %zu message %zu", &writer, &message ), 2 );
+					BOOST_REQUIRE( writer < threads_size );
+					// lines of one thread are appended in write order
+					BOOST_CHECK_EQUAL( message, next[ writer ]++ );
+					++messages;
+				}
+				BOOST_CHECK_EQUAL( messages, threads_size * messages_size );
+				file.close();
+				remove( "mapped_file_test_2.out" );
+#endif
+			}
+			void mapped_file_logger_performance_tests()
+			{
+#ifdef _LINUX
+				static const size_t threads_size = 4;
+				static const size_t messages_size = 40000;
+				using namespace boost::filesystem;
+				{
+					remove( "mapped_file_test_3.out" );
+					ts_logger< file_logger< logger< true, false, true > > > l( "mapped_file_test_3.out" );
+					std::cout << "ts_logger< file_logger<> > (ofstream, no flush): " << details::mapped_file_write_threads( l, threads_size, messages_size ) << " ms" << std::endl;
+				}
+				{
+					remove( "mapped_file_test_3.out" );
+					buffered_file_logger<> l( "mapped_file_test_3.out" );
+					std::cout << "buffered_file_logger: " << details::mapped_file_write_threads( l, threads_size, messages_size ) << " ms" << std::endl;
+				}
+				{
+					remove( "mapped_file_test_3.out" );
+					mapped_file_logger<> l( "mapped_file_test_3.out" );
+					std::cout << "mapped_file_logger: " << details::mapped_file_write_threads( l, threads_size, messages_size ) << " ms" << std::endl;
+					BOOST_CHECK_EQUAL( l.sink().dropped(), 0u );
+				}
+				remove( "mapped_file_test_3.out" );
+#endif
+			}
+		}
+	}
+}
@@ -14,9 +14,18 @@ TEST_INIT
 	master_test_suite.add( BOOST_TEST_CASE( &file_logger_error_tests ) );
 	master_test_suite.add( BOOST_TEST_CASE( &file_logger_debug_tests ) );
 	master_test_suite.add( BOOST_TEST_CASE( &file_logger_fatal_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &file_sink_constructor_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &file_sink_flush_policy_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &file_sink_big_message_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &buffered_file_logger_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &file_sink_write_error_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &mapped_file_sink_append_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &mapped_file_logger_tests ) );
 	
 #ifdef RUN_PERFORMANCE_TESTS
 	master_test_suite.add( BOOST_TEST_CASE( &file_logger_performance_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &file_sink_performance_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &mapped_file_logger_performance_tests ) );
 #endif 
 
 	return TEST_RETURN;
@@ -13,8 +13,17 @@ namespace system_utilities
 			void file_logger_error_tests();
 			void file_logger_debug_tests();
 			void file_logger_fatal_tests();
+			void file_sink_constructor_tests();
+			void file_sink_flush_policy_tests();
+			void file_sink_big_message_tests();
+			void buffered_file_logger_tests();
+			void file_sink_write_error_tests();
+			void mapped_file_sink_append_tests();
+			void mapped_file_logger_tests();
 			//
 			void file_logger_performance_tests();
+			void file_sink_performance_tests();
+			void mapped_file_logger_performance_tests();
 		}
 	}
 }
@@ -68,6 +68,128 @@ namespace system_utilities
 				BOOST_CHECK_NO_THROW( boost::filesystem::remove( "file_name" ) );
 				BOOST_CHECK_NO_THROW( boost::filesystem::remove( "file_name.old" ) );
 			}
+			namespace details
+			{
+				size_t limited_file_logger_lines( const std::string& file_path )
+				{
+					std::ifstream file( file_path.c_str() );
+					std::string line;
+					size_t result = 0;
+					while ( std::getline( file, line ) )
+						++result;
+					return result;
+				}
+			}
+			void limited_file_logger_rotation_tests()
+			{
+				using namespace boost::filesystem;
+				static const size_t messages_size = 1100;
+				// 930 messages of 1024 bytes are more than 90% of limit
+				static const size_t prepare_messages_size = 930;
+				const std::string message( 1023, 'm' );
+				{
+					limited_file_logger< true, false, false, 1ul > lfl( "rotation_file", std::ios_base::trunc );
+					BOOST_CHECK_EQUAL( lfl.rotation_ready(), true );
+					BOOST_CHECK_EQUAL( exists( "rotation_file.next" ), false );
+					for ( size_t i = 0 ; i < prepare_messages_size ; ++i )
+						lfl.note( message );
+					// next file is pre-opened by background thread when log reaches 90% of limit
+					for ( size_t i = 0 ; i < 1000 && !lfl.rotation_ready() ; ++i )
+						boost::this_thread::sleep( boost::posix_time::milliseconds( 1 ) );
+					BOOST_REQUIRE_EQUAL( lfl.rotation_ready(), true );
+					BOOST_CHECK_EQUAL( exists( "rotation_file.next" ), true );
+					BOOST_CHECK_EQUAL( exists( "rotation_file.old" ), false );
+					for ( size_t i = prepare_messages_size ; i < messages_size ; ++i )
+						lfl.note( message );
+					for ( size_t i = 0 ; i < 1000 && !lfl.rotation_ready() ; ++i )
+						boost::this_thread::sleep( boost::posix_time::milliseconds( 1 ) );
+					BOOST_REQUIRE_EQUAL( lfl.rotation_ready(), true );
+					BOOST_CHECK_EQUAL( exists( "rotation_file.old" ), true );
+					BOOST_CHECK_EQUAL( file_size( "rotation_file.old" ) <= 1024 * 1024, true );
+					// next file is not pre-opened until new log reaches 90% of limit
+					BOOST_CHECK_EQUAL( exists( "rotation_file.next" ), false );
+					lfl.note( "last" );
+				}
+				// messages are not lost
+				BOOST_CHECK_EQUAL( exists( "rotation_file.next" ), false );
+				BOOST_CHECK_EQUAL( details::limited_file_logger_lines( "rotation_file.old" ) + details::limited_file_logger_lines( "rotation_file" ), messages_size + 1 );
+				BOOST_CHECK_NO_THROW( remove( "rotation_file" ) );
+				BOOST_CHECK_NO_THROW( remove( "rotation_file.old" ) );
+				if ( !rotation_compression::supported( rotation_compression::gzip ) )
+					return;
+				{
+					limited_file_logger< true, false, false, 1ul > lfl( "rotation_file", std::ios_base::trunc );
+					lfl.set_compression( rotation_compression::gzip );
+					for ( size_t i = 0 ; i < prepare_messages_size ; ++i )
+						lfl.note( message );
+					for ( size_t i = 0 ; i < 1000 && !lfl.rotation_ready() ; ++i )
+						boost::this_thread::sleep( boost::posix_time::milliseconds( 1 ) );
+					for ( size_t i = prepare_messages_size ; i < messages_size ; ++i )
+						lfl.note( message );
+				}
+				BOOST_CHECK_EQUAL( exists( "rotation_file.old" ), false );
+				BOOST_REQUIRE_EQUAL( exists( "rotation_file.old.gz" ), true );
+				BOOST_CHECK_EQUAL( file_size( "rotation_file.old.gz" ) < 64 * 1024, true );
+				{
+					std::ifstream gz( "rotation_file.old.gz", std::ios::in | std::ios::binary );
+					char magic[ 2 ] = { 0, 0 };
+					gz.read( magic, 2 );
+					BOOST_CHECK_EQUAL( static_cast< unsigned char >( magic[ 0 ] ), 0x1f );
+					BOOST_CHECK_EQUAL( static_cast< unsigned char >( magic[ 1 ] ), 0x8b );
+				}
+				BOOST_CHECK_NO_THROW( remove( "rotation_file" ) );
+				BOOST_CHECK_NO_THROW( remove( "rotation_file.old.gz" ) );
+			}
+			void limited_file_logger_recovery_tests()
+			{
+				using namespace boost::filesystem;
+				{
+					// next file with messages is left by stopped process during rotation
+					std::ofstream( "recovery_file" ) << "old" << std::endl;
+					std::ofstream( "recovery_file.next" ) << "next" << std::endl;
+					limited_file_logger< true, false, false, 1ul > lfl( "recovery_file" );
+					BOOST_CHECK_EQUAL( exists( "recovery_file.next" ), false );
+					lfl.note( "new" );
+				}
+				{
+					std::ifstream old_file( "recovery_file.old" );
+					std::stringstream old_content;
+					old_content << old_file.rdbuf();
+					BOOST_CHECK_EQUAL( old_content.str(), "old\n" );
+					std::ifstream file( "recovery_file" );
+					std::stringstream content;
+					content << file.rdbuf();
+					BOOST_CHECK_EQUAL( content.str(), "next\nnew\n" );
+				}
+				BOOST_CHECK_NO_THROW( remove( "recovery_file.old" ) );
+				{
+					// empty next file is removed
+					std::ofstream( "recovery_file.next" );
+					limited_file_logger< true, false, false, 1ul > lfl( "recovery_file" );
+					BOOST_CHECK_EQUAL( exists( "recovery_file.next" ), false );
+					BOOST_CHECK_EQUAL( exists( "recovery_file.old" ), false );
+				}
+				BOOST_CHECK_NO_THROW( remove( "recovery_file" ) );
+			}
+			void limited_file_logger_performance_rotation_tests()
+			{
+				using namespace boost::filesystem;
+				static const size_t messages_size = 4 * 1024;
+				const std::string message( 1023, 'm' );
+				long long max_latency = 0;
+				{
+					limited_file_logger< true, false, false, 1ul > lfl( "rotation_performance_file", std::ios_base::trunc );
+					for ( size_t i = 0 ; i < messages_size ; ++i )
+					{
+						time_tracker< std::chrono::microseconds > tt;
+						lfl.note( message );
+						max_latency = std::max< long long >( max_latency, tt.elapsed() );
+					}
+				}
+				std::cout << "limited_file_logger: max write latency of " << messages_size << " messages (1MB limit, 4MB written) " << max_latency << " us" << std::endl;
+				remove( "rotation_performance_file" );
+				remove( "rotation_performance_file.old" );
+			}
 		}
 	}
 }
@@ -10,8 +10,11 @@ TEST_INIT
 	using namespace system_utilities::tests_::common;
 	
 	master_test_suite.add( BOOST_TEST_CASE( &limited_file_logger_constructor_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &limited_file_logger_rotation_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &limited_file_logger_recovery_tests ) );
 	
 #ifdef RUN_PERFORMANCE_TESTS
+	master_test_suite.add( BOOST_TEST_CASE( &limited_file_logger_performance_rotation_tests ) );
 #endif 
 
 	return TEST_RETURN;
@@ -8,6 +8,10 @@ namespace system_utilities
 		namespace common
 		{
 			void limited_file_logger_constructor_tests();
+			void limited_file_logger_rotation_tests();
+			void limited_file_logger_recovery_tests();
+			//
+			void limited_file_logger_performance_rotation_tests();
 		}
 	}
 }
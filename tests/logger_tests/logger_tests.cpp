@@ -3,7 +3,10 @@
 #include <logger.h>
 #include <time_tracker.h>
 
+#include <iomanip>
+
 #include <boost/regex.hpp>
+#include <boost/shared_ptr.hpp>
 
 using namespace system_utilities::common;
 
@@ -230,6 +233,192 @@ namespace system_utilities
 				boost::regex message_regex( "\\[\\d{4}\\-\\w{3}\\-\\d{2} \\d{2}\\:\\d{2}\\:\\d{2}\\.\\d{6}\\:FATAL  \\]\\: new zve message 3\n" );
 				BOOST_CHECK_EQUAL( boost::regex_match( stream_content, message_regex ), true );
 			}
+			void logger_streamer_tests()
+			{
+				typedef logger< true, false, false > logger;
+				{
+					std::stringstream stream;
+					logger l( stream );
+					l.note() << "value " << std::hex << 255 << " " << std::setprecision( 2 ) << 3.14159;
+					// format flags of previous message do not affect next message
+					l.note() << "value " << 255 << " " << 3.14159;
+					BOOST_CHECK_EQUAL( stream.str(), "value ff 3.1\nvalue 255 3.14159\n" );
+				}
+				{
+					std::stringstream stream;
+					logger l( stream );
+					const std::string big( 3 * system_utilities::common::details::streamer_buffer::capacity, 'b' );
+					l.note() << big << "!";
+					l.note() << "small";
+					BOOST_CHECK_EQUAL( stream.str(), big + "!\nsmall\n" );
+				}
+				{
+					// second streamer of one thread does not share thread buffer with first one
+					std::stringstream stream;
+					logger l( stream );
+					{
+						auto first = l.note();
+						first << "first";
+						l.note() << "second";
+					}
+					l.note() << "third";
+					BOOST_CHECK_EQUAL( stream.str(), "second\nfirst\nthird\n" );
+				}
+				{
+					// disabled streamer does not take thread buffer and does not format arguments
+					using namespace system_utilities::common::details;
+					std::stringstream stream;
+					logger l( stream );
+					set_log_level( message_level::error );
+					{
+						auto disabled = l.note();
+						disabled << "disabled " << 255;
+						streamer_buffer* const buffer = streamer_buffer::acquire();
+						BOOST_CHECK( buffer != NULL );
+						if ( buffer )
+							buffer->release();
+					}
+					set_log_level( message_level::debug );
+					l.note() << "enabled";
+					BOOST_CHECK_EQUAL( stream.str(), "enabled\n" );
+				}
+			}
+			namespace details
+			{
+				size_t evaluated_arguments = 0;
+				size_t evaluate_argument()
+				{
+					return ++evaluated_arguments;
+				}
+			}
+			void logger_level_tests()
+			{
+				using namespace system_utilities::common::details::message_level;
+				BOOST_CHECK( severity( debug ) < severity( note ) );
+				BOOST_CHECK( severity( note ) < severity( warn ) );
+				BOOST_CHECK( severity( warn ) < severity( error ) );
+				BOOST_CHECK( severity( error ) < severity( fatal ) );
+				{
+					std::stringstream stream;
+					logger< true, false, false, warn > l( stream );
+					BOOST_CHECK_EQUAL( l.enabled( debug ), false );
+					BOOST_CHECK_EQUAL( l.enabled( note ), false );
+					BOOST_CHECK_EQUAL( l.enabled( warn ), true );
+					l.debug( "debug" );
+					l.note() << "note";
+					l.formatted_note( "formatted %s", "note" );
+					l.warn( "warn" );
+					l.error() << "error";
+					l.formatted_fatal( "formatted %s", "fatal" );
+					BOOST_CHECK_EQUAL( stream.str(), "warn\nerror\nformatted fatal\n" );
+				}
+				{
+					// arguments of disabled levels are not evaluated
+					std::stringstream stream;
+					logger< true, false, false, note > l( stream );
+					details::evaluated_arguments = 0;
+					SYSTEM_UTILITIES_LOG_DEBUG( l ) << "debug " << details::evaluate_argument();
+					SYSTEM_UTILITIES_LOG_NOTE( l ) << "note " << details::evaluate_argument();
+					if ( details::evaluated_arguments )
+						SYSTEM_UTILITIES_LOG( l, warn ) << "warn " << details::evaluate_argument();
+					else
+						SYSTEM_UTILITIES_LOG_ERROR( l ) << "error";
+					logger< false > off( stream );
+					SYSTEM_UTILITIES_LOG_FATAL( off ) << "fatal " << details::evaluate_argument();
+					BOOST_CHECK_EQUAL( details::evaluated_arguments, 2u );
+					BOOST_CHECK_EQUAL( stream.str(), "note 1\nwarn 2\n" );
+				}
+				{
+					// runtime log level
+					std::stringstream stream;
+					logger< true, false, false > l( stream );
+					BOOST_CHECK_EQUAL( log_level(), debug );
+					set_log_level( error );
+					BOOST_CHECK_EQUAL( log_level(), error );
+					details::evaluated_arguments = 0;
+					SYSTEM_UTILITIES_LOG_WARN( l ) << "warn " << details::evaluate_argument();
+					l.note( "note" );
+					l.error( "error" );
+					set_log_level( debug );
+					SYSTEM_UTILITIES_LOG_DEBUG( l ) << "debug " << details::evaluate_argument();
+					BOOST_CHECK_EQUAL( stream.str(), "error\ndebug 1\n" );
+				}
+				system_utilities::common::details::message_level::value level = note;
+				BOOST_CHECK_EQUAL( parse_log_level( "warning", level ), true );
+				BOOST_CHECK_EQUAL( level, warn );
+				BOOST_CHECK_EQUAL( parse_log_level( "fatal", level ), true );
+				BOOST_CHECK_EQUAL( level, fatal );
+				BOOST_CHECK_EQUAL( parse_log_level( "verbose", level ), false );
+				BOOST_CHECK_EQUAL( level, fatal );
+			}
+			void logger_format_tests()
+			{
+				typedef logger< true, false, false > logger;
+				{
+					std::stringstream stream;
+					logger l( stream );
+					// bigger than thread buffer and bigger than previous 10 KB stack buffer
+					const std::string big( 3 * logger::format_buffer_size, 'f' );
+					l.formatted_note( "%s %d", big.c_str(), 5 );
+					l.formatted_warn( "small %s %.2f", "message", 2.5 );
+					BOOST_CHECK_EQUAL( stream.str(), big + " 5\nsmall message 2.50\n" );
+				}
+				{
+					std::stringstream stream;
+					logger l( stream );
+					const std::string name( "name" );
+					l.note( "{} is {} years, {} of {}", name, 42, 1.5, 'x' );
+					l.warn( "not enough {} {}", 1 );
+					l.error( "too many {}", 1, 2 );
+					l.debug( "{{}} {}}", 7 );
+					SYSTEM_UTILITIES_LOG_FORMAT( l, fatal, "checked {} {}", "format", 2 );
+					SYSTEM_UTILITIES_LOG_FORMAT( l, note, "without arguments" );
+					BOOST_CHECK_EQUAL( stream.str(), "name is 42 years, 1.5 of x\nnot enough 1 {}\ntoo many 1\n{7} {}}\nchecked format 2\nwithout arguments\n" );
+				}
+				{
+					std::stringstream stream;
+					system_utilities::common::logger< true, false, false, system_utilities::common::details::message_level::warn > l( stream );
+					details::evaluated_arguments = 0;
+					SYSTEM_UTILITIES_LOG_FORMAT( l, note, "note {}", details::evaluate_argument() );
+					l.note( "note {}", 1 );
+					BOOST_CHECK_EQUAL( details::evaluated_arguments, 0u );
+					BOOST_CHECK_EQUAL( stream.str(), "" );
+				}
+				static_assert( system_utilities::common::details::placeholders_count( "" ) == 0, "" );
+				static_assert( system_utilities::common::details::placeholders_count( "{}{}{}" ) == 3, "" );
+				static_assert( system_utilities::common::details::placeholders_count( "{{}} {}}" ) == 2, "" );
+				static_assert( system_utilities::common::details::placeholders_count(
+					"long format {} ................................................................................................................................"
+					"................................................................................................................................"
+					"................................................................................................................................"
+					"................................................................................................................................ {}" ) == 2, "" );
+			}
+			void logger_timestamp_formatter_tests()
+			{
+				using namespace boost::posix_time;
+				const ptime epoch( boost::gregorian::date( 1970, 1, 1 ) );
+				system_utilities::common::details::timestamp_formatter formatter;
+				const long long times[] = {
+					0ll, 1ll, 999999ll, 1000000ll, 1000001ll, 1451606399999999ll, 1451606400000000ll, 1451606400000001ll,
+					1456704000123456ll, 1456790399100000ll, 1456790400000010ll, 4102444799999999ll
+				};
+				for ( size_t i = 0 ; i < sizeof( times ) / sizeof( times[ 0 ] ) ; ++i )
+				{
+					const size_t size = formatter.format( times[ i ] );
+					BOOST_CHECK_EQUAL( std::string( formatter.data(), size ), to_simple_string( epoch + microseconds( times[ i ] ) ) );
+				}
+				// the same second: only microseconds are changed
+				for ( long long t = 1456704000000000ll ; t < 1456704003000000ll ; t += 7777 )
+				{
+					const size_t size = formatter.format( t );
+					BOOST_CHECK_EQUAL( std::string( formatter.data(), size ), to_simple_string( epoch + microseconds( t ) ) );
+				}
+				const ptime before = microsec_clock::universal_time();
+				const size_t size = formatter.now();
+				const ptime after = microsec_clock::universal_time();
+				const ptime now = time_from_string( std::string( formatter.data(), size ) );
+				BOOST_CHECK( before <= now && now <= after );
+			}
 			//
 			void logger_write_performance_tests()
 			{
@@ -239,6 +428,105 @@ namespace system_utilities
 				details::logger_write_performance_test_helper< true, false, false >( 400, 100 );
 				details::logger_write_performance_test_helper< true, false, true >( 1750, 1450 );
 			}
+			void logger_timestamp_formatter_performance_tests()
+			{
+				using namespace boost::posix_time;
+				static const size_t test_size = 1000000;
+				size_t size = 0;
+				long long to_simple_string_time = 0;
+				{
+					time_tracker< std::chrono::microseconds > tt;
+					for ( size_t i = 0 ; i < test_size ; ++i )
+						size += to_simple_string( microsec_clock::universal_time() ).size();
+					to_simple_string_time = tt.elapsed();
+				}
+				long long formatter_time = 0;
+				{
+					system_utilities::common::details::timestamp_formatter& formatter = system_utilities::common::details::timestamp_formatter::thread_formatter();
+					time_tracker< std::chrono::microseconds > tt;
+					for ( size_t i = 0 ; i < test_size ; ++i )
+						size += formatter.now();
+					formatter_time = tt.elapsed();
+				}
+				BOOST_CHECK( size > 0 );
+				// at 1M lines per second time of one line in nanoseconds is the same as thousandth part of one core
+				std::cout << test_size << " timestamps: to_simple_string " << to_simple_string_time * 1000 / test_size << " ns ("
+					<< to_simple_string_time / 10000.0 << "% of core at 1M lines/s), timestamp_formatter " << formatter_time * 1000 / test_size << " ns ("
+					<< formatter_time / 10000.0 << "% of core at 1M lines/s)" << std::endl;
+			}
+			namespace details
+			{
+				// previous formatted_write implementation
+				void vsprintf_note( logger< true, false, false >& l, const char* format, ... )
+				{
+					char buffer[ logger< true, false, false >::format_buffer_size ];
+					va_list arguments;
+					va_start( arguments, format );
+					vsprintf( buffer, format, arguments );
+					va_end( arguments );
+					l.note( buffer );
+				}
+			}
+			void logger_format_performance_tests()
+			{
+				// stream without buffer ignores output, so only message formatting is measured
+				static const size_t test_size = 1000000;
+				std::ostream null_stream( NULL );
+				logger< true, false, false > l( null_stream );
+				const std::string name( "instrument" );
+				long long vsprintf_time = 0;
+				{
+					time_tracker< std::chrono::microseconds > tt;
+					for ( size_t i = 0 ; i < test_size ; ++i )
+						details::vsprintf_note( l, "order %lu of %s at %f", static_cast< unsigned long >( i ), name.c_str(), 1.5 );
+					vsprintf_time = tt.elapsed();
+				}
+				long long vsnprintf_time = 0;
+				{
+					time_tracker< std::chrono::microseconds > tt;
+					for ( size_t i = 0 ; i < test_size ; ++i )
+						l.formatted_note( "order %lu of %s at %f", static_cast< unsigned long >( i ), name.c_str(), 1.5 );
+					vsnprintf_time = tt.elapsed();
+				}
+				long long fmt_time = 0;
+				{
+					time_tracker< std::chrono::microseconds > tt;
+					for ( size_t i = 0 ; i < test_size ; ++i )
+						SYSTEM_UTILITIES_LOG_FORMAT( l, note, "order {} of {} at {}", i, name, 1.5 );
+					fmt_time = tt.elapsed();
+				}
+				std::cout << test_size << " messages: vsprintf into 10 KB buffer " << vsprintf_time * 1000 / test_size << " ns per message, "
+					<< "formatted_note " << vsnprintf_time * 1000 / test_size << " ns per message, "
+					<< "fmt-style note " << fmt_time * 1000 / test_size << " ns per message" << std::endl;
+			}
+			void logger_streamer_performance_tests()
+			{
+				// stream without buffer ignores output, so only message formatting is measured
+				static const size_t test_size = 1000000;
+				std::ostream null_stream( NULL );
+				logger< true, false, false > l( null_stream );
+				long long stringstream_time = 0;
+				{
+					time_tracker< std::chrono::microseconds > tt;
+					for ( size_t i = 0 ; i < test_size ; ++i )
+					{
+						// previous logger_streamer implementation
+						boost::shared_ptr< std::stringstream > stream( new std::stringstream );
+						*stream << "message " << i << " of " << test_size << " value " << 3.5;
+						l.note( stream->str() );
+					}
+					stringstream_time = tt.elapsed();
+				}
+				long long streamer_time = 0;
+				{
+					time_tracker< std::chrono::microseconds > tt;
+					for ( size_t i = 0 ; i < test_size ; ++i )
+						l.note() << "message " << i << " of " << test_size << " value " << 3.5;
+					streamer_time = tt.elapsed();
+				}
+				std::cout << test_size << " messages: shared_ptr< stringstream > " << stringstream_time * 1000 / test_size << " ns per message, "
+					<< "thread buffer streamer " << streamer_time * 1000 / test_size << " ns per message" << std::endl;
+			}
 		}
 	}
 }
@@ -22,9 +22,16 @@ TEST_INIT
 	master_test_suite.add( BOOST_TEST_CASE( &logger_debug_tests ) );
 	master_test_suite.add( BOOST_TEST_CASE( &logger_formatted_debug_tests ) );
 	master_test_suite.add( BOOST_TEST_CASE( &logger_fatal_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &logger_streamer_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &logger_level_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &logger_format_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &logger_timestamp_formatter_tests ) );
 
 #ifdef RUN_PERFORMANCE_TESTS
 	master_test_suite.add( BOOST_TEST_CASE( &logger_write_performance_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &logger_streamer_performance_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &logger_format_performance_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &logger_timestamp_formatter_performance_tests ) );
 #endif 
 
 	return TEST_RETURN;
@@ -20,8 +20,15 @@ namespace system_utilities
 			void logger_formatted_debug_tests();
 			void logger_fatal_tests();
 			void logger_formatted_fatal_tests();
+			void logger_streamer_tests();
+			void logger_level_tests();
+			void logger_format_tests();
+			void logger_timestamp_formatter_tests();
 			//
 			void logger_write_performance_tests();
+			void logger_streamer_performance_tests();
+			void logger_format_performance_tests();
+			void logger_timestamp_formatter_performance_tests();
 		}
 	}
 }
@@ -0,0 +1,169 @@
+#include "test_registrator.h"
+
+#include <binary_logger.h>
+#include <queue_logger.h>
+#include <task_statistics.h>
+
+#include <boost/algorithm/string.hpp>
+
+using namespace system_utilities::common;
+
+namespace system_utilities
+{
+	namespace tests_
+	{
+		namespace common
+		{
+			namespace details
+			{
+				typedef std::vector< std::string > strings;
+
+				strings binary_logger_lines( const std::string& result )
+				{
+					strings lines;
+					boost::algorithm::split( lines, result, boost::algorithm::is_any_of( "\n" ) );
+					return lines;
+				}
+				void binary_logger_writer( binary_logger* logger, const size_t writer, const size_t size )
+				{
+					for ( size_t i = 0 ; i < size ; ++i )
+						while ( !logger->note( "writer {} message {}", writer, i ) )
+							boost::this_thread::yield();
+				}
+				long long binary_logger_now()
+				{
+					return std::chrono::duration_cast< std::chrono::nanoseconds >( std::chrono::steady_clock::now().time_since_epoch() ).count();
+				}
+				void binary_logger_print_latency( const char* const name, const latency_histogram& h )
+				{
+					std::cout << name << " write latency ns: p50 " << h.percentile( 50.0 ) << ", p99 " << h.percentile( 99.0 )
+						<< ", p99.9 " << h.percentile( 99.9 ) << ", max " << h.max() << std::endl;
+				}
+			}
+			void binary_logger_format_tests()
+			{
+				std::stringstream stream;
+				{
+					binary_logger logger( stream, false );
+					const std::string name( "std string" );
+					const char* const c_string = "c string";
+					const char* const null_string = NULL;
+					logger.note( "plain message" );
+					logger.warn( "int {}, negative {}, unsigned {}, long long {}", 42, -7, 3u, 1234567890123ll );
+					logger.error( "double {}, char {}, bool {} {}", 2.5, 'x', true, false );
+					logger.debug( "{} and {} and {}[{}]", name, c_string, "literal", null_string );
+					logger.fatal( "not enough arguments {} {}", 1 );
+					logger.note( "too many arguments", 1, 2 );
+					logger.flush();
+					const details::strings lines = details::binary_logger_lines( stream.str() );
+					BOOST_REQUIRE_EQUAL( lines.size(), 7u );
+					BOOST_CHECK_EQUAL( lines[ 0 ], "plain message" );
+					BOOST_CHECK_EQUAL( lines[ 1 ], "int 42, negative -7, unsigned 3, long long 1234567890123" );
+					BOOST_CHECK_EQUAL( lines[ 2 ], "double 2.5, char x, bool true false" );
+					BOOST_CHECK_EQUAL( lines[ 3 ], "std string and c string and literal[]" );
+					BOOST_CHECK_EQUAL( lines[ 4 ], "not enough arguments 1 {}" );
+					BOOST_CHECK_EQUAL( lines[ 5 ], "too many arguments" );
+				}
+				std::stringstream prefixed;
+				{
+					binary_logger logger( prefixed );
+					logger.warn( "message {}", 1 );
+				}
+				const details::strings lines = details::binary_logger_lines( prefixed.str() );
+				BOOST_REQUIRE_EQUAL( lines.size(), 2u );
+				BOOST_CHECK_EQUAL( lines[ 0 ][ 0 ], '[' );
+				BOOST_CHECK( boost::algorithm::ends_with( lines[ 0 ], ":WARNING]: message 1" ) );
+				// the same time format as logger prefix: [2016-Jan-01 10:20:30.123456:WARNING]: message 1
+				BOOST_CHECK_EQUAL( lines[ 0 ].find( ':' ), 15u );
+			}
+			void binary_logger_threads_tests()
+			{
+				static const size_t threads_size = 4;
+				static const size_t messages_size = 5000;
+				std::stringstream stream;
+				{
+					binary_logger logger( stream, false, 4096 );
+					boost::thread_group tg;
+					for ( size_t i = 0 ; i < threads_size ; ++i )
+						tg.create_thread( boost::bind( &details::binary_logger_writer, &logger, i, messages_size ) );
+					tg.join_all();
+				}
+				const details::strings lines = details::binary_logger_lines( stream.str() );
+				std::vector< size_t > next( threads_size, 0 );
+				size_t messages = 0;
+				for ( size_t i = 0 ; i + 1 < lines.size() ; ++i )
+				{
+					if ( boost::algorithm::ends_with( lines[ i ], "messages dropped" ) )
+						continue;
+					size_t writer = 0, message = 0;
+					BOOST_REQUIRE_EQUAL( std::sscanf( lines[ i ].c_str(), "writer %zu message %zu", &writer, &message ), 2 );
+					BOOST_REQUIRE( writer < threads_size );
+					// messages of one thread are written in write order
+					BOOST_CHECK_EQUAL( message, next[ writer ]++ );
+					++messages;
+				}
+				BOOST_CHECK_EQUAL( messages, threads_size * messages_size );
+			}
+			void binary_logger_dropped_messages_tests()
+			{
+				std::stringstream stream;
+				{
+					// background thread sleeps, ring of 128 bytes keeps two messages
+					binary_logger logger( stream, false, 128, 1000000 );
+					boost::this_thread::sleep( boost::posix_time::milliseconds( 10 ) );
+					BOOST_CHECK_EQUAL( logger.note( "first {}", 1 ), true );
+					size_t dropped = 0;
+					for ( size_t i = 0 ; i < 10 ; ++i )
+						if ( !logger.note( "next {}", i ) )
+							++dropped;
+					BOOST_CHECK_EQUAL( logger.dropped(), dropped );
+					BOOST_CHECK( dropped > 0 );
+					// message that is bigger than half of ring is always dropped
+					BOOST_CHECK_EQUAL( logger.note( "{}", std::string( 64, 'x' ) ), false );
+					logger.flush();
+					BOOST_CHECK_EQUAL( logger.note( "after flush" ), true );
+					logger.flush();
+					const details::strings lines = details::binary_logger_lines( stream.str() );
+					BOOST_REQUIRE( lines.size() >= 3u );
+					BOOST_CHECK_EQUAL( lines[ lines.size() - 3 ], boost::lexical_cast< std::string >( dropped + 1 ) + " messages dropped" );
+					BOOST_CHECK_EQUAL( lines[ lines.size() - 2 ], "after flush" );
+				}
+			}
+			void binary_logger_performance_write_tests()
+			{
+				static const size_t messages_size = 200000;
+				const std::string name( "instrument" );
+				latency_histogram queue_logger_latency;
+				{
+					std::stringstream stream;
+					queue_logger< true, false, true >::tasker task_processor( 1 );
+					queue_logger< true, false, true > logger( stream, task_processor );
+					for ( size_t i = 0 ; i < messages_size ; ++i )
+					{
+						const long long start = details::binary_logger_now();
+						logger.note() << "order " << i << " of " << name << " at " << 1.5;
+						queue_logger_latency.record( details::binary_logger_now() - start );
+					}
+					task_processor.wait();
+				}
+				latency_histogram binary_logger_latency;
+				size_t dropped = 0;
+				{
+					std::stringstream stream;
+					// ring keeps all messages, so latency of dropped messages does not hide latency of writes
+					binary_logger logger( stream, true, 16 * 1024 * 1024, 100 );
+					for ( size_t i = 0 ; i < messages_size ; ++i )
+					{
+						const long long start = details::binary_logger_now();
+						logger.note( "order {} of {} at {}", i, name, 1.5 );
+						binary_logger_latency.record( details::binary_logger_now() - start );
+					}
+					dropped = logger.dropped();
+				}
+				details::binary_logger_print_latency( "queue_logger", queue_logger_latency );
+				details::binary_logger_print_latency( "binary_logger", binary_logger_latency );
+				std::cout << "binary_logger dropped " << dropped << " of " << messages_size << " messages" << std::endl;
+			}
+		}
+	}
+}
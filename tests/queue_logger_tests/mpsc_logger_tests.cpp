@@ -0,0 +1,156 @@
+#include "test_registrator.h"
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+
+#include <mpsc_logger.h>
+#include <ts_logger.h>
+#include <time_tracker.h>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/date_time/posix_time/posix_time.hpp>
+
+using namespace system_utilities::common;
+
+namespace system_utilities
+{
+	namespace tests_
+	{
+		namespace common
+		{
+			namespace details
+			{
+				typedef std::vector< std::string > strings;
+
+				strings mpsc_logger_lines( const std::string& result )
+				{
+					strings lines;
+					boost::algorithm::split( lines, result, boost::algorithm::is_any_of( "\n" ) );
+					return lines;
+				}
+				template< class logger_type >
+				void mpsc_logger_writer( logger_type* logger, const size_t writer, const size_t size )
+				{
+					for ( size_t i = 0 ; i < size ; ++i )
+						logger->note( "writer {} message {}", writer, i );
+				}
+				template< class logger_type >
+				size_t mpsc_logger_write_threads( logger_type& logger, const size_t threads_size, const size_t messages_size )
+				{
+					time_tracker< std::chrono::milliseconds > tt;
+					boost::thread_group tg;
+					for ( size_t i = 0 ; i < threads_size ; ++i )
+						tg.create_thread( boost::bind( &mpsc_logger_writer< logger_type >, &logger, i, messages_size ) );
+					tg.join_all();
+					return static_cast< size_t >( tt.elapsed() );
+				}
+				// mpsc_logger_time: timestamp from prefix "[2016-Jan-01 10:20:30.123456:NOTE   ]: "
+				boost::posix_time::ptime mpsc_logger_time( const std::string& line )
+				{
+					static const size_t level_size = std::string( ":NOTE   " ).size();
+					const size_t level_end = line.find( "]: " );
+					BOOST_REQUIRE( level_end != std::string::npos && level_end > level_size + 1 );
+					return boost::posix_time::time_from_string( line.substr( 1, level_end - level_size - 1 ) );
+				}
+			}
+			void mpsc_logger_write_tests()
+			{
+				std::stringstream stream;
+				{
+					mpsc_logger< false > logger( stream );
+					logger.note( "note" );
+					logger.warn() << "warn " << 1;
+					logger.error( "error {}", 2 );
+					logger.debug() << "debug " << 3;
+					logger.flush();
+					BOOST_CHECK_EQUAL( stream.str(), "note\nwarn 1\nerror 2\ndebug 3\n" );
+					logger.fatal( "fatal" );
+				}
+				// destructor writes all messages
+				BOOST_CHECK_EQUAL( stream.str(), "note\nwarn 1\nerror 2\ndebug 3\nfatal\n" );
+				std::stringstream prefixed;
+				{
+					mpsc_logger<> logger( prefixed );
+					logger.warn( "message" );
+				}
+				const details::strings lines = details::mpsc_logger_lines( prefixed.str() );
+				BOOST_REQUIRE_EQUAL( lines.size(), 2u );
+				BOOST_CHECK_EQUAL( lines[ 0 ][ 0 ], '[' );
+				BOOST_CHECK( boost::algorithm::ends_with( lines[ 0 ], ":WARNING]: message" ) );
+			}
+			void mpsc_logger_order_tests()
+			{
+				static const size_t threads_size = 4;
+				static const size_t messages_size = 5000;
+				std::stringstream stream;
+				{
+					// reorder window is big enough to order messages of test threads
+					mpsc_logger<> logger( stream, 200000 );
+					details::mpsc_logger_write_threads( logger, threads_size, messages_size );
+				}
+				const details::strings lines = details::mpsc_logger_lines( stream.str() );
+				std::vector< size_t > next( threads_size, 0 );
+				size_t messages = 0;
+				boost::posix_time::ptime previous_time( boost::posix_time::min_date_time );
+				for ( size_t i = 0 ; i + 1 < lines.size() ; ++i )
+				{
+					const size_t text = lines[ i ].find( "]: " );
+					BOOST_REQUIRE( text != std::string::npos );
+					size_t writer = 0, message = 0;
+					BOOST_REQUIRE_EQUAL( std::sscanf( lines[ i ].c_str() + text + 3, "writer %zu message %zu", &writer, &message ), 2 );
+					BOOST_REQUIRE( writer < threads_size );
+					// messages of one thread are written in write order
+					BOOST_CHECK_EQUAL( message, next[ writer ]++ );
+					// messages are ordered by time
+					const boost::posix_time::ptime time = details::mpsc_logger_time( lines[ i ] );
+					BOOST_CHECK( time >= previous_time );
+					previous_time = time;
+					++messages;
+				}
+				BOOST_CHECK_EQUAL( messages, threads_size * messages_size );
+			}
+			void mpsc_logger_flush_tests()
+			{
+				std::stringstream stream;
+				mpsc_logger< false > logger( stream );
+				std::atomic< bool > stop( false );
+				boost::thread writer( [&logger, &stop]()
+				{
+					while ( !stop )
+						logger.note( "writer message" );
+				} );
+				// flush returns while other thread keeps writing
+				for ( size_t i = 0 ; i < 3 ; ++i )
+				{
+					logger.note( "flush {}", i );
+					logger.flush();
+				}
+				stop = true;
+				writer.join();
+				logger.flush();
+				const std::string result = stream.str();
+				for ( size_t i = 0 ; i < 3 ; ++i )
+					BOOST_CHECK( result.find( "flush " + boost::lexical_cast< std::string >( i ) + "\n" ) != std::string::npos );
+			}
+			void mpsc_logger_performance_tests()
+			{
+				static const size_t threads_size = 4;
+				static const size_t messages_size = 25000;
+				static const char* const file_name = "mpsc_logger_performance_tests.out";
+				{
+					// logger does not flush stream after every message, as mpsc_logger
+					std::ofstream stream( file_name );
+					ts_logger< logger< true, false, true > > logger( stream );
+					std::cout << "ts_logger: " << details::mpsc_logger_write_threads( logger, threads_size, messages_size ) << " ms for " << threads_size * messages_size << " messages" << std::endl;
+				}
+				{
+					std::ofstream stream( file_name );
+					mpsc_logger<> logger( stream );
+					std::cout << "mpsc_logger: " << details::mpsc_logger_write_threads( logger, threads_size, messages_size ) << " ms for " << threads_size * messages_size << " messages" << std::endl;
+				}
+				std::remove( file_name );
+			}
+		}
+	}
+}
@@ -1,6 +1,8 @@
 #include "test_registrator.h"
 
 #include <queue_logger.h>
+#include <lock_free_queue.h>
+#include <pool_allocator.h>
 #include <time_tracker.h>
 
 #include <boost/algorithm/string.hpp>
@@ -17,6 +19,12 @@ namespace system_utilities
 			{
 				typedef queue_logger< true, false, false > q_logger;
 
+				template< class T >
+				using lock_free_logger_queue = lock_free_queue< T, 4096 >;
+				typedef queue_logger< true, false, false, lock_free_logger_queue > lock_free_q_logger;
+				typedef queue_logger< true, false, false, system_utilities::common::details::default_logger_queue, pool_allocator > pool_q_logger;
+				typedef queue_logger< true, false, false, system_utilities::common::details::default_logger_queue, std::allocator, system_utilities::common::details::message_level::warn > warn_q_logger;
+
 				void logger_writer( q_logger* logger, const size_t size )
 				{
 					for ( size_t i = 0 ; i < size ; ++i )
@@ -87,6 +95,88 @@ namespace system_utilities
 			{
 				details::queue_logger_write_test_helper( 2500, 50 );
 			}
+			void queue_logger_lock_free_queue_tests()
+			{
+				static const size_t messages_size = 10000;
+				std::stringstream stream;
+				{
+					details::lock_free_q_logger::tasker task_processor( 2 );
+					details::lock_free_q_logger logger( stream, task_processor );
+					for ( size_t i = 0 ; i < messages_size ; ++i )
+						logger.note() << "lock free message";
+					task_processor.wait();
+				}
+				typedef std::vector< std::string > strings;
+				strings lines;
+				const std::string result = stream.str();
+				boost::algorithm::split( lines, result, boost::algorithm::is_any_of( "\n" ) );
+				BOOST_CHECK_EQUAL( lines.size(), messages_size + 1 );
+				BOOST_CHECK_EQUAL( lines[ 0 ], "lock free message" );
+			}
+			void queue_logger_pool_allocator_tests()
+			{
+				static const size_t messages_size = 10000;
+				std::stringstream stream;
+				{
+					details::pool_q_logger::tasker task_processor( 2 );
+					details::pool_q_logger logger( stream, task_processor );
+					for ( size_t i = 0 ; i < messages_size ; ++i )
+						logger.note() << "pooled message";
+					task_processor.wait();
+				}
+				typedef std::vector< std::string > strings;
+				strings lines;
+				const std::string result = stream.str();
+				boost::algorithm::split( lines, result, boost::algorithm::is_any_of( "\n" ) );
+				BOOST_CHECK_EQUAL( lines.size(), messages_size + 1 );
+				BOOST_CHECK_EQUAL( lines[ 0 ], "pooled message" );
+			}
+			void queue_logger_min_level_tests()
+			{
+				using namespace system_utilities::common::details::message_level;
+				std::stringstream stream;
+				{
+					details::warn_q_logger::tasker task_processor( 1 );
+					details::warn_q_logger logger( stream, task_processor );
+					BOOST_CHECK_EQUAL( logger.enabled( note ), false );
+					BOOST_CHECK_EQUAL( logger.enabled( warn ), true );
+					logger.debug( "debug" );
+					logger.note() << "note";
+					logger.warn() << "warn";
+					logger.error( "error" );
+					task_processor.wait();
+				}
+				BOOST_CHECK_EQUAL( stream.str(), "warn\nerror\n" );
+			}
+			void queue_logger_dropped_messages_tests()
+			{
+				std::stringstream stream;
+				{
+					// elastic tasker without threads: messages stay in queue until resize
+					details::q_logger::tasker task_processor( elastic_settings( 0, 0 ) );
+					task_processor.set_capacity( capacity_settings( 4, overflow_policy::drop_newest ) );
+					details::q_logger logger( stream, task_processor );
+					for ( size_t i = 0 ; i < 10 ; ++i )
+						logger.note( "message " + boost::lexical_cast< std::string >( i ) );
+					BOOST_CHECK_EQUAL( task_processor.dropped(), 6u );
+					task_processor.resize( 1 );
+					task_processor.wait();
+					logger.note( "recovered" );
+					task_processor.wait();
+					logger.note( "next" );
+					task_processor.wait();
+				}
+				typedef std::vector< std::string > strings;
+				strings lines;
+				const std::string result = stream.str();
+				boost::algorithm::split( lines, result, boost::algorithm::is_any_of( "\n" ) );
+				BOOST_REQUIRE_EQUAL( lines.size(), 8u );
+				BOOST_CHECK_EQUAL( lines[ 0 ], "message 0" );
+				BOOST_CHECK_EQUAL( lines[ 3 ], "message 3" );
+				BOOST_CHECK_EQUAL( lines[ 4 ], "recovered" );
+				BOOST_CHECK_EQUAL( lines[ 5 ], "6 messages dropped" );
+				BOOST_CHECK_EQUAL( lines[ 6 ], "next" );
+			}
 			void queue_logger_performance_write_tests()
 			{
 				details::queue_logger_write_test_helper( 25000, 350 );
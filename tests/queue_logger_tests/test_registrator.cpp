@@ -10,9 +10,21 @@ TEST_INIT
 
 	master_test_suite.add( BOOST_TEST_CASE( &queue_logger_constructor_tests ) );
 	master_test_suite.add( BOOST_TEST_CASE( &queue_logger_write_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &queue_logger_lock_free_queue_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &queue_logger_pool_allocator_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &queue_logger_min_level_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &queue_logger_dropped_messages_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &binary_logger_format_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &binary_logger_threads_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &binary_logger_dropped_messages_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &mpsc_logger_write_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &mpsc_logger_order_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &mpsc_logger_flush_tests ) );
 
 #ifdef RUN_PERFORMANCE_TESTS
 	master_test_suite.add( BOOST_TEST_CASE( &queue_logger_performance_write_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &binary_logger_performance_write_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &mpsc_logger_performance_tests ) );
 #endif
 
 	return TEST_RETURN;
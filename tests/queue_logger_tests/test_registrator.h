@@ -9,7 +9,21 @@ namespace system_utilities
 		{
 			void queue_logger_constructor_tests();
 			void queue_logger_write_tests();
+			void queue_logger_lock_free_queue_tests();
+			void queue_logger_pool_allocator_tests();
+			void queue_logger_min_level_tests();
+			void queue_logger_dropped_messages_tests();
 			void queue_logger_performance_write_tests();
+
+			void binary_logger_format_tests();
+			void binary_logger_threads_tests();
+			void binary_logger_dropped_messages_tests();
+			void binary_logger_performance_write_tests();
+
+			void mpsc_logger_write_tests();
+			void mpsc_logger_order_tests();
+			void mpsc_logger_flush_tests();
+			void mpsc_logger_performance_tests();
 		}
 	}
 }
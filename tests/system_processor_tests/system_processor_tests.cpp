@@ -1,10 +1,16 @@
 #include "test_registrator.h"
 
 #include <system_processor.h>
+#include <task_processor.h>
 #include <time_tracker.h>
 
+#include <atomic>
+#include <fstream>
+#include <iterator>
+
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem.hpp>
+#include <boost/lexical_cast.hpp>
 #include <boost/regex.hpp>
 
 using namespace system_utilities::common;
@@ -13,6 +19,22 @@ namespace system_utilities
 {
 	namespace tests_
 	{
+		namespace details
+		{
+			class stats_counter_task
+			{
+				std::atomic< size_t >& counter_;
+			public:
+				explicit stats_counter_task( std::atomic< size_t >& counter )
+					: counter_( counter )
+				{
+				}
+				void operator()()
+				{
+					++counter_;
+				}
+			};
+		}
 		namespace common
 		{
 			void system_processor_constructor_tests()
@@ -415,6 +437,115 @@ namespace system_utilities
 				}
 				remove_all( "logs_010" );
 			}
+			void system_processor_threads_affinity_tests()
+			{
+				using namespace boost::filesystem;
+				static const std::string tests_directory = SOURCE_DIR "/tests/data/system_processor/";
+				current_path( tests_directory );
+
+				int argc = 1;
+				char* argv[1];
+                char argv0[] = SOURCE_DIR "/tests/data/system_processor/test.exe";
+                argv[0] = argv0;
+
+				BOOST_CHECK_THROW( system_processor::threads_affinity(), std::exception );
+				BOOST_CHECK_THROW( system_processor::init( argc, argv, "config_example_019.ini" ), std::logic_error );
+				remove_all( "logs_019" );
+				{
+					system_processor::sp sp = system_processor::init( argc, argv, "config_example_015.ini" );
+					BOOST_CHECK_EQUAL( system_processor::threads_affinity().policy(), affinity_policy::compact );
+
+					system_processor::set_config( "System.threads.affinity", std::string( "0-1,3" ) );
+					const thread_affinity cpus = system_processor::threads_affinity();
+					BOOST_CHECK_EQUAL( cpus.policy(), affinity_policy::cpu_list );
+					BOOST_CHECK_EQUAL( cpus.worker_cpus( 2 ).at( 0 ), 3u );
+
+					system_processor::set_config( "System.threads.affinity", std::string( "everywhere" ) );
+					BOOST_CHECK_THROW( system_processor::threads_affinity(), std::logic_error );
+				}
+				remove_all( "logs_015" );
+			}
+			void system_processor_stats_tests()
+			{
+				using namespace boost::filesystem;
+				static const std::string tests_directory = SOURCE_DIR "/tests/data/system_processor/";
+				current_path( tests_directory );
+
+				int argc = 1;
+				char* argv[1];
+				char argv0[] = SOURCE_DIR "/tests/data/system_processor/test.exe";
+				argv[0] = argv0;
+
+				BOOST_CHECK_THROW( system_processor::add_stats_provider( "name", system_processor::stats_provider() ), std::logic_error );
+				std::string engine_log;
+				{
+					system_processor::sp sp = system_processor::init( argc, argv, "config_example_016.ini" );
+					engine_log = system_processor::logs_path() + "_engine.log";
+					task_processor< tests_::details::stats_counter_task, ts_queue< tests_::details::stats_counter_task >, std::allocator< tests_::details::stats_counter_task >, 1, true > tp( 1 );
+					std::atomic< size_t > counter( 0 );
+					for ( size_t i = 0 ; i < 10 ; ++i )
+						tp.emplace_task( counter );
+					tp.wait();
+					system_processor::add_task_processor_stats( "tp", tp );
+
+					std::atomic< size_t > calls( 0 );
+					system_processor::add_stats_provider( "calls", [ &calls ]() { return boost::lexical_cast< std::string >( ++calls ); } );
+					for ( size_t i = 0 ; i < 200 && calls.load() < 2 ; ++i )
+						boost::this_thread::sleep( boost::posix_time::milliseconds( 5 ) );
+					BOOST_CHECK( calls.load() >= 2 );
+					system_processor::remove_stats_provider( "calls" );
+					const size_t calls_after_remove = calls.load();
+					system_processor::dump_stats();
+					boost::this_thread::sleep( boost::posix_time::milliseconds( 20 ) );
+					BOOST_CHECK_EQUAL( calls.load(), calls_after_remove );
+					system_processor::remove_stats_provider( "tp" );
+				}
+				std::ifstream log( engine_log.c_str() );
+				const std::string content( ( std::istreambuf_iterator< char >( log ) ), std::istreambuf_iterator< char >() );
+				BOOST_CHECK( content.find( "System.stats.period is set to 5 milliseconds" ) != std::string::npos );
+				BOOST_CHECK( content.find( "stats tp: submitted 10, completed 10, rejected 0" ) != std::string::npos );
+				BOOST_CHECK( content.find( "stats calls: 1" ) != std::string::npos );
+				remove_all( "logs_016" );
+			}
+			void system_processor_log_level_tests()
+			{
+				using namespace boost::filesystem;
+				static const std::string tests_directory = SOURCE_DIR "/tests/data/system_processor/";
+				current_path( tests_directory );
+
+				int argc = 1;
+				char* argv[1];
+				char argv0[] = SOURCE_DIR "/tests/data/system_processor/test.exe";
+				argv[0] = argv0;
+
+				BOOST_CHECK_THROW( system_processor::init( argc, argv, "config_example_018.ini" ), std::logic_error );
+				remove_all( "logs_018" );
+
+				std::string engine_log;
+				{
+					system_processor::sp sp = system_processor::init( argc, argv, "config_example_017.ini" );
+					engine_log = system_processor::logs_path() + "_engine.log";
+					BOOST_CHECK_EQUAL( log_level(), system_utilities::common::details::message_level::warn );
+					std::stringstream stream;
+					logger< true, false, false > l( stream );
+					l.note( "note" );
+					l.warn( "warn" );
+					set_log_level( system_utilities::common::details::message_level::note );
+					l.note( "note" );
+					BOOST_CHECK_EQUAL( stream.str(), "warn\nnote\n" );
+
+					set_log_level( system_utilities::common::details::message_level::warn );
+					system_processor::add_stats_provider( "level", []() { return std::string( "written at warn level" ); } );
+					system_processor::dump_stats();
+					system_processor::remove_stats_provider( "level" );
+				}
+				set_log_level( system_utilities::common::details::message_level::debug );
+				std::ifstream log( engine_log.c_str() );
+				const std::string content( ( std::istreambuf_iterator< char >( log ) ), std::istreambuf_iterator< char >() );
+				BOOST_CHECK( content.find( "System.log.level is set to warn" ) != std::string::npos );
+				BOOST_CHECK( content.find( "stats level: written at warn level" ) != std::string::npos );
+				remove_all( "logs_017" );
+			}
 		}
 	}
 }
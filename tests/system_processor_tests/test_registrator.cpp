@@ -21,6 +21,9 @@ TEST_INIT
 	master_test_suite.add( BOOST_TEST_CASE( &system_processor_config_rename_parameter_tests ) );
 	master_test_suite.add( BOOST_TEST_CASE( &system_processor_config_check_value_tests ) );
 	master_test_suite.add( BOOST_TEST_CASE( &system_processor_create_log_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &system_processor_threads_affinity_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &system_processor_stats_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &system_processor_log_level_tests ) );
 
 #ifdef RUN_PERFORMANCE_TESTS
 #endif 
@@ -20,6 +20,9 @@ namespace system_utilities
 			void system_processor_config_rename_parameter_tests();
 			void system_processor_config_check_value_tests();
 			void system_processor_create_log_tests();
+			void system_processor_threads_affinity_tests();
+			void system_processor_stats_tests();
+			void system_processor_log_level_tests();
 		}
 	}
 }
@@ -0,0 +1,213 @@
+#include "test_registrator.h"
+
+#include <atomic>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <vector>
+
+#include <task_processor.h>
+#include <pool_allocator.h>
+
+#include <time_tracker.h>
+
+using namespace system_utilities::common;
+
+namespace system_utilities
+{
+	namespace tests_
+	{
+		namespace details
+		{
+			int future_square_helper( const int value )
+			{
+				return value * value;
+			}
+			int future_throw_helper()
+			{
+				throw std::runtime_error( "task failed" );
+			}
+			struct future_counter_task
+			{
+				std::atomic< size_t >& counter_;
+				explicit future_counter_task( std::atomic< size_t >& counter )
+					: counter_( counter )
+				{
+				}
+				void operator()()
+				{
+					++counter_;
+				}
+			};
+			// throwing_allocator: allocator that could not allocate task
+			template< class T >
+			struct throwing_allocator : public std::allocator< T >
+			{
+				template< class U >
+				struct rebind
+				{
+					typedef throwing_allocator< U > other;
+				};
+				T* allocate( const size_t, const void* = 0 )
+				{
+					throw std::bad_alloc();
+				}
+			};
+			// counted_function: callable that counts its live copies
+			struct counted_function
+			{
+				std::atomic< size_t >& alive_;
+				explicit counted_function( std::atomic< size_t >& alive )
+					: alive_( alive )
+				{
+					++alive_;
+				}
+				counted_function( const counted_function& other )
+					: alive_( other.alive_ )
+				{
+					++alive_;
+				}
+				~counted_function()
+				{
+					--alive_;
+				}
+				int operator()() const
+				{
+					return 1;
+				}
+			};
+		}
+		namespace common
+		{
+			void future_submit_tests()
+			{
+				task_processor< function_task > tp( 2 );
+				future< int > f = tp.submit( boost::bind( &details::future_square_helper, 7 ) );
+				BOOST_CHECK_EQUAL( f.valid(), true );
+				BOOST_CHECK_EQUAL( f.get(), 49 );
+				BOOST_CHECK_EQUAL( f.ready(), true );
+
+				std::atomic< size_t > counter( 0 );
+				future< void > v = tp.submit( [ &counter ]() { ++counter; } );
+				v.get();
+				BOOST_CHECK_EQUAL( counter.load(), 1u );
+
+				future< std::unique_ptr< int > > move_only = tp.submit( []() { return std::unique_ptr< int >( new int( 5 ) ); } );
+				std::unique_ptr< int > ptr = move_only.get();
+				BOOST_CHECK_EQUAL( *ptr, 5 );
+
+				future< void > slow = tp.submit( []() { boost::this_thread::sleep( boost::posix_time::milliseconds( 200 ) ); } );
+				BOOST_CHECK_EQUAL( slow.wait_for( std::chrono::milliseconds( 1 ) ), false );
+				BOOST_CHECK_EQUAL( slow.wait_for( std::chrono::seconds( 10 ) ), true );
+
+				future< int > empty;
+				BOOST_CHECK_EQUAL( empty.valid(), false );
+				empty = tp.submit( boost::bind( &details::future_square_helper, 3 ) );
+				BOOST_CHECK_EQUAL( empty.get(), 9 );
+			}
+			void future_exception_tests()
+			{
+				task_processor< function_task, ts_queue< function_task >, pool_allocator< function_task > > tp( 2 );
+				future< int > f = tp.submit( &details::future_throw_helper );
+				BOOST_CHECK_THROW( f.get(), std::runtime_error );
+				// processing thread is alive after exception
+				future< int > next = tp.submit( boost::bind( &details::future_square_helper, 4 ) );
+				BOOST_CHECK_EQUAL( next.get(), 16 );
+			}
+			void future_broken_task_tests()
+			{
+				future< int > not_processed;
+				{
+					task_processor< function_task > tp( 0 );
+					not_processed = tp.submit( boost::bind( &details::future_square_helper, 2 ) );
+					BOOST_CHECK_EQUAL( not_processed.ready(), false );
+					tp.stop();
+					future< int > after_stop = tp.submit( boost::bind( &details::future_square_helper, 3 ) );
+					BOOST_CHECK_EQUAL( after_stop.ready(), true );
+					BOOST_CHECK_THROW( after_stop.get(), broken_task );
+				}
+				BOOST_CHECK_EQUAL( not_processed.ready(), true );
+				BOOST_CHECK_THROW( not_processed.get(), broken_task );
+			}
+			void future_submit_create_task_failure_tests()
+			{
+				std::atomic< size_t > alive( 0 );
+				{
+					task_processor< function_task, ts_queue< function_task >, details::throwing_allocator< function_task > > tp( 1 );
+					BOOST_CHECK_THROW( tp.submit( details::counted_function( alive ) ), std::bad_alloc );
+				}
+				// shared state with callable was released
+				BOOST_CHECK_EQUAL( alive.load(), 0u );
+			}
+			void future_when_all_tests()
+			{
+				task_processor< function_task > tp( 4 );
+				static const int tasks_size = 1000;
+				std::vector< future< int > > futures;
+				for ( int i = 0 ; i < tasks_size ; ++i )
+					futures.push_back( tp.submit( boost::bind( &details::future_square_helper, i ) ) );
+				future< void > all = when_all( futures.begin(), futures.end() );
+				all.get();
+				long long sum = 0;
+				for ( size_t i = 0 ; i < futures.size() ; ++i )
+				{
+					BOOST_CHECK_EQUAL( futures[ i ].ready(), true );
+					sum += futures[ i ].get();
+				}
+				BOOST_CHECK_EQUAL( sum, static_cast< long long >( tasks_size - 1 ) * tasks_size * ( 2 * tasks_size - 1 ) / 6 );
+
+				// ready futures and empty range
+				future< void > again = when_all( futures.begin(), futures.end() );
+				BOOST_CHECK_EQUAL( again.ready(), true );
+				std::vector< future< int > > nothing;
+				BOOST_CHECK_EQUAL( when_all( nothing.begin(), nothing.end() ).ready(), true );
+
+				// exception stays in its future
+				std::vector< future< int > > with_exception;
+				with_exception.push_back( tp.submit( boost::bind( &details::future_square_helper, 1 ) ) );
+				with_exception.push_back( tp.submit( &details::future_throw_helper ) );
+				BOOST_CHECK_NO_THROW( when_all( with_exception.begin(), with_exception.end() ).get() );
+				BOOST_CHECK_EQUAL( with_exception[ 0 ].get(), 1 );
+				BOOST_CHECK_THROW( with_exception[ 1 ].get(), std::runtime_error );
+
+				// invalid futures are rejected
+				std::vector< future< int > > with_invalid;
+				with_invalid.push_back( tp.submit( boost::bind( &details::future_square_helper, 2 ) ) );
+				with_invalid.push_back( future< int >() );
+				BOOST_CHECK_THROW( when_all( with_invalid.begin(), with_invalid.end() ), std::logic_error );
+				future< int > moved( std::move( with_invalid[ 0 ] ) );
+				BOOST_CHECK_THROW( when_all( with_invalid.begin(), with_invalid.begin() + 1 ), std::logic_error );
+				BOOST_CHECK_EQUAL( moved.get(), 4 );
+			}
+			void future_submit_performance_tests()
+			{
+				static const size_t tasks_size = 500000;
+				long long add_task_time = 0;
+				{
+					std::atomic< size_t > counter( 0 );
+					time_tracker< std::chrono::milliseconds > tt;
+					task_processor< details::future_counter_task, ts_queue< details::future_counter_task >, pool_allocator< details::future_counter_task > > tp( 2 );
+					for ( size_t i = 0 ; i < tasks_size ; ++i )
+						tp.add_task( tp.create_task( counter ) );
+					tp.wait();
+					add_task_time = tt.elapsed();
+					BOOST_CHECK_EQUAL( counter.load(), tasks_size );
+				}
+				long long submit_time = 0;
+				{
+					std::atomic< size_t > counter( 0 );
+					time_tracker< std::chrono::milliseconds > tt;
+					task_processor< function_task, ts_queue< function_task >, pool_allocator< function_task > > tp( 2 );
+					std::vector< future< void > > futures;
+					futures.reserve( tasks_size );
+					for ( size_t i = 0 ; i < tasks_size ; ++i )
+						futures.push_back( tp.submit( [ &counter ]() { ++counter; } ) );
+					when_all( futures.begin(), futures.end() ).wait();
+					submit_time = tt.elapsed();
+					BOOST_CHECK_EQUAL( counter.load(), tasks_size );
+				}
+				std::cout << tasks_size << " tasks: add_task + wait " << add_task_time << " ms, submit + when_all " << submit_time << " ms" << std::endl;
+			}
+		}
+	}
+}
@@ -0,0 +1,228 @@
+#include "test_registrator.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include <keyed_task_processor.h>
+#include <lock_free_queue.h>
+#include <pool_allocator.h>
+
+#include <time_tracker.h>
+
+using namespace system_utilities::common;
+
+namespace system_utilities
+{
+	namespace tests_
+	{
+		namespace details
+		{
+			// key_state: tasks of one key write their sequence numbers, busy flag detects concurrent processing of key
+			struct key_state
+			{
+				std::vector< size_t > sequence;
+				std::atomic< bool > busy;
+				std::atomic< size_t > overlaps;
+				key_state()
+					: busy( false )
+					, overlaps( 0 )
+				{
+				}
+			};
+			class keyed_sequence_task
+			{
+				key_state& state_;
+				const size_t number_;
+			public:
+				explicit keyed_sequence_task( key_state& state, const size_t number )
+					: state_( state )
+					, number_( number )
+				{
+				}
+				void operator()()
+				{
+					if ( state_.busy.exchange( true ) )
+						++state_.overlaps;
+					state_.sequence.push_back( number_ );
+					if ( number_ % 16 == 0 )
+						boost::this_thread::yield();
+					state_.busy = false;
+				}
+			};
+			class keyed_counted_task
+			{
+				std::atomic< size_t >& processed_;
+				std::atomic< size_t >& destroyed_;
+			public:
+				explicit keyed_counted_task( std::atomic< size_t >& processed, std::atomic< size_t >& destroyed )
+					: processed_( processed )
+					, destroyed_( destroyed )
+				{
+				}
+				~keyed_counted_task()
+				{
+					++destroyed_;
+				}
+				void operator()()
+				{
+					++processed_;
+				}
+			};
+		}
+		namespace details
+		{
+			template< class T >
+			using small_keyed_queue = lock_free_queue< T, 4 >;
+		}
+		namespace common
+		{
+			void keyed_task_processor_order_tests()
+			{
+				static const size_t keys_size = 100;
+				static const size_t tasks_per_key = 50;
+				std::vector< details::key_state > states( keys_size );
+				{
+					keyed_task_processor< details::keyed_sequence_task, size_t > ktp( 4 );
+					for ( size_t i = 0 ; i < tasks_per_key ; ++i )
+						for ( size_t k = 0 ; k < keys_size ; ++k )
+							BOOST_CHECK_EQUAL( ktp.emplace_task( k, states[ k ], i ), true );
+					ktp.wait();
+					BOOST_CHECK_EQUAL( ktp.active_keys(), 0u );
+					BOOST_CHECK_EQUAL( ktp.size(), 0u );
+				}
+				for ( size_t k = 0 ; k < keys_size ; ++k )
+				{
+					BOOST_CHECK_EQUAL( states[ k ].overlaps.load(), 0u );
+					BOOST_REQUIRE_EQUAL( states[ k ].sequence.size(), tasks_per_key );
+					for ( size_t i = 0 ; i < tasks_per_key ; ++i )
+						BOOST_CHECK_EQUAL( states[ k ].sequence[ i ], i );
+				}
+
+				// string keys, task is created before key is known
+				details::key_state first, second;
+				{
+					keyed_task_processor< details::keyed_sequence_task, std::string, system_utilities::common::details::default_keyed_queue, pool_allocator > ktp( 2, true );
+					for ( size_t i = 0 ; i < 100 ; ++i )
+					{
+						details::keyed_sequence_task* const t = ktp.create_task( i % 2 ? second : first, i );
+						BOOST_CHECK_EQUAL( ktp.add_task( i % 2 ? "second" : "first", t ), true );
+					}
+					ktp.stop();
+					BOOST_CHECK_EQUAL( ktp.emplace_task( "first", first, 100 ), false );
+				}
+				BOOST_CHECK_EQUAL( first.sequence.size(), 50u );
+				BOOST_CHECK_EQUAL( second.sequence.size(), 50u );
+				BOOST_CHECK_EQUAL( second.sequence.back(), 99u );
+			}
+			void keyed_task_processor_stop_tests()
+			{
+				std::atomic< size_t > processed( 0 );
+				std::atomic< size_t > destroyed( 0 );
+				{
+					// no processing threads: lanes are not processed and are freed by destructor
+					keyed_task_processor< details::keyed_counted_task, int > ktp( 0 );
+					for ( int i = 0 ; i < 30 ; ++i )
+						BOOST_CHECK_EQUAL( ktp.emplace_task( i % 3, processed, destroyed ), true );
+					BOOST_CHECK_EQUAL( ktp.active_keys(), 3u );
+					BOOST_CHECK_EQUAL( ktp.size(), 3u );
+				}
+				BOOST_CHECK_EQUAL( processed.load(), 0u );
+				BOOST_CHECK_EQUAL( destroyed.load(), 30u );
+				{
+					keyed_task_processor< details::keyed_counted_task, int > ktp( 2 );
+					for ( int i = 0 ; i < 1000 ; ++i )
+						ktp.emplace_task( i % 7, processed, destroyed );
+				}
+				BOOST_CHECK_EQUAL( destroyed.load(), 1030u );
+				{
+					// heads of lanes in task queue are given back to pool
+					keyed_task_processor< details::keyed_counted_task, int, system_utilities::common::details::default_keyed_queue, pool_allocator > ktp( 0 );
+					for ( int i = 0 ; i < 30 ; ++i )
+						BOOST_CHECK_EQUAL( ktp.emplace_task( i % 3, processed, destroyed ), true );
+					ktp.stop();
+					// tasks are not accepted after stop
+					BOOST_CHECK_EQUAL( ktp.emplace_task( 5, processed, destroyed ), false );
+				}
+				BOOST_CHECK_EQUAL( destroyed.load(), 1061u );
+			}
+			void keyed_task_processor_full_queue_tests()
+			{
+				static const size_t keys_size = 16;
+				static const size_t tasks_per_key = 50;
+				std::vector< details::key_state > states( keys_size );
+				{
+					// one processing thread never waits for free place in full task queue, heads that do not fit are retried
+					keyed_task_processor< details::keyed_sequence_task, size_t, details::small_keyed_queue > ktp( 1 );
+					for ( size_t i = 0 ; i < tasks_per_key ; ++i )
+						for ( size_t k = 0 ; k < keys_size ; ++k )
+							BOOST_CHECK_EQUAL( ktp.emplace_task( k, states[ k ], i ), true );
+					ktp.wait();
+					BOOST_CHECK_EQUAL( ktp.active_keys(), 0u );
+				}
+				for ( size_t k = 0 ; k < keys_size ; ++k )
+				{
+					BOOST_REQUIRE_EQUAL( states[ k ].sequence.size(), tasks_per_key );
+					for ( size_t i = 0 ; i < tasks_per_key ; ++i )
+						BOOST_CHECK_EQUAL( states[ k ].sequence[ i ], i );
+				}
+				std::atomic< size_t > processed( 0 );
+				std::atomic< size_t > destroyed( 0 );
+				{
+					// dropped head of lane does not leave lane that never drains
+					keyed_task_processor< details::keyed_counted_task, int > ktp( 0 );
+					ktp.set_capacity( capacity_settings( 1, overflow_policy::drop_newest ) );
+					BOOST_CHECK_EQUAL( ktp.emplace_task( 1, processed, destroyed ), true );
+					BOOST_CHECK_EQUAL( ktp.emplace_task( 2, processed, destroyed ), true );
+					BOOST_CHECK_EQUAL( ktp.dropped(), 1u );
+					BOOST_CHECK_EQUAL( destroyed.load(), 1u );
+					BOOST_CHECK_EQUAL( ktp.active_keys(), 1u );
+					BOOST_CHECK_EQUAL( ktp.emplace_task( 1, processed, destroyed ), true );
+					BOOST_CHECK_EQUAL( ktp.emplace_task( 2, processed, destroyed ), true );
+					BOOST_CHECK_EQUAL( destroyed.load(), 2u );
+					BOOST_CHECK_EQUAL( ktp.active_keys(), 1u );
+				}
+				BOOST_CHECK_EQUAL( processed.load(), 0u );
+				BOOST_CHECK_EQUAL( destroyed.load(), 4u );
+				{
+					// lanes behind dropped heads go on, all tasks are processed or dropped
+					keyed_task_processor< details::keyed_counted_task, int > ktp( 2 );
+					ktp.set_capacity( capacity_settings( 2, overflow_policy::drop_oldest ) );
+					for ( int i = 0 ; i < 1000 ; ++i )
+						BOOST_CHECK_EQUAL( ktp.emplace_task( i % 5, processed, destroyed ), true );
+					ktp.wait();
+					BOOST_CHECK_EQUAL( ktp.active_keys(), 0u );
+					BOOST_CHECK_EQUAL( processed.load() + ktp.dropped(), 1000u );
+				}
+				BOOST_CHECK_EQUAL( destroyed.load(), 1004u );
+			}
+			void keyed_task_processor_performance_tests()
+			{
+				static const size_t tasks_size = 1000000;
+				static const size_t keys_size = 100000;
+				std::atomic< size_t > processed( 0 );
+				std::atomic< size_t > destroyed( 0 );
+				long long plain_time = 0;
+				{
+					time_tracker< std::chrono::milliseconds > tt;
+					task_processor< details::keyed_counted_task, ts_queue< details::keyed_counted_task >, pool_allocator< details::keyed_counted_task > > tp( 4 );
+					for ( size_t i = 0 ; i < tasks_size ; ++i )
+						tp.emplace_task( processed, destroyed );
+					tp.wait();
+					plain_time = tt.elapsed();
+				}
+				long long keyed_time = 0;
+				{
+					time_tracker< std::chrono::milliseconds > tt;
+					keyed_task_processor< details::keyed_counted_task, size_t, system_utilities::common::details::default_keyed_queue, pool_allocator > ktp( 4 );
+					for ( size_t i = 0 ; i < tasks_size ; ++i )
+						ktp.emplace_task( i % keys_size, processed, destroyed );
+					ktp.wait();
+					keyed_time = tt.elapsed();
+				}
+				BOOST_CHECK_EQUAL( processed.load(), 2 * tasks_size );
+				std::cout << tasks_size << " tasks: task_processor " << plain_time << " ms, keyed_task_processor with " << keys_size << " keys " << keyed_time << " ms" << std::endl;
+			}
+		}
+	}
+}
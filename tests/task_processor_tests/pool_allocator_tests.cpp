@@ -0,0 +1,184 @@
+#include "test_registrator.h"
+
+#include <set>
+#include <vector>
+
+#include <task_processor.h>
+#include <pool_allocator.h>
+#include <lock_free_queue.h>
+
+#include <time_tracker.h>
+
+using namespace system_utilities::common;
+
+namespace system_utilities
+{
+	namespace tests_
+	{
+		namespace details
+		{
+			struct pool_object
+			{
+				size_t value_[ 3 ];
+			};
+			void pool_allocator_free_helper( std::vector< pool_object* >* objects )
+			{
+				pool_allocator< pool_object > allocator;
+				for ( size_t i = 0 ; i < objects->size() ; ++i )
+					allocator.deallocate( objects->at( i ), 1 );
+			}
+			struct pooled_task
+			{
+				std::atomic< size_t >& counter_;
+				explicit pooled_task( std::atomic< size_t >& counter )
+					: counter_( counter )
+				{
+				}
+				void operator()()
+				{
+					++counter_;
+				}
+			};
+			// counted_task: first task blocks processing thread, so the rest stay in queue
+			struct counted_task
+			{
+				std::atomic< size_t >& alive_;
+				const bool blocking_;
+				explicit counted_task( std::atomic< size_t >& alive, const bool blocking = false )
+					: alive_( alive )
+					, blocking_( blocking )
+				{
+					++alive_;
+				}
+				~counted_task()
+				{
+					--alive_;
+				}
+				void operator()()
+				{
+					if ( blocking_ )
+						boost::this_thread::sleep( boost::posix_time::milliseconds( 50 ) );
+				}
+			};
+			template< class queue >
+			void queued_tasks_test_helper()
+			{
+				static const size_t tasks_size = 200;
+				std::atomic< size_t > alive( 0 );
+				{
+					task_processor< counted_task, queue, pool_allocator< counted_task > > tp( 1 );
+					BOOST_CHECK_EQUAL( tp.add_task( tp.create_task( alive, true ) ), true );
+					for ( size_t i = 0 ; i < tasks_size ; ++i )
+						BOOST_CHECK_EQUAL( tp.add_task( tp.create_task( alive ) ), true );
+					BOOST_CHECK_EQUAL( tp.size() > 0, true );
+				}
+				// queued tasks were destroyed and given back to pool
+				BOOST_CHECK_EQUAL( alive.load(), 0u );
+			}
+			template< class allocator, class queue = ts_queue< pooled_task > >
+			struct producers_test_helper
+			{
+				typedef task_processor< pooled_task, queue, allocator > processor;
+				processor processor_;
+				std::atomic< size_t > counter_;
+				const size_t tasks_per_producer_;
+
+				explicit producers_test_helper( const size_t producers, const size_t tasks_per_producer )
+					: processor_( 4, true )
+					, counter_( 0 )
+					, tasks_per_producer_( tasks_per_producer )
+				{
+					boost::thread_group tg;
+					for ( size_t i = 0 ; i < producers ; ++i )
+						tg.create_thread( boost::bind( &producers_test_helper::producer, this ) );
+					tg.join_all();
+					processor_.wait();
+					BOOST_CHECK_EQUAL( counter_.load(), producers * tasks_per_producer );
+				}
+				void producer()
+				{
+					for ( size_t i = 0 ; i < tasks_per_producer_ ; ++i )
+						processor_.add_task( processor_.create_task( counter_ ) );
+				}
+			};
+		}
+		namespace common
+		{
+			void pool_allocator_reuse_tests()
+			{
+				typedef pool_allocator< details::pool_object > allocator;
+				allocator a;
+				// amount of objects is multiple of batch size, so all objects of taken chunks are allocated
+				static const size_t objects_size = 16 * system_utilities::common::details::object_pool< sizeof( details::pool_object ) >::batch_size;
+				std::set< details::pool_object* > allocated;
+				std::vector< details::pool_object* > objects;
+				for ( size_t i = 0 ; i < objects_size ; ++i )
+				{
+					details::pool_object* o = a.allocate( 1 );
+					a.construct( o, details::pool_object() );
+					o->value_[ 0 ] = i;
+					objects.push_back( o );
+					allocated.insert( o );
+				}
+				BOOST_CHECK_EQUAL( allocated.size(), objects_size );
+				for ( size_t i = 0 ; i < objects.size() ; ++i )
+				{
+					BOOST_CHECK_EQUAL( objects[ i ]->value_[ 0 ], i );
+					a.destroy( objects[ i ] );
+					a.deallocate( objects[ i ], 1 );
+				}
+				const size_t chunks = allocator::chunks_allocated();
+				for ( size_t i = 0 ; i < objects_size ; ++i )
+				{
+					objects[ i ] = a.allocate( 1 );
+					BOOST_CHECK_EQUAL( allocated.count( objects[ i ] ), 1u );
+				}
+				BOOST_CHECK_EQUAL( allocator::chunks_allocated(), chunks );
+
+				// objects freed by other thread come back through global pool
+				boost::thread free_thread( boost::bind( &details::pool_allocator_free_helper, &objects ) );
+				free_thread.join();
+				for ( size_t i = 0 ; i < objects_size ; ++i )
+					a.deallocate( a.allocate( 1 ), 1 );
+				BOOST_CHECK_EQUAL( allocator::chunks_allocated(), chunks );
+
+				details::pool_object* array = a.allocate( 10 );
+				a.deallocate( array, 10 );
+			}
+			void pool_allocator_task_processor_tests()
+			{
+				details::producers_test_helper< pool_allocator< details::pooled_task > > helper( 4, 10000 );
+			}
+			void pool_allocator_queued_tasks_tests()
+			{
+				details::queued_tasks_test_helper< ts_queue< details::counted_task > >();
+				details::queued_tasks_test_helper< lock_free_queue< details::counted_task, 1024 > >();
+			}
+			void pool_allocator_performance_tests()
+			{
+				static const size_t producers = 12;
+				static const size_t tasks_per_producer = 200000;
+				// bounded queue keeps amount of tasks in flight limited, so steady state could be reached
+				typedef lock_free_queue< details::pooled_task, 4096 > bounded_queue;
+				long long std_allocator_time = 0;
+				{
+					time_tracker< std::chrono::milliseconds > tt;
+					details::producers_test_helper< std::allocator< details::pooled_task >, bounded_queue > helper( producers, tasks_per_producer );
+					std_allocator_time = tt.elapsed();
+				}
+				long long pool_allocator_time = 0;
+				size_t warm_up_chunks = 0;
+				{
+					details::producers_test_helper< pool_allocator< details::pooled_task >, bounded_queue > warm_up( producers, tasks_per_producer );
+					warm_up_chunks = pool_allocator< details::pooled_task >::chunks_allocated();
+					time_tracker< std::chrono::milliseconds > tt;
+					details::producers_test_helper< pool_allocator< details::pooled_task >, bounded_queue > helper( producers, tasks_per_producer );
+					pool_allocator_time = tt.elapsed();
+				}
+				const size_t steady_state_chunks = pool_allocator< details::pooled_task >::chunks_allocated() - warm_up_chunks;
+				std::cout << producers << " producers, " << producers * tasks_per_producer << " tasks: std::allocator " << std_allocator_time << " ms, "
+					<< "pool_allocator " << pool_allocator_time << " ms (" << warm_up_chunks << " chunks on warm up, " << steady_state_chunks << " chunks after)" << std::endl;
+			}
+		}
+	}
+}
@@ -1,8 +1,15 @@
 #include "test_registrator.h"
 
+#include <algorithm>
+#include <atomic>
+#include <memory>
 #include <vector>
 
 #include <task_processor.h>
+#include <lock_free_queue.h>
+#include <spsc_queue.h>
+#include <ts_priority_queue.h>
+#include <work_stealing_queue.h>
 
 #include <time_tracker.h>
 
@@ -106,7 +113,179 @@ namespace system_utilities
 					return result;
 				}
 			};
-
+			struct latencies
+			{
+				boost::mutex protector_;
+				std::vector< long long > values_;
+			};
+			// latency_task: busy work, if latencies were given - saves time between creation and processing (microseconds)
+			class latency_task
+			{
+				const std::chrono::steady_clock::time_point created_;
+				latencies* const latencies_;
+			public:
+				explicit latency_task()
+					: created_( std::chrono::steady_clock::now() )
+					, latencies_( NULL )
+				{
+				}
+				explicit latency_task( latencies& l )
+					: created_( std::chrono::steady_clock::now() )
+					, latencies_( &l )
+				{
+				}
+				void operator()()
+				{
+					volatile size_t work = 0;
+					for ( size_t i = 0 ; i < 2000 ; ++i )
+						work = work + i;
+					if ( !latencies_ )
+						return;
+					const long long latency = std::chrono::duration_cast< std::chrono::microseconds >( std::chrono::steady_clock::now() - created_ ).count();
+					boost::mutex::scoped_lock lock( latencies_->protector_ );
+					latencies_->values_.push_back( latency );
+				}
+			};
+			typedef task_processor< latency_task > fifo_latency_tp;
+			typedef task_processor< latency_task, ts_priority_queue< latency_task > > priority_latency_tp;
+			bool add_urgent_task( fifo_latency_tp& tp, latency_task* t )
+			{
+				return tp.add_task( t );
+			}
+			bool add_urgent_task( priority_latency_tp& tp, latency_task* t )
+			{
+				return tp.add_task( t, 0 );
+			}
+			// payload_task: takes move-only payload, remembers address of payload buffer to check that it was not copied
+			class payload_task
+			{
+				std::unique_ptr< std::vector< int > > payload_;
+				std::vector< const int* >& buffers_;
+				boost::mutex& protector_;
+			public:
+				explicit payload_task( std::unique_ptr< std::vector< int > >&& payload, std::vector< const int* >& buffers, boost::mutex& protector )
+					: payload_( std::move( payload ) )
+					, buffers_( buffers )
+					, protector_( protector )
+				{
+				}
+				void operator()()
+				{
+					boost::mutex::scoped_lock lock( protector_ );
+					buffers_.push_back( payload_->data() );
+				}
+			};
+			struct sleep_task
+			{
+				std::atomic< size_t >& counter_;
+				explicit sleep_task( std::atomic< size_t >& counter )
+					: counter_( counter )
+				{
+				}
+				void operator()()
+				{
+					boost::this_thread::sleep( boost::posix_time::milliseconds( 1 ) );
+					++counter_;
+				}
+			};
+			template< class tp_type >
+			bool wait_for_threads( const tp_type& tp, const size_t threads, const size_t timeout_ms )
+			{
+				for ( size_t i = 0 ; i < timeout_ms && tp.threads() != threads ; ++i )
+					boost::this_thread::sleep( boost::posix_time::milliseconds( 1 ) );
+				return tp.threads() == threads;
+			}
+			// gate: empty_task with gate blocks processing thread until gate is opened
+			struct gate
+			{
+				std::atomic< bool > opened;
+				std::atomic< size_t > blocked;
+				gate()
+					: opened( false )
+					, blocked( 0 )
+				{
+				}
+			};
+			struct empty_task
+			{
+				gate* gate_;
+				explicit empty_task( gate* g = NULL )
+					: gate_( g )
+				{
+				}
+				void operator()()
+				{
+					if ( !gate_ )
+						return;
+					++gate_->blocked;
+					while ( !gate_->opened.load() )
+						boost::this_thread::yield();
+				}
+			};
+			// returns nanoseconds per task of draining tasks_size queued empty tasks by thread_size threads
+			// tasks are added while all processing threads are blocked, so only processing side (pop, run, destroy, completion tracking) is measured
+			template< class tp_type >
+			double empty_task_drain_test( const size_t thread_size, const size_t tasks_size )
+			{
+				gate g;
+				tp_type tp( thread_size, true );
+				for ( size_t i = 0 ; i < thread_size ; ++i )
+					tp.add_task( tp.create_task( &g ) );
+				while ( g.blocked.load() != thread_size )
+					boost::this_thread::yield();
+				for ( size_t i = 0 ; i < tasks_size ; ++i )
+					tp.add_task( tp.create_task() );
+				time_tracker< std::chrono::nanoseconds > tt;
+				g.opened = true;
+				tp.wait();
+				const double result = static_cast< double >( tt.elapsed() ) / tasks_size;
+				tp.stop();
+				return result;
+			}
+			// the best of repeats runs, to filter out scheduler noise
+			template< class tp_type >
+			double best_empty_task_drain_test( const size_t thread_size, const size_t tasks_size, const size_t repeats )
+			{
+				double result = empty_task_drain_test< tp_type >( thread_size, tasks_size );
+				for ( size_t i = 1 ; i < repeats ; ++i )
+					result = std::min( result, empty_task_drain_test< tp_type >( thread_size, tasks_size ) );
+				return result;
+			}
+			template< class tp_type >
+			long long scaling_test( const size_t thread_size, const size_t tasks_size )
+			{
+				time_tracker< std::chrono::milliseconds > tt;
+				{
+					tp_type tp( thread_size, true );
+					for ( size_t i = 0 ; i < tasks_size ; ++i )
+						tp.add_task( tp.create_task() );
+					tp.stop();
+				}
+				return tt.elapsed();
+			}
+			// urgent tasks are added among bulk tasks, while processing threads are saturated
+			template< class tp_type >
+			void urgent_task_latency_test( const char* name )
+			{
+				static const size_t thread_size = 4;
+				static const size_t bulk_tasks_size = 200000;
+				static const size_t urgent_task_period = 200;
+				latencies l;
+				{
+					tp_type tp( thread_size, true );
+					for ( size_t i = 0 ; i < bulk_tasks_size ; ++i )
+					{
+						tp.add_task( tp.create_task() );
+						if ( i % urgent_task_period == 0 )
+							add_urgent_task( tp, tp.create_task( l ) );
+					}
+					tp.stop();
+				}
+				std::vector< long long >& v = l.values_;
+				std::sort( v.begin(), v.end() );
+				std::cout << name << ": " << v.size() << " urgent tasks latency, us: "
+					<< "p50 " << v[ v.size() / 2 ] << ", p99 " << v[ v.size() * 99 / 100 ] << ", max " << v.back() << std::endl;
+			}
 		}
 		namespace common
 		{
@@ -156,6 +335,264 @@ namespace system_utilities
 				tp.add_task( tp.create_task( c ) );
 				BOOST_CHECK_NO_THROW( tp.wait() );
 				BOOST_CHECK_EQUAL( tp.size(), 0U );
+				BOOST_CHECK_EQUAL( c.count(), 5U );
+			}
+			void task_processor_wait_after_stop_tests()
+			{
+				details::counter c;
+				task_processor< details::task > tp( 1 );
+				for( size_t i = 0 ; i < 1000 ; ++i )
+					tp.add_task( tp.create_task( c ) );
+				tp.stop();
+				BOOST_CHECK_NO_THROW( tp.wait() );
+				const size_t processed = c.count();
+				boost::this_thread::sleep( boost::posix_time::milliseconds( 10 ) );
+				BOOST_CHECK_EQUAL( c.count(), processed );
+			}
+			void task_processor_emplace_task_tests()
+			{
+				std::vector< const int* > buffers;
+				boost::mutex protector;
+				std::vector< const int* > sent;
+				{
+					task_processor< details::payload_task > tp( 2, true );
+					for ( size_t i = 0 ; i < 100 ; ++i )
+					{
+						std::unique_ptr< std::vector< int > > payload( new std::vector< int >( 16, static_cast< int >( i ) ) );
+						sent.push_back( payload->data() );
+						BOOST_CHECK_EQUAL( tp.emplace_task( std::move( payload ), buffers, protector ), true );
+					}
+					tp.wait();
+					tp.stop();
+					std::unique_ptr< std::vector< int > > not_added( new std::vector< int >( 1 ) );
+					BOOST_CHECK_EQUAL( tp.emplace_task( std::move( not_added ), buffers, protector ), false );
+				}
+				std::sort( buffers.begin(), buffers.end() );
+				std::sort( sent.begin(), sent.end() );
+				BOOST_CHECK_EQUAL( buffers == sent, true );
+			}
+			void task_processor_elastic_tests()
+			{
+				typedef task_processor< details::sleep_task > elastic_tp;
+				std::atomic< size_t > counter( 0 );
+				{
+					elastic_tp tp( elastic_settings( 1, 4, std::chrono::milliseconds( 2 ), std::chrono::milliseconds( 30 ) ) );
+					BOOST_CHECK_EQUAL( tp.threads(), 1u );
+					size_t max_threads = 0;
+					for ( size_t i = 0 ; i < 100 ; ++i )
+					{
+						BOOST_CHECK_EQUAL( tp.emplace_task( counter ), true );
+						if ( i % 10 == 0 )
+							boost::this_thread::sleep( boost::posix_time::milliseconds( 1 ) );
+						max_threads = std::max( max_threads, tp.threads() );
+					}
+					tp.wait();
+					BOOST_CHECK_EQUAL( counter.load(), 100u );
+					// tasks waited in queue longer than latency threshold
+					BOOST_CHECK_EQUAL( max_threads > 1, true );
+					BOOST_CHECK_EQUAL( max_threads <= 4, true );
+					BOOST_CHECK_EQUAL( tp.queue_latency().count() > 0, true );
+					// idle threads retire
+					BOOST_CHECK_EQUAL( details::wait_for_threads( tp, 1, 2000 ), true );
+				}
+				{
+					elastic_tp tp( elastic_settings( 0, 2, std::chrono::milliseconds( 1 ), std::chrono::milliseconds( 20 ) ), thread_affinity(), true );
+					BOOST_CHECK_EQUAL( tp.threads(), 0u );
+					tp.resize( 3 );
+					BOOST_CHECK_EQUAL( tp.threads(), 3u );
+					tp.resize( 1 );
+					BOOST_CHECK_EQUAL( details::wait_for_threads( tp, 1, 2000 ), true );
+					for ( size_t i = 0 ; i < 10 ; ++i )
+						tp.emplace_task( counter );
+					tp.resize( 0, 2 );
+				}
+				BOOST_CHECK_EQUAL( counter.load(), 110u );
+				task_processor< details::sleep_task > fixed( 1 );
+				BOOST_CHECK_EQUAL( fixed.threads(), 1u );
+				BOOST_CHECK_THROW( fixed.resize( 2 ), std::logic_error );
+			}
+			void task_processor_capacity_tests()
+			{
+				details::counter c;
+				{
+					// elastic mode without threads: tasks stay in queue until resize
+					task_processor< details::task > tp( elastic_settings( 0, 0 ) );
+					tp.set_capacity( capacity_settings( 4, overflow_policy::drop_oldest ) );
+					for ( size_t i = 0 ; i < 10 ; ++i )
+						BOOST_CHECK_EQUAL( tp.add_task( tp.create_task( c ) ), true );
+					BOOST_CHECK_EQUAL( tp.dropped(), 6u );
+					BOOST_CHECK_EQUAL( tp.size(), 4u );
+					tp.resize( 1 );
+					tp.wait();
+					BOOST_CHECK_EQUAL( c.count(), 4u );
+				}
+				{
+					task_processor< details::task > tp( elastic_settings( 0, 0 ) );
+					tp.set_capacity( capacity_settings( 2, overflow_policy::fail ) );
+					BOOST_CHECK_EQUAL( tp.emplace_task( c ), true );
+					BOOST_CHECK_EQUAL( tp.emplace_task( c ), true );
+					BOOST_CHECK_EQUAL( tp.emplace_task( c ), false );
+					BOOST_CHECK_EQUAL( tp.dropped(), 1u );
+					tp.resize( 1 );
+					tp.wait();
+					BOOST_CHECK_EQUAL( c.count(), 6u );
+					tp.stop();
+					// tasks are not dropped after stop
+					BOOST_CHECK_EQUAL( tp.emplace_task( c ), false );
+					BOOST_CHECK_EQUAL( tp.dropped(), 1u );
+				}
+			}
+			void task_processor_lock_free_queue_tests()
+			{
+				typedef task_processor< details::task, lock_free_queue< details::task, 1024 > > lock_free_tp;
+				details::counter c;
+				static const size_t tasks_size = 10000;
+				{
+					lock_free_tp tp( 4, true );
+					for( size_t i = 0 ; i < tasks_size ; ++i )
+						BOOST_CHECK_EQUAL( tp.add_task( tp.create_task( c ) ), true );
+					tp.wait();
+					BOOST_CHECK_EQUAL( tp.size(), 0U );
+					BOOST_CHECK_EQUAL( c.count(), tasks_size );
+				}
+				BOOST_CHECK_EQUAL( c.count(), tasks_size );
+			}
+			void task_processor_spsc_queue_tests()
+			{
+				typedef task_processor< details::task, spsc_queue< details::task, 1024 > > spsc_tp;
+				details::counter c;
+				static const size_t tasks_size = 10000;
+				{
+					spsc_tp tp( 1, true );
+					for( size_t i = 0 ; i < tasks_size ; ++i )
+						BOOST_CHECK_EQUAL( tp.add_task( tp.create_task( c ) ), true );
+					tp.wait();
+					BOOST_CHECK_EQUAL( tp.size(), 0U );
+					BOOST_CHECK_EQUAL( c.count(), tasks_size );
+				}
+				BOOST_CHECK_EQUAL( c.count(), tasks_size );
+			}
+			void task_processor_batch_tests()
+			{
+				typedef task_processor< details::task, ts_queue< details::task >, std::allocator< details::task >, 16 > batch_tp;
+				details::counter c;
+				static const size_t tasks_size = 10000;
+				{
+					batch_tp tp( 2, true );
+					for( size_t i = 0 ; i < tasks_size ; ++i )
+						BOOST_CHECK_EQUAL( tp.add_task( tp.create_task( c ) ), true );
+					tp.wait();
+					BOOST_CHECK_EQUAL( tp.size(), 0U );
+					BOOST_CHECK_EQUAL( c.count(), tasks_size );
+				}
+				BOOST_CHECK_EQUAL( c.count(), tasks_size );
+			}
+			void task_processor_batch_performance_tests()
+			{
+				static const size_t thread_size = 4;
+				static const size_t tasks_size = 2000000;
+				details::counter c;
+				long long single_time = 0;
+				{
+					time_tracker< std::chrono::milliseconds > tt;
+					task_processor< details::task > tp( thread_size, true );
+					for( size_t i = 0 ; i < tasks_size ; ++i )
+						tp.add_task( tp.create_task( c ) );
+					tp.stop();
+					single_time = tt.elapsed();
+				}
+				long long batch_time = 0;
+				{
+					time_tracker< std::chrono::milliseconds > tt;
+					task_processor< details::task, ts_queue< details::task >, std::allocator< details::task >, 64 > tp( thread_size, true );
+					for( size_t i = 0 ; i < tasks_size ; ++i )
+						tp.add_task( tp.create_task( c ) );
+					tp.stop();
+					batch_time = tt.elapsed();
+				}
+				BOOST_CHECK_EQUAL( c.count(), 2 * tasks_size );
+				std::cout << tasks_size << " tasks: single " << single_time << " ms, batch by 64 " << batch_time << " ms" << std::endl;
+			}
+			void task_processor_priority_queue_tests()
+			{
+				typedef task_processor< details::task, ts_priority_queue< details::task > > priority_tp;
+				details::counter c;
+				static const size_t tasks_size = 10000;
+				{
+					priority_tp tp( 4, true );
+					for( size_t i = 0 ; i < tasks_size ; ++i )
+						BOOST_CHECK_EQUAL( tp.add_task( tp.create_task( c ), i % 8 ), true );
+					tp.wait();
+					BOOST_CHECK_EQUAL( tp.size(), 0U );
+					BOOST_CHECK_EQUAL( c.count(), tasks_size );
+				}
+				BOOST_CHECK_EQUAL( c.count(), tasks_size );
+				{
+					// batch and elastic modes use ts_priority_queue::wait_pop_bulk
+					task_processor< details::task, ts_priority_queue< details::task >, std::allocator< details::task >, 16 > tp( elastic_settings( 1, 2 ) );
+					for( size_t i = 0 ; i < tasks_size ; ++i )
+						BOOST_CHECK_EQUAL( tp.add_task( tp.create_task( c ), i % 8 ), true );
+					tp.wait();
+					BOOST_CHECK_EQUAL( c.count(), 2 * tasks_size );
+				}
+				{
+					priority_tp tp( elastic_settings( 0, 0 ) );
+					tp.set_capacity( capacity_settings( 4, overflow_policy::drop_oldest ) );
+					for ( size_t i = 0 ; i < 10 ; ++i )
+						BOOST_CHECK_EQUAL( tp.add_task( tp.create_task( c ), i % 2 ), true );
+					BOOST_CHECK_EQUAL( tp.dropped(), 6u );
+					BOOST_CHECK_EQUAL( tp.size(), 4u );
+					tp.resize( 1 );
+					tp.wait();
+					BOOST_CHECK_EQUAL( c.count(), 2 * tasks_size + 4 );
+				}
+			}
+			void task_processor_priority_latency_performance_tests()
+			{
+				details::urgent_task_latency_test< details::fifo_latency_tp >( "ts_queue" );
+				details::urgent_task_latency_test< details::priority_latency_tp >( "ts_priority_queue" );
+			}
+			void task_processor_work_stealing_tests()
+			{
+				typedef task_processor< details::task, work_stealing_queue< details::task > > work_stealing_tp;
+				details::counter c;
+				static const size_t tasks_size = 10000;
+				{
+					work_stealing_tp tp( 4, true );
+					for( size_t i = 0 ; i < tasks_size ; ++i )
+						BOOST_CHECK_EQUAL( tp.add_task( tp.create_task( c ) ), true );
+					tp.wait();
+					BOOST_CHECK_EQUAL( tp.size(), 0U );
+					BOOST_CHECK_EQUAL( c.count(), tasks_size );
+				}
+				BOOST_CHECK_EQUAL( c.count(), tasks_size );
+				{
+					work_stealing_tp tp( 4 );
+					tp.add_task( tp.create_task( c ) );
+					tp.stop();
+				}
+			}
+			void task_processor_work_stealing_scaling_performance_tests()
+			{
+				static const size_t tasks_size = 500000;
+				const size_t cores = boost::thread::hardware_concurrency();
+				const size_t max_threads = cores > 8 ? 2 * cores : 16;
+				for ( size_t threads = 1 ; threads <= max_threads ; threads *= 2 )
+				{
+					const long long ts_queue_time = details::scaling_test< details::fifo_latency_tp >( threads, tasks_size );
+					const long long work_stealing_time = details::scaling_test< task_processor< details::latency_task, work_stealing_queue< details::latency_task > > >( threads, tasks_size );
+					std::cout << threads << " threads, " << tasks_size << " tasks: ts_queue " << ts_queue_time << " ms, work stealing " << work_stealing_time << " ms" << std::endl;
+				}
+			}
+			void task_processor_empty_task_overhead_performance_tests()
+			{
+				static const size_t tasks_size = 500000;
+				static const size_t repeats = 10;
+				typedef task_processor< details::empty_task > ts_queue_tp;
+				typedef task_processor< details::empty_task, lock_free_queue< details::empty_task, 1048576 > > lock_free_tp;
+				for ( size_t threads = 1 ; threads <= 4 ; threads *= 2 )
+					std::cout << threads << " threads drain: ts_queue " << details::best_empty_task_drain_test< ts_queue_tp >( threads, tasks_size, repeats )
+						<< " ns, lock_free_queue " << details::best_empty_task_drain_test< lock_free_tp >( threads, tasks_size, repeats ) << " ns per empty task" << std::endl;
 			}
 			void task_processor_own_allocator_performance_tests()
 			{
@@ -0,0 +1,192 @@
+#include "test_registrator.h"
+
+#include <atomic>
+
+#include <task_processor.h>
+#include <pool_allocator.h>
+
+#include <time_tracker.h>
+
+using namespace system_utilities::common;
+
+namespace system_utilities
+{
+	namespace tests_
+	{
+		namespace details
+		{
+			class statistics_task
+			{
+				std::atomic< size_t >& counter_;
+				const size_t sleep_microseconds_;
+			public:
+				explicit statistics_task( std::atomic< size_t >& counter, const size_t sleep_microseconds = 0 )
+					: counter_( counter )
+					, sleep_microseconds_( sleep_microseconds )
+				{
+				}
+				void operator()()
+				{
+					if ( sleep_microseconds_ )
+						boost::this_thread::sleep( boost::posix_time::microseconds( sleep_microseconds_ ) );
+					++counter_;
+				}
+			};
+			// first task blocks processing thread, the rest are destroyed in queue with task_processor
+			template< class allocator >
+			void statistics_queued_tasks_test()
+			{
+				static const size_t tasks_size = 200;
+				std::atomic< size_t > counter( 0 );
+				{
+					task_processor< statistics_task, ts_queue< statistics_task >, allocator, 1, true > tp( 1 );
+					tp.emplace_task( counter, 50000 );
+					for ( size_t i = 0 ; i < tasks_size ; ++i )
+						BOOST_CHECK_EQUAL( tp.emplace_task( counter ), true );
+					BOOST_CHECK_EQUAL( tp.size() > 0, true );
+				}
+				BOOST_CHECK_EQUAL( counter.load() < tasks_size, true );
+				{
+					// slots dropped by overflow policy
+					task_processor< statistics_task, ts_queue< statistics_task >, allocator, 1, true > tp( elastic_settings( 0, 0 ) );
+					tp.set_capacity( capacity_settings( 4, overflow_policy::drop_oldest ) );
+					for ( size_t i = 0 ; i < tasks_size ; ++i )
+						BOOST_CHECK_EQUAL( tp.emplace_task( counter ), true );
+					BOOST_CHECK_EQUAL( tp.dropped(), tasks_size - 4 );
+				}
+			}
+		}
+		namespace common
+		{
+			void task_statistics_histogram_tests()
+			{
+				for ( latency_histogram::value_type i = 0 ; i < latency_histogram::sub_buckets ; ++i )
+				{
+					BOOST_CHECK_EQUAL( latency_histogram::bucket_index( i ), static_cast< size_t >( i ) );
+					BOOST_CHECK_EQUAL( latency_histogram::bucket_lower_bound( i ), i );
+				}
+				BOOST_CHECK_EQUAL( latency_histogram::bucket_index( 16 ), 16u );
+				BOOST_CHECK_EQUAL( latency_histogram::bucket_index( 31 ), 31u );
+				BOOST_CHECK_EQUAL( latency_histogram::bucket_index( 32 ), 32u );
+				BOOST_CHECK_EQUAL( latency_histogram::bucket_index( 33 ), 32u );
+				BOOST_CHECK_EQUAL( latency_histogram::bucket_index( 34 ), 33u );
+				BOOST_CHECK_EQUAL( latency_histogram::bucket_index( ~0ull ), latency_histogram::buckets_size - 1 );
+				for ( size_t i = 0 ; i + 1 < latency_histogram::buckets_size ; ++i )
+				{
+					const latency_histogram::value_type lower = latency_histogram::bucket_lower_bound( i );
+					const latency_histogram::value_type upper = latency_histogram::bucket_upper_bound( i );
+					BOOST_CHECK_EQUAL( latency_histogram::bucket_index( lower ), i );
+					BOOST_CHECK_EQUAL( latency_histogram::bucket_index( upper ), i );
+					BOOST_CHECK_EQUAL( latency_histogram::bucket_lower_bound( i + 1 ), upper + 1 );
+					// relative error is not greater than 1 / sub_buckets
+					BOOST_CHECK( ( upper - lower ) * latency_histogram::sub_buckets <= lower || lower < latency_histogram::sub_buckets );
+				}
+
+				latency_histogram h;
+				BOOST_CHECK_EQUAL( h.percentile( 50.0 ), 0u );
+				for ( latency_histogram::value_type i = 1 ; i <= 1000 ; ++i )
+					h.record( i * 1000 );
+				BOOST_CHECK_EQUAL( h.count(), 1000u );
+				BOOST_CHECK_EQUAL( h.max(), 1000000u );
+				BOOST_CHECK_EQUAL( h.mean(), 500500u );
+				const latency_histogram::value_type p50 = h.percentile( 50.0 );
+				BOOST_CHECK( p50 >= 500000 && p50 <= 500000 + 500000 / latency_histogram::sub_buckets );
+				const latency_histogram::value_type p99 = h.percentile( 99.0 );
+				BOOST_CHECK( p99 >= 990000 && p99 <= 1000000 );
+				BOOST_CHECK_EQUAL( h.percentile( 100.0 ), 1000000u );
+
+				latency_histogram other;
+				other.record( 5000000, 10 );
+				h.merge( other );
+				BOOST_CHECK_EQUAL( h.count(), 1010u );
+				BOOST_CHECK_EQUAL( h.max(), 5000000u );
+				BOOST_CHECK_EQUAL( h.bucket_count( latency_histogram::bucket_index( 5000000 ) ), 10u );
+			}
+			void task_statistics_task_processor_tests()
+			{
+				static const size_t tasks_size = 100;
+				{
+					std::atomic< size_t > counter( 0 );
+					task_processor< details::statistics_task, ts_queue< details::statistics_task >, std::allocator< details::statistics_task >, 1, true > tp( 2 );
+					for ( size_t i = 0 ; i < tasks_size ; ++i )
+						tp.add_task( tp.create_task( counter, i % 10 == 0 ? 1000 : 0 ) );
+					tp.wait();
+					const task_processor_stats stats = tp.stats();
+					BOOST_CHECK_EQUAL( stats.submitted, tasks_size );
+					BOOST_CHECK_EQUAL( stats.completed, tasks_size );
+					BOOST_CHECK_EQUAL( stats.rejected, 0u );
+					BOOST_CHECK_EQUAL( stats.queue_latency.count(), tasks_size );
+					BOOST_CHECK_EQUAL( stats.execution_time.count(), tasks_size );
+					// 10 tasks sleep 1 millisecond
+					BOOST_CHECK( stats.execution_time.max() >= 1000000 );
+					BOOST_CHECK( stats.execution_time.percentile( 50.0 ) < 1000000 );
+					BOOST_CHECK( stats.to_string().find( "completed 100" ) != std::string::npos );
+				}
+				{
+					std::atomic< size_t > counter( 0 );
+					task_processor< details::statistics_task, ts_queue< details::statistics_task >, pool_allocator< details::statistics_task >, 8, true > tp( 2, true );
+					for ( size_t i = 0 ; i < tasks_size ; ++i )
+						tp.emplace_task( counter );
+					tp.wait();
+					tp.stop();
+					BOOST_CHECK_EQUAL( counter.load(), tasks_size );
+					BOOST_CHECK_EQUAL( tp.stats().completed, tasks_size );
+					BOOST_CHECK_EQUAL( tp.emplace_task( counter ), false );
+					BOOST_CHECK_EQUAL( tp.stats().rejected, 1u );
+					BOOST_CHECK_EQUAL( tp.stats().submitted, tasks_size );
+				}
+				{
+					std::atomic< size_t > counter( 0 );
+					task_processor< details::statistics_task, ts_queue< details::statistics_task >, std::allocator< details::statistics_task >, 4, true > tp( elastic_settings( 1, 2 ) );
+					for ( size_t i = 0 ; i < tasks_size ; ++i )
+						tp.emplace_task( counter );
+					tp.wait();
+					BOOST_CHECK_EQUAL( tp.stats().completed, tasks_size );
+				}
+				{
+					// statistics are turned off
+					std::atomic< size_t > counter( 0 );
+					task_processor< details::statistics_task > tp( 1 );
+					tp.emplace_task( counter );
+					tp.wait();
+					BOOST_CHECK_EQUAL( tp.stats().completed, 0u );
+					BOOST_CHECK_EQUAL( tp.stats().execution_time.count(), 0u );
+				}
+			}
+			void task_statistics_queued_tasks_tests()
+			{
+				details::statistics_queued_tasks_test< std::allocator< details::statistics_task > >();
+				details::statistics_queued_tasks_test< pool_allocator< details::statistics_task > >();
+			}
+			void task_statistics_overhead_performance_tests()
+			{
+				static const size_t tasks_size = 1000000;
+				long long plain_time = 0;
+				{
+					std::atomic< size_t > counter( 0 );
+					time_tracker< std::chrono::milliseconds > tt;
+					task_processor< details::statistics_task, ts_queue< details::statistics_task >, pool_allocator< details::statistics_task > > tp( 2 );
+					for ( size_t i = 0 ; i < tasks_size ; ++i )
+						tp.emplace_task( counter );
+					tp.wait();
+					plain_time = tt.elapsed();
+				}
+				long long statistics_time = 0;
+				task_processor_stats stats;
+				{
+					std::atomic< size_t > counter( 0 );
+					time_tracker< std::chrono::milliseconds > tt;
+					task_processor< details::statistics_task, ts_queue< details::statistics_task >, pool_allocator< details::statistics_task >, 1, true > tp( 2 );
+					for ( size_t i = 0 ; i < tasks_size ; ++i )
+						tp.emplace_task( counter );
+					tp.wait();
+					statistics_time = tt.elapsed();
+					stats = tp.stats();
+				}
+				BOOST_CHECK_EQUAL( stats.completed, tasks_size );
+				std::cout << tasks_size << " tasks: without statistics " << plain_time << " ms, with statistics " << statistics_time << " ms" << std::endl;
+				std::cout << stats.to_string() << std::endl;
+			}
+		}
+	}
+}
@@ -10,10 +10,44 @@ TEST_INIT
 	master_test_suite.add( BOOST_TEST_CASE( &task_processor_constructor_tests ) );
 	master_test_suite.add( BOOST_TEST_CASE( &task_processor_add_task_tests ) );
 	master_test_suite.add( BOOST_TEST_CASE( &task_processor_wait_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &task_processor_wait_after_stop_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &task_processor_emplace_task_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &task_processor_elastic_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &task_processor_capacity_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &task_processor_lock_free_queue_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &task_processor_spsc_queue_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &task_processor_batch_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &task_processor_priority_queue_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &task_processor_work_stealing_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &pool_allocator_reuse_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &pool_allocator_task_processor_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &pool_allocator_queued_tasks_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &future_submit_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &future_exception_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &future_broken_task_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &future_submit_create_task_failure_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &future_when_all_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &thread_affinity_from_string_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &thread_affinity_policies_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &thread_affinity_task_processor_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &task_statistics_histogram_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &task_statistics_task_processor_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &task_statistics_queued_tasks_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &keyed_task_processor_order_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &keyed_task_processor_stop_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &keyed_task_processor_full_queue_tests ) );
 
 #ifdef RUN_PERFORMANCE_TESTS
 	master_test_suite.add( BOOST_TEST_CASE( &task_processor_add_task_performace_tests ) );
 	master_test_suite.add( BOOST_TEST_CASE( &task_processor_own_allocator_performance_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &task_processor_batch_performance_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &task_processor_priority_latency_performance_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &task_processor_work_stealing_scaling_performance_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &task_processor_empty_task_overhead_performance_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &pool_allocator_performance_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &future_submit_performance_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &task_statistics_overhead_performance_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &keyed_task_processor_performance_tests ) );
 #endif 
 
 	return TEST_RETURN;
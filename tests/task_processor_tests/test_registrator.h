@@ -11,7 +11,46 @@ namespace system_utilities
 			void task_processor_add_task_tests();
 			void task_processor_add_task_performace_tests();
 			void task_processor_wait_tests();
+			void task_processor_wait_after_stop_tests();
+			void task_processor_emplace_task_tests();
+			void task_processor_elastic_tests();
+			void task_processor_capacity_tests();
+			void task_processor_lock_free_queue_tests();
+			void task_processor_spsc_queue_tests();
+			void task_processor_batch_tests();
+			void task_processor_batch_performance_tests();
+			void task_processor_priority_queue_tests();
+			void task_processor_priority_latency_performance_tests();
+			void task_processor_work_stealing_tests();
+			void task_processor_work_stealing_scaling_performance_tests();
+			void task_processor_empty_task_overhead_performance_tests();
 			void task_processor_own_allocator_performance_tests();
+
+			void pool_allocator_reuse_tests();
+			void pool_allocator_task_processor_tests();
+			void pool_allocator_queued_tasks_tests();
+			void pool_allocator_performance_tests();
+
+			void future_submit_tests();
+			void future_exception_tests();
+			void future_broken_task_tests();
+			void future_submit_create_task_failure_tests();
+			void future_when_all_tests();
+			void future_submit_performance_tests();
+
+			void thread_affinity_from_string_tests();
+			void thread_affinity_policies_tests();
+			void thread_affinity_task_processor_tests();
+
+			void task_statistics_histogram_tests();
+			void task_statistics_task_processor_tests();
+			void task_statistics_queued_tasks_tests();
+			void task_statistics_overhead_performance_tests();
+
+			void keyed_task_processor_order_tests();
+			void keyed_task_processor_stop_tests();
+			void keyed_task_processor_full_queue_tests();
+			void keyed_task_processor_performance_tests();
 		}
 	}
 }
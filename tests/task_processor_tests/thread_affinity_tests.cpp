@@ -0,0 +1,136 @@
+#include "test_registrator.h"
+
+#include <set>
+#include <stdexcept>
+
+#include <task_processor.h>
+#include <thread_affinity.h>
+
+#ifdef _LINUX
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace system_utilities::common;
+
+namespace system_utilities
+{
+	namespace tests_
+	{
+		namespace details
+		{
+			// affinity_task: remembers cpus that processing thread is allowed to run on
+			class affinity_task
+			{
+				std::set< std::set< size_t > >& masks_;
+				boost::mutex& protector_;
+			public:
+				explicit affinity_task( std::set< std::set< size_t > >& masks, boost::mutex& protector )
+					: masks_( masks )
+					, protector_( protector )
+				{
+				}
+				void operator()()
+				{
+					std::set< size_t > mask;
+#ifdef _LINUX
+					cpu_set_t cpu_set;
+					CPU_ZERO( &cpu_set );
+					pthread_getaffinity_np( pthread_self(), sizeof( cpu_set ), &cpu_set );
+					for ( size_t i = 0 ; i < CPU_SETSIZE ; ++i )
+						if ( CPU_ISSET( i, &cpu_set ) )
+							mask.insert( i );
+#endif
+					boost::mutex::scoped_lock lock( protector_ );
+					masks_.insert( mask );
+				}
+			};
+		}
+		namespace common
+		{
+			void thread_affinity_from_string_tests()
+			{
+				BOOST_CHECK_EQUAL( thread_affinity().policy(), affinity_policy::none );
+				BOOST_CHECK_EQUAL( thread_affinity::from_string( "" ).policy(), affinity_policy::none );
+				BOOST_CHECK_EQUAL( thread_affinity::from_string( "None" ).policy(), affinity_policy::none );
+				BOOST_CHECK_EQUAL( thread_affinity::from_string( " compact " ).policy(), affinity_policy::compact );
+				BOOST_CHECK_EQUAL( thread_affinity::from_string( "scatter" ).policy(), affinity_policy::scatter );
+				BOOST_CHECK_EQUAL( thread_affinity::from_string( "numa_node" ).policy(), affinity_policy::numa_node );
+
+				const thread_affinity list = thread_affinity::from_string( "0, 2, 4-6" );
+				BOOST_CHECK_EQUAL( list.policy(), affinity_policy::cpu_list );
+				static const size_t expected[] = { 0, 2, 4, 5, 6, 0 };
+				for ( size_t i = 0 ; i < sizeof( expected ) / sizeof( expected[ 0 ] ) ; ++i )
+				{
+					const thread_affinity::cpus cpus = list.worker_cpus( i );
+					BOOST_CHECK_EQUAL( cpus.size(), 1u );
+					BOOST_CHECK_EQUAL( cpus.at( 0 ), expected[ i ] );
+				}
+				BOOST_CHECK_THROW( thread_affinity::from_string( "somewhere" ), std::logic_error );
+				BOOST_CHECK_THROW( thread_affinity::from_string( "3-1" ), std::logic_error );
+				BOOST_CHECK_THROW( thread_affinity::from_string( "1-2-3" ), std::logic_error );
+				BOOST_CHECK_THROW( thread_affinity( affinity_policy::cpu_list ), std::logic_error );
+				BOOST_CHECK_THROW( thread_affinity( thread_affinity::cpus() ), std::logic_error );
+			}
+			void thread_affinity_policies_tests()
+			{
+				const system_utilities::common::details::cpu_infos& system = system_utilities::common::details::system_cpus();
+				BOOST_CHECK_EQUAL( system.empty(), false );
+				std::set< size_t > online;
+				std::set< size_t > nodes;
+				for ( size_t i = 0 ; i < system.size() ; ++i )
+				{
+					online.insert( system[ i ].cpu );
+					nodes.insert( system[ i ].node );
+				}
+				BOOST_CHECK_EQUAL( thread_affinity().worker_cpus( 0 ).empty(), true );
+
+				const thread_affinity compact( affinity_policy::compact );
+				const thread_affinity scatter( affinity_policy::scatter );
+				const thread_affinity numa_node( affinity_policy::numa_node );
+				std::set< size_t > compact_cpus;
+				std::set< size_t > scatter_cpus;
+				for ( size_t i = 0 ; i < system.size() ; ++i )
+				{
+					BOOST_CHECK_EQUAL( compact.worker_cpus( i ).size(), 1u );
+					BOOST_CHECK_EQUAL( scatter.worker_cpus( i ).size(), 1u );
+					compact_cpus.insert( compact.worker_cpus( i ).at( 0 ) );
+					scatter_cpus.insert( scatter.worker_cpus( i ).at( 0 ) );
+				}
+				// every cpu is used once by first system.size() workers
+				BOOST_CHECK_EQUAL( compact_cpus == online, true );
+				BOOST_CHECK_EQUAL( scatter_cpus == online, true );
+				BOOST_CHECK_EQUAL( compact.worker_cpus( 0 ).at( 0 ), system.front().cpu );
+
+				size_t node_cpus = 0;
+				for ( size_t i = 0 ; i < nodes.size() ; ++i )
+					node_cpus += numa_node.worker_cpus( i ).size();
+				BOOST_CHECK_EQUAL( node_cpus, system.size() );
+			}
+			void thread_affinity_task_processor_tests()
+			{
+				const system_utilities::common::details::cpu_infos& system = system_utilities::common::details::system_cpus();
+				std::set< std::set< size_t > > masks;
+				boost::mutex protector;
+				{
+					task_processor< details::affinity_task > tp( 2, thread_affinity( affinity_policy::compact ), true );
+					for ( size_t i = 0 ; i < 1000 ; ++i )
+						BOOST_CHECK_EQUAL( tp.emplace_task( masks, protector ), true );
+					tp.wait();
+				}
+#ifdef _LINUX
+				std::set< std::set< size_t > > expected;
+				for ( size_t i = 0 ; i < 2 ; ++i )
+				{
+					std::set< size_t > mask;
+					mask.insert( system[ i % system.size() ].cpu );
+					expected.insert( mask );
+				}
+				// each task was processed by pinned worker
+				for ( std::set< std::set< size_t > >::const_iterator i = masks.begin() ; i != masks.end() ; ++i )
+					BOOST_CHECK_EQUAL( expected.count( *i ), 1u );
+#endif
+			}
+		}
+	}
+}
@@ -0,0 +1,177 @@
+#include "test_registrator.h"
+
+#include <vector>
+
+#include <ts_queue.h>
+#include <lock_free_queue.h>
+#include <time_tracker.h>
+
+#include <boost/thread.hpp>
+
+using namespace system_utilities::common;
+
+namespace system_utilities
+{
+	namespace tests_
+	{
+		namespace common
+		{
+			namespace details
+			{
+				typedef lock_free_queue< size_t, 1024 > lock_free_queue_size_t;
+
+				void lock_free_queue_different_threads_pop_thread_helper( lock_free_queue_size_t* mq, const size_t test_size )
+				{
+					size_t i = 0;
+					while ( i < test_size )
+					{
+						size_t* s = mq->wait_pop();
+						BOOST_CHECK_EQUAL( i, *s );
+						delete s;
+						i++;
+					}
+					BOOST_CHECK_EQUAL( i, test_size );
+				}
+				void lock_free_queue_stop_test_helper( lock_free_queue_size_t* mq, size_t** result )
+				{
+					*result = mq->wait_pop();
+				}
+
+				template< class queue >
+				struct queue_throughput_test_helper
+				{
+					queue queue_;
+					std::vector< size_t > values_;
+					boost::mutex summ_protector_;
+					size_t summ_;
+
+					explicit queue_throughput_test_helper( const size_t producers, const size_t consumers, const size_t elements_per_producer )
+						: values_( elements_per_producer )
+						, summ_( 0 )
+					{
+						for ( size_t i = 0 ; i < elements_per_producer ; ++i )
+							values_[ i ] = i;
+						boost::thread_group tg_push, tg_pop;
+						for ( size_t i = 0 ; i < consumers ; ++i )
+							tg_pop.create_thread( boost::bind( &queue_throughput_test_helper::poper, this ) );
+						for ( size_t i = 0 ; i < producers ; ++i )
+							tg_push.create_thread( boost::bind( &queue_throughput_test_helper::pusher, this ) );
+						tg_push.join_all();
+						queue_.wait();
+						queue_.stop();
+						tg_pop.join_all();
+						BOOST_CHECK_EQUAL( summ_, producers * ( elements_per_producer * ( elements_per_producer - 1 ) / 2 ) );
+					}
+					void pusher()
+					{
+						for ( size_t i = 0 ; i < values_.size() ; ++i )
+							queue_.push( &values_[ i ] );
+					}
+					void poper()
+					{
+						size_t summ = 0;
+						while ( size_t* s = queue_.wait_pop() )
+							summ += *s;
+						boost::mutex::scoped_lock lock( summ_protector_ );
+						summ_ += summ;
+					}
+				};
+				template< class queue >
+				long long queue_throughput_test( const size_t threads, const size_t elements_per_producer )
+				{
+					time_tracker< std::chrono::milliseconds > tt;
+					queue_throughput_test_helper< queue > helper( threads, threads, elements_per_producer );
+					return tt.elapsed();
+				}
+			}
+			void lock_free_queue_constructor_tests()
+			{
+				BOOST_CHECK_NO_THROW( ( lock_free_queue< int >() ) );
+				lock_free_queue< size_t, 16 > mq;
+				BOOST_CHECK_EQUAL( mq.empty(), true );
+				for ( size_t i = 1 ; i < 10 ; ++i )
+					mq.push( new size_t( i ) );
+				BOOST_CHECK_EQUAL( mq.size(), 9u );
+				size_t* s = mq.pop();
+				BOOST_CHECK_EQUAL( *s, 1u );
+				delete s;
+				for ( size_t i = 10 ; i < 14 ; ++i )
+					mq.push( new size_t( i ) );
+				size_t i = 2;
+				while ( !mq.empty() )
+				{
+					size_t* s = mq.ts_pop();
+					BOOST_CHECK_EQUAL( *s, i++ );
+					delete s;
+				}
+				BOOST_CHECK_EQUAL( i, 14u );
+				BOOST_CHECK_EQUAL( mq.pop() == NULL, true );
+			}
+			void lock_free_queue_different_threads_tests()
+			{
+				details::lock_free_queue_size_t mq;
+				const size_t test_size = 200000;
+				boost::thread pop( boost::bind( &details::lock_free_queue_different_threads_pop_thread_helper, &mq, test_size ) );
+				for ( size_t i = 0 ; i < test_size ; ++i )
+					BOOST_CHECK_EQUAL( mq.push( new size_t( i ) ), true );
+				pop.join();
+				BOOST_CHECK_EQUAL( mq.empty(), true );
+			}
+			void lock_free_queue_stop_tests()
+			{
+				details::lock_free_queue_size_t mq;
+				size_t not_poped = 0;
+				size_t* result = &not_poped;
+				boost::thread pop( boost::bind( &details::lock_free_queue_stop_test_helper, &mq, &result ) );
+				boost::this_thread::sleep( boost::posix_time::milliseconds( 50 ) );
+				mq.stop();
+				pop.join();
+				BOOST_CHECK_EQUAL( result == NULL, true );
+				size_t* const rejected = new size_t( 1 );
+				BOOST_CHECK_EQUAL( mq.push( rejected ), false );
+				delete rejected;
+				BOOST_CHECK_NO_THROW( mq.wait() );
+
+				mq.restart();
+				BOOST_CHECK_EQUAL( mq.push( new size_t( 1 ) ), true );
+				BOOST_CHECK_EQUAL( mq.ts_size(), 1u );
+				mq.stop_processing();
+				BOOST_CHECK_EQUAL( mq.ts_size(), 0u );
+			}
+			void lock_free_queue_bulk_tests()
+			{
+				lock_free_queue< size_t, 8 > mq;
+				size_t* range[ 6 ];
+				for ( size_t i = 0 ; i < 6 ; ++i )
+					range[ i ] = new size_t( i );
+				BOOST_CHECK_EQUAL( mq.push_range( range, range + 6 ), 6u );
+				size_t* elements[ 4 ];
+				BOOST_CHECK_EQUAL( mq.wait_pop_bulk( elements, 4 ), 4u );
+				for ( size_t i = 0 ; i < 4 ; ++i )
+				{
+					BOOST_CHECK_EQUAL( *elements[ i ], i );
+					delete elements[ i ];
+				}
+				BOOST_CHECK_EQUAL( mq.wait_pop_bulk( elements, 4, std::chrono::milliseconds( 10 ) ), 2u );
+				delete elements[ 0 ];
+				delete elements[ 1 ];
+				BOOST_CHECK_EQUAL( mq.wait_pop_bulk( elements, 4, std::chrono::milliseconds( 10 ) ), 0u );
+			}
+			void lock_free_queue_many_threads_tests()
+			{
+				details::queue_throughput_test_helper< lock_free_queue< size_t, 64 > > helper( 8, 4, 100000 );
+			}
+			void lock_free_queue_vs_ts_queue_performance_tests()
+			{
+				static const size_t elements_per_producer = 100000;
+				for ( size_t threads = 1 ; threads <= 32 ; threads *= 2 )
+				{
+					const long long ts_queue_time = details::queue_throughput_test< ts_queue< size_t > >( threads, elements_per_producer );
+					const long long lock_free_queue_time = details::queue_throughput_test< lock_free_queue< size_t > >( threads, elements_per_producer );
+					std::cout << threads << " producers / " << threads << " consumers, " << threads * elements_per_producer << " elements: "
+						<< "ts_queue " << ts_queue_time << " ms, lock_free_queue " << lock_free_queue_time << " ms" << std::endl;
+				}
+			}
+		}
+	}
+}
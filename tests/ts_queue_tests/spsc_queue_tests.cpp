@@ -0,0 +1,159 @@
+#include "test_registrator.h"
+
+#include <ts_queue.h>
+#include <spsc_queue.h>
+#include <time_tracker.h>
+
+#include <boost/thread.hpp>
+
+using namespace system_utilities::common;
+
+namespace system_utilities
+{
+	namespace tests_
+	{
+		namespace common
+		{
+			namespace details
+			{
+				typedef spsc_queue< size_t, 16 > spsc_queue_size_t;
+
+				template< class queue >
+				void spsc_queue_pop_thread_helper( queue* mq, const size_t test_size )
+				{
+					size_t i = 0;
+					while ( i < test_size )
+					{
+						size_t* s = mq->wait_pop();
+						if ( !s )
+							break;
+						BOOST_CHECK_EQUAL( i, *s );
+						delete s;
+						i++;
+					}
+					BOOST_CHECK_EQUAL( i, test_size );
+				}
+				void spsc_queue_stop_test_helper( spsc_queue_size_t* mq, size_t** result )
+				{
+					*result = mq->wait_pop();
+				}
+				// pong thread returns every message back, both threads park on empty queue after every message
+				void spsc_queue_pong_thread_helper( spsc_queue_size_t* ping, spsc_queue_size_t* pong )
+				{
+					while ( size_t* s = ping->wait_pop() )
+						pong->push( s );
+				}
+				template< class queue >
+				long long spsc_queue_throughput_test( const size_t test_size )
+				{
+					time_tracker< std::chrono::milliseconds > tt;
+					queue mq;
+					boost::thread pop( boost::bind( &spsc_queue_pop_thread_helper< queue >, &mq, test_size ) );
+					for ( size_t i = 0 ; i < test_size ; ++i )
+						mq.push( new size_t( i ) );
+					pop.join();
+					return tt.elapsed();
+				}
+			}
+			void spsc_queue_constructor_tests()
+			{
+				BOOST_CHECK_NO_THROW( ( spsc_queue< int >() ) );
+				details::spsc_queue_size_t mq;
+				BOOST_CHECK_EQUAL( mq.empty(), true );
+				for ( size_t i = 1 ; i < 10 ; ++i )
+					mq.push( new size_t( i ) );
+				BOOST_CHECK_EQUAL( mq.size(), 9u );
+				size_t* s = mq.pop();
+				BOOST_CHECK_EQUAL( *s, 1u );
+				delete s;
+				for ( size_t i = 10 ; i < 14 ; ++i )
+					mq.push( new size_t( i ) );
+				size_t i = 2;
+				while ( !mq.empty() )
+				{
+					size_t* s = mq.ts_pop();
+					BOOST_CHECK_EQUAL( *s, i++ );
+					delete s;
+				}
+				BOOST_CHECK_EQUAL( i, 14u );
+				BOOST_CHECK_EQUAL( mq.pop() == NULL, true );
+			}
+			void spsc_queue_different_threads_tests()
+			{
+				details::spsc_queue_size_t mq;
+				const size_t test_size = 200000;
+				boost::thread pop( boost::bind( &details::spsc_queue_pop_thread_helper< details::spsc_queue_size_t >, &mq, test_size ) );
+				for ( size_t i = 0 ; i < test_size ; ++i )
+					BOOST_CHECK_EQUAL( mq.push( new size_t( i ) ), true );
+				mq.wait();
+				pop.join();
+				BOOST_CHECK_EQUAL( mq.empty(), true );
+			}
+			void spsc_queue_stop_tests()
+			{
+				details::spsc_queue_size_t mq;
+				size_t not_poped = 0;
+				size_t* result = &not_poped;
+				boost::thread pop( boost::bind( &details::spsc_queue_stop_test_helper, &mq, &result ) );
+				boost::this_thread::sleep( boost::posix_time::milliseconds( 50 ) );
+				mq.stop();
+				pop.join();
+				BOOST_CHECK_EQUAL( result == NULL, true );
+				size_t* const rejected = new size_t( 1 );
+				BOOST_CHECK_EQUAL( mq.push( rejected ), false );
+				delete rejected;
+				BOOST_CHECK_NO_THROW( mq.wait() );
+
+				mq.restart();
+				BOOST_CHECK_EQUAL( mq.push( new size_t( 1 ) ), true );
+				BOOST_CHECK_EQUAL( mq.ts_size(), 1u );
+				mq.stop_processing();
+				BOOST_CHECK_EQUAL( mq.ts_size(), 0u );
+			}
+			void spsc_queue_ping_pong_tests()
+			{
+				// parked thread is woken up by every push, lost wake up would hang the test
+				static const size_t round_trips = 5000;
+				details::spsc_queue_size_t ping, pong;
+				boost::thread pong_thread( boost::bind( &details::spsc_queue_pong_thread_helper, &ping, &pong ) );
+				for ( size_t i = 0 ; i < round_trips ; ++i )
+				{
+					BOOST_CHECK_EQUAL( ping.push( new size_t( i ) ), true );
+					size_t* const s = pong.wait_pop();
+					BOOST_REQUIRE( s != NULL );
+					BOOST_CHECK_EQUAL( *s, i );
+					delete s;
+				}
+				ping.stop();
+				pong_thread.join();
+			}
+			void spsc_queue_bulk_tests()
+			{
+				details::spsc_queue_size_t mq;
+				size_t* range[ 6 ];
+				for ( size_t i = 0 ; i < 6 ; ++i )
+					range[ i ] = new size_t( i );
+				BOOST_CHECK_EQUAL( mq.push_range( range, range + 6 ), 6u );
+				size_t* elements[ 4 ];
+				BOOST_CHECK_EQUAL( mq.wait_pop_bulk( elements, 4 ), 4u );
+				for ( size_t i = 0 ; i < 4 ; ++i )
+				{
+					BOOST_CHECK_EQUAL( *elements[ i ], i );
+					delete elements[ i ];
+				}
+				BOOST_CHECK_EQUAL( mq.wait_pop_bulk( elements, 4, std::chrono::milliseconds( 10 ) ), 2u );
+				delete elements[ 0 ];
+				delete elements[ 1 ];
+				BOOST_CHECK_EQUAL( mq.wait_pop_bulk( elements, 4, std::chrono::milliseconds( 10 ) ), 0u );
+			}
+			void spsc_queue_vs_ts_queue_performance_tests()
+			{
+				static const size_t test_size = 2000000;
+				const long long ts_queue_time = details::spsc_queue_throughput_test< ts_queue< size_t > >( test_size );
+				const long long spsc_queue_time = details::spsc_queue_throughput_test< spsc_queue< size_t > >( test_size );
+				std::cout << "1 producer / 1 consumer, " << test_size << " elements: "
+					<< "ts_queue " << ts_queue_time << " ms, spsc_queue " << spsc_queue_time << " ms" << std::endl;
+			}
+		}
+	}
+}
@@ -11,9 +11,42 @@ TEST_INIT
 	master_test_suite.add( BOOST_TEST_CASE( &ts_queue_different_threads_tests ) );
 	master_test_suite.add( BOOST_TEST_CASE( &ts_queue_wait_pop_tests ) );
 	master_test_suite.add( BOOST_TEST_CASE( &ts_queue_another_container_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &ts_queue_push_range_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &ts_queue_wait_pop_bulk_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &ts_queue_wait_pop_for_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &ts_queue_wait_for_empty_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &ts_queue_spin_wait_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &ts_queue_capacity_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &lock_free_queue_constructor_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &lock_free_queue_different_threads_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &lock_free_queue_stop_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &lock_free_queue_bulk_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &lock_free_queue_many_threads_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &spsc_queue_constructor_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &spsc_queue_different_threads_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &spsc_queue_stop_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &spsc_queue_ping_pong_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &spsc_queue_bulk_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &ts_value_queue_constructor_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &ts_value_queue_move_only_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &ts_value_queue_stop_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &ts_value_queue_different_threads_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &ts_priority_queue_constructor_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &ts_priority_queue_aging_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &ts_priority_queue_stop_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &ts_priority_queue_bulk_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &ts_priority_queue_capacity_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &work_stealing_queue_constructor_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &work_stealing_queue_worker_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &work_stealing_queue_stop_tests ) );
+	master_test_suite.add( BOOST_TEST_CASE( &work_stealing_queue_many_threads_tests ) );
 
 #ifdef RUN_PERFORMANCE_TESTS
 		master_test_suite.add( BOOST_TEST_CASE( &ts_queue_many_threads_tests ) );
+		master_test_suite.add( BOOST_TEST_CASE( &lock_free_queue_vs_ts_queue_performance_tests ) );
+		master_test_suite.add( BOOST_TEST_CASE( &spsc_queue_vs_ts_queue_performance_tests ) );
+		master_test_suite.add( BOOST_TEST_CASE( &ts_queue_spin_wait_performance_tests ) );
+		master_test_suite.add( BOOST_TEST_CASE( &ts_value_queue_vs_ts_queue_performance_tests ) );
 #endif
 
 	return TEST_RETURN;
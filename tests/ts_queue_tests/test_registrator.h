@@ -12,6 +12,44 @@ namespace system_utilities
 			void ts_queue_wait_pop_tests();
 			void ts_queue_many_threads_tests();
 			void ts_queue_another_container_tests();
+			void ts_queue_push_range_tests();
+			void ts_queue_wait_pop_bulk_tests();
+			void ts_queue_wait_pop_for_tests();
+			void ts_queue_wait_for_empty_tests();
+			void ts_queue_spin_wait_tests();
+			void ts_queue_capacity_tests();
+			void ts_queue_spin_wait_performance_tests();
+			//
+			void lock_free_queue_constructor_tests();
+			void lock_free_queue_different_threads_tests();
+			void lock_free_queue_stop_tests();
+			void lock_free_queue_bulk_tests();
+			void lock_free_queue_many_threads_tests();
+			void lock_free_queue_vs_ts_queue_performance_tests();
+			//
+			void spsc_queue_constructor_tests();
+			void spsc_queue_different_threads_tests();
+			void spsc_queue_stop_tests();
+			void spsc_queue_ping_pong_tests();
+			void spsc_queue_bulk_tests();
+
+			void ts_value_queue_constructor_tests();
+			void ts_value_queue_move_only_tests();
+			void ts_value_queue_stop_tests();
+			void ts_value_queue_different_threads_tests();
+			void ts_value_queue_vs_ts_queue_performance_tests();
+
+			void ts_priority_queue_constructor_tests();
+			void ts_priority_queue_aging_tests();
+			void ts_priority_queue_stop_tests();
+			void ts_priority_queue_bulk_tests();
+			void ts_priority_queue_capacity_tests();
+
+			void work_stealing_queue_constructor_tests();
+			void work_stealing_queue_worker_tests();
+			void work_stealing_queue_stop_tests();
+			void work_stealing_queue_many_threads_tests();
+			void spsc_queue_vs_ts_queue_performance_tests();
 		}
 	}
 }
@@ -0,0 +1,159 @@
+#include "test_registrator.h"
+
+#include <ts_priority_queue.h>
+
+#include <vector>
+
+#include <boost/thread.hpp>
+
+using namespace system_utilities::common;
+
+namespace system_utilities
+{
+	namespace tests_
+	{
+		namespace common
+		{
+			namespace details
+			{
+				typedef ts_priority_queue< size_t, 3 > ts_priority_queue_size_t;
+
+				void ts_priority_queue_pop_helper( ts_priority_queue_size_t* mq, size_t** result )
+				{
+					*result = mq->wait_pop();
+				}
+			}
+			void ts_priority_queue_constructor_tests()
+			{
+				BOOST_CHECK_NO_THROW( ts_priority_queue< int >() );
+				details::ts_priority_queue_size_t mq;
+				BOOST_CHECK_EQUAL( mq.empty(), true );
+				BOOST_CHECK_EQUAL( mq.pop() == NULL, true );
+				BOOST_CHECK_EQUAL( mq.push( new size_t( 20 ) ), true );
+				BOOST_CHECK_EQUAL( mq.push( new size_t( 10 ), 1 ), true );
+				BOOST_CHECK_EQUAL( mq.push( new size_t( 0 ), 0 ), true );
+				BOOST_CHECK_EQUAL( mq.push( new size_t( 1 ), 0 ), true );
+				BOOST_CHECK_EQUAL( mq.push( new size_t( 21 ), 100 ), true );
+				BOOST_CHECK_EQUAL( mq.size(), 5u );
+				BOOST_CHECK_EQUAL( mq.lane_size( 2 ), 2u );
+				const size_t expected[] = { 0, 1, 10, 20, 21 };
+				for ( size_t i = 0 ; i < 5 ; ++i )
+				{
+					size_t* s = mq.ts_pop();
+					BOOST_CHECK_EQUAL( *s, expected[ i ] );
+					delete s;
+				}
+				BOOST_CHECK_EQUAL( mq.ts_pop() == NULL, true );
+			}
+			void ts_priority_queue_aging_tests()
+			{
+				details::ts_priority_queue_size_t mq( 4 );
+				mq.push( new size_t( 100 ), 2 );
+				for ( size_t i = 0 ; i < 10 ; ++i )
+					mq.push( new size_t( i ), 0 );
+				// low priority lane was passed over 4 times, so it is served as fifth
+				const size_t expected[] = { 0, 1, 2, 3, 100, 4, 5 };
+				for ( size_t i = 0 ; i < 7 ; ++i )
+				{
+					size_t* s = mq.wait_pop();
+					BOOST_CHECK_EQUAL( *s, expected[ i ] );
+					delete s;
+				}
+				BOOST_CHECK_EQUAL( mq.size(), 4u );
+			}
+			void ts_priority_queue_stop_tests()
+			{
+				details::ts_priority_queue_size_t mq;
+				size_t not_poped = 0;
+				size_t* result = &not_poped;
+				boost::thread pop( boost::bind( &details::ts_priority_queue_pop_helper, &mq, &result ) );
+				boost::this_thread::sleep( boost::posix_time::milliseconds( 50 ) );
+				mq.stop();
+				pop.join();
+				BOOST_CHECK_EQUAL( result == NULL, true );
+				size_t* const rejected = new size_t( 1 );
+				BOOST_CHECK_EQUAL( mq.push( rejected, 0 ) , false );
+				delete rejected;
+				BOOST_CHECK_NO_THROW( mq.wait() );
+
+				mq.restart();
+				BOOST_CHECK_EQUAL( mq.push( new size_t( 1 ), 0 ), true );
+				BOOST_CHECK_EQUAL( mq.push( new size_t( 2 ), 2 ), true );
+				BOOST_CHECK_EQUAL( mq.ts_size(), 2u );
+				mq.stop_processing();
+				BOOST_CHECK_EQUAL( mq.ts_size(), 0u );
+			}
+			void ts_priority_queue_bulk_tests()
+			{
+				details::ts_priority_queue_size_t mq;
+				size_t* result[ 4 ] = { NULL, NULL, NULL, NULL };
+				BOOST_CHECK_EQUAL( mq.wait_pop_bulk( result, 4, std::chrono::milliseconds( 10 ) ), 0u );
+				mq.push( new size_t( 20 ) );
+				mq.push( new size_t( 10 ), 1 );
+				mq.push( new size_t( 0 ), 0 );
+				mq.push( new size_t( 21 ) );
+				mq.push( new size_t( 1 ), 0 );
+				// bulk keeps priority order
+				BOOST_CHECK_EQUAL( mq.wait_pop_bulk( result, 4 ), 4u );
+				const size_t expected[] = { 0, 1, 10, 20 };
+				for ( size_t i = 0 ; i < 4 ; ++i )
+				{
+					BOOST_CHECK_EQUAL( *result[ i ], expected[ i ] );
+					delete result[ i ];
+				}
+				BOOST_CHECK_EQUAL( mq.wait_pop_bulk( result, 4, std::chrono::milliseconds( 10 ) ), 1u );
+				BOOST_CHECK_EQUAL( *result[ 0 ], 21u );
+				delete result[ 0 ];
+				mq.stop();
+				BOOST_CHECK_EQUAL( mq.wait_pop_bulk( result, 4 ), 0u );
+			}
+			void ts_priority_queue_capacity_tests()
+			{
+				{
+					details::ts_priority_queue_size_t mq;
+					mq.set_capacity( capacity_settings( 2, overflow_policy::fail ) );
+					BOOST_CHECK_EQUAL( mq.capacity(), 2u );
+					BOOST_CHECK_EQUAL( mq.push( new size_t( 1 ), 0 ), true );
+					BOOST_CHECK_EQUAL( mq.push( new size_t( 2 ), 2 ), true );
+					size_t* const rejected = new size_t( 3 );
+					BOOST_CHECK_EQUAL( mq.push( rejected, 0 ), false );
+					delete rejected;
+					BOOST_CHECK_EQUAL( mq.dropped(), 1u );
+					BOOST_CHECK_EQUAL( mq.ts_size(), 2u );
+				}
+				{
+					// drop_oldest drops the oldest message of the lowest priority lane
+					std::vector< size_t > dropped;
+					details::ts_priority_queue_size_t mq;
+					mq.set_capacity( capacity_settings( 3, overflow_policy::drop_oldest ), [ &dropped ]( size_t* s ) { dropped.push_back( *s ); delete s; } );
+					mq.push( new size_t( 10 ), 1 );
+					mq.push( new size_t( 20 ), 2 );
+					mq.push( new size_t( 21 ), 2 );
+					BOOST_CHECK_EQUAL( mq.push( new size_t( 0 ), 0 ), true );
+					BOOST_CHECK_EQUAL( mq.push( new size_t( 1 ), 0 ), true );
+					BOOST_REQUIRE_EQUAL( dropped.size(), 2u );
+					BOOST_CHECK_EQUAL( dropped[ 0 ], 20u );
+					BOOST_CHECK_EQUAL( dropped[ 1 ], 21u );
+					BOOST_CHECK_EQUAL( mq.lane_size( 2 ), 0u );
+					BOOST_CHECK_EQUAL( mq.dropped(), 2u );
+				}
+				{
+					// block waits for consumer
+					details::ts_priority_queue_size_t mq;
+					mq.set_capacity( capacity_settings( 1, overflow_policy::block ) );
+					mq.push( new size_t( 1 ), 0 );
+					boost::thread push( [ &mq ]() { mq.push( new size_t( 2 ), 0 ); } );
+					boost::this_thread::sleep( boost::posix_time::milliseconds( 20 ) );
+					BOOST_CHECK_EQUAL( mq.ts_size(), 1u );
+					size_t* s = mq.wait_pop();
+					BOOST_CHECK_EQUAL( *s, 1u );
+					delete s;
+					push.join();
+					s = mq.wait_pop();
+					BOOST_CHECK_EQUAL( *s, 2u );
+					delete s;
+				}
+			}
+		}
+	}
+}
@@ -2,6 +2,7 @@
 
 #include <deque>
 #include <queue>
+#include <vector>
 
 #include <ts_queue.h>
 #include <time_tracker.h>
@@ -129,6 +130,59 @@ namespace system_utilities
 						}
 					}
 				};
+				void ts_queue_wait_pop_bulk_test_helper( ts_queue_size_t* mq, const size_t test_size )
+				{
+					size_t* elements[ 16 ];
+					size_t i = 0;
+					while ( i < test_size )
+					{
+						const size_t poped = mq->wait_pop_bulk( elements, 16 );
+						BOOST_CHECK_EQUAL( poped > 0, true );
+						for ( size_t e = 0 ; e < poped ; ++e, ++i )
+						{
+							BOOST_CHECK_EQUAL( *elements[ e ], i );
+							delete elements[ e ];
+						}
+					}
+					BOOST_CHECK_EQUAL( i, test_size );
+				}
+				void ts_queue_delayed_push_test_helper( ts_queue_size_t* mq, const size_t value )
+				{
+					boost::this_thread::sleep( boost::posix_time::milliseconds( 20 ) );
+					mq->push( new size_t( value ) );
+				}
+				void ts_queue_ping_pong_test_helper( ts_queue_size_t* ping, ts_queue_size_t* pong )
+				{
+					while ( size_t* s = ping->wait_pop() )
+						pong->push( s );
+				}
+				long long ts_queue_ping_pong_test( const size_t spin_count, const size_t iterations )
+				{
+					ts_queue_size_t ping( spin_count );
+					ts_queue_size_t pong( spin_count );
+					boost::thread echo( boost::bind( &ts_queue_ping_pong_test_helper, &ping, &pong ) );
+					size_t value = 0;
+					time_tracker< std::chrono::microseconds > tt;
+					for ( size_t i = 0 ; i < iterations ; ++i )
+					{
+						ping.push( &value );
+						pong.wait_pop();
+					}
+					const long long result = tt.elapsed();
+					ping.stop();
+					echo.join();
+					return result;
+				}
+				void ts_queue_drop_helper( std::vector< size_t >* dropped, size_t* value )
+				{
+					dropped->push_back( *value );
+					delete value;
+				}
+				void ts_queue_delayed_pop_helper( ts_queue_size_t* mq )
+				{
+					boost::this_thread::sleep( boost::posix_time::milliseconds( 20 ) );
+					delete mq->ts_pop();
+				}
 				void ts_queue_wait_test_helper(details::ts_queue_size_t* mq_, size_t* pop_iterations_)
 				{
 					while (true)
@@ -196,6 +250,213 @@ namespace system_utilities
 				BOOST_CHECK_EQUAL(pop_iterations_, size);
 			}
 
+			void ts_queue_push_range_tests()
+			{
+				details::ts_queue_size_t mq;
+				std::vector< size_t* > elements;
+				for ( size_t i = 0 ; i < 10 ; ++i )
+					elements.push_back( new size_t( i ) );
+				BOOST_CHECK_EQUAL( mq.push_range( elements.begin(), elements.end() ), 10u );
+				BOOST_CHECK_EQUAL( mq.size(), 10u );
+				for ( size_t i = 0 ; i < 10 ; ++i )
+				{
+					size_t* s = mq.ts_pop();
+					BOOST_CHECK_EQUAL( *s, i );
+					delete s;
+				}
+				mq.stop();
+				BOOST_CHECK_EQUAL( mq.push_range( elements.begin(), elements.end() ), 0u );
+			}
+			void ts_queue_wait_pop_bulk_tests()
+			{
+				{
+					details::ts_queue_size_t mq;
+					size_t* elements[ 4 ];
+					BOOST_CHECK_EQUAL( mq.wait_pop_bulk( elements, 4, std::chrono::milliseconds( 10 ) ), 0u );
+					for ( size_t i = 0 ; i < 6 ; ++i )
+						mq.push( new size_t( i ) );
+					BOOST_CHECK_EQUAL( mq.wait_pop_bulk( elements, 4, std::chrono::milliseconds( 10 ) ), 4u );
+					for ( size_t i = 0 ; i < 4 ; ++i )
+					{
+						BOOST_CHECK_EQUAL( *elements[ i ], i );
+						delete elements[ i ];
+					}
+					BOOST_CHECK_EQUAL( mq.wait_pop_bulk( elements, 4 ), 2u );
+					delete elements[ 0 ];
+					delete elements[ 1 ];
+				}
+				{
+					details::ts_queue_size_t mq;
+					static const size_t test_size = 100000;
+					static const size_t range_size = 10;
+					boost::thread pop( boost::bind( &details::ts_queue_wait_pop_bulk_test_helper, &mq, test_size ) );
+					for ( size_t i = 0 ; i < test_size ; i += range_size )
+					{
+						size_t* range[ range_size ];
+						for ( size_t r = 0 ; r < range_size ; ++r )
+							range[ r ] = new size_t( i + r );
+						BOOST_CHECK_EQUAL( mq.push_range( range, range + range_size ), range_size );
+					}
+					pop.join();
+					BOOST_CHECK_EQUAL( mq.empty(), true );
+				}
+			}
+			void ts_queue_wait_pop_for_tests()
+			{
+				details::ts_queue_size_t mq;
+				{
+					time_tracker< std::chrono::milliseconds > tt;
+					BOOST_CHECK_EQUAL( mq.wait_pop_for( std::chrono::milliseconds( 30 ) ) == NULL, true );
+					BOOST_CHECK_EQUAL( tt.elapsed() >= 25, true );
+				}
+				BOOST_CHECK_EQUAL( mq.wait_pop_until( std::chrono::steady_clock::now() - std::chrono::seconds( 1 ) ) == NULL, true );
+				mq.push( new size_t( 1 ) );
+				{
+					size_t* s = mq.wait_pop_until( std::chrono::system_clock::now() + std::chrono::seconds( 1 ) );
+					BOOST_CHECK_EQUAL( s != NULL && *s == 1, true );
+					delete s;
+				}
+				{
+					boost::thread push( boost::bind( &details::ts_queue_delayed_push_test_helper, &mq, 2 ) );
+					size_t* s = mq.wait_pop_for( std::chrono::seconds( 10 ) );
+					BOOST_CHECK_EQUAL( s != NULL && *s == 2, true );
+					delete s;
+					push.join();
+				}
+				mq.stop();
+				BOOST_CHECK_EQUAL( mq.wait_pop_for( std::chrono::seconds( 10 ) ) == NULL, true );
+			}
+			void ts_queue_wait_for_empty_tests()
+			{
+				details::ts_queue_size_t mq;
+				BOOST_CHECK_EQUAL( mq.wait_for_empty( std::chrono::milliseconds( 10 ) ), true );
+				mq.push( new size_t( 1 ) );
+				BOOST_CHECK_EQUAL( mq.wait_for_empty( std::chrono::milliseconds( 10 ) ), false );
+				size_t pop_iterations = 0;
+				boost::thread poper( boost::bind( &details::ts_queue_wait_test_helper, &mq, &pop_iterations ) );
+				BOOST_CHECK_EQUAL( mq.wait_for_empty( std::chrono::seconds( 10 ) ), true );
+				mq.stop();
+				poper.join();
+				BOOST_CHECK_EQUAL( pop_iterations, 1u );
+				BOOST_CHECK_EQUAL( mq.wait_for_empty( std::chrono::seconds( 10 ) ), true );
+			}
+			void ts_queue_spin_wait_tests()
+			{
+				details::ts_queue_size_t mq( 1000 );
+				const size_t test_size = 100000;
+				boost::thread pop( boost::bind( &details::ts_queue_different_threads_pop_thread_helper, &mq, test_size ) );
+				for ( size_t i = 0 ; i < test_size ; ++i )
+					mq.push( new size_t( i ) );
+				pop.join();
+				BOOST_CHECK_EQUAL( mq.empty(), true );
+				mq.set_spin_count( 0 );
+				BOOST_CHECK_EQUAL( mq.wait_pop_for( std::chrono::milliseconds( 1 ) ) == NULL, true );
+			}
+			void ts_queue_capacity_tests()
+			{
+				{
+					details::ts_queue_size_t mq;
+					mq.set_capacity( capacity_settings( 2, overflow_policy::fail ) );
+					BOOST_CHECK_EQUAL( mq.capacity(), 2u );
+					BOOST_CHECK_EQUAL( mq.push( new size_t( 1 ) ), true );
+					BOOST_CHECK_EQUAL( mq.push( new size_t( 2 ) ), true );
+					size_t* const rejected = new size_t( 3 );
+					BOOST_CHECK_EQUAL( mq.push( rejected ), false );
+					delete rejected;
+					BOOST_CHECK_EQUAL( mq.dropped(), 1u );
+					BOOST_CHECK_EQUAL( mq.size(), 2u );
+				}
+				{
+					details::ts_queue_size_t mq;
+					mq.set_capacity( capacity_settings( 1, overflow_policy::block_for, std::chrono::milliseconds( 10 ) ) );
+					BOOST_CHECK_EQUAL( mq.push( new size_t( 1 ) ), true );
+					size_t* const rejected = new size_t( 2 );
+					time_tracker< std::chrono::milliseconds > tt;
+					BOOST_CHECK_EQUAL( mq.push( rejected ), false );
+					BOOST_CHECK_EQUAL( tt.elapsed() >= 8, true );
+					delete rejected;
+					BOOST_CHECK_EQUAL( mq.dropped(), 1u );
+				}
+				{
+					details::ts_queue_size_t mq;
+					mq.set_capacity( capacity_settings( 1, overflow_policy::block ) );
+					BOOST_CHECK_EQUAL( mq.push( new size_t( 1 ) ), true );
+					boost::thread pop( boost::bind( &details::ts_queue_delayed_pop_helper, &mq ) );
+					BOOST_CHECK_EQUAL( mq.push( new size_t( 2 ) ), true );
+					pop.join();
+					size_t* s = mq.ts_pop();
+					BOOST_CHECK_EQUAL( s != NULL && *s == 2, true );
+					delete s;
+					BOOST_CHECK_EQUAL( mq.dropped(), 0u );
+					// blocked producer is woken up by stop
+					mq.push( new size_t( 3 ) );
+					boost::thread stop( boost::bind( &details::ts_queue_size_t::stop, &mq ) );
+					size_t* const not_pushed = new size_t( 4 );
+					BOOST_CHECK_EQUAL( mq.push( not_pushed ), false );
+					delete not_pushed;
+					stop.join();
+				}
+				{
+					std::vector< size_t > dropped;
+					details::ts_queue_size_t mq;
+					mq.set_capacity( capacity_settings( 2, overflow_policy::drop_newest ), [ &dropped ]( size_t* const value ) { details::ts_queue_drop_helper( &dropped, value ); } );
+					for ( size_t i = 0 ; i < 5 ; ++i )
+						BOOST_CHECK_EQUAL( mq.push( new size_t( i ) ), true );
+					BOOST_CHECK_EQUAL( mq.dropped(), 3u );
+					BOOST_CHECK_EQUAL( dropped.size(), 3u );
+					BOOST_CHECK_EQUAL( dropped.front(), 2u );
+					size_t* s = mq.ts_pop();
+					BOOST_CHECK_EQUAL( *s, 0u );
+					delete s;
+				}
+				{
+					std::vector< size_t > dropped;
+					details::ts_queue_size_t mq;
+					mq.set_capacity( capacity_settings( 2, overflow_policy::drop_oldest ), [ &dropped ]( size_t* const value ) { details::ts_queue_drop_helper( &dropped, value ); } );
+					for ( size_t i = 0 ; i < 5 ; ++i )
+						BOOST_CHECK_EQUAL( mq.push( new size_t( i ) ), true );
+					BOOST_CHECK_EQUAL( mq.dropped(), 3u );
+					BOOST_CHECK_EQUAL( dropped.size(), 3u );
+					BOOST_CHECK_EQUAL( dropped.front(), 0u );
+					size_t* s = mq.ts_pop();
+					BOOST_CHECK_EQUAL( *s, 3u );
+					delete s;
+				}
+				{
+					std::vector< size_t > dropped;
+					details::ts_queue_size_t mq;
+					mq.set_capacity( capacity_settings( 2, overflow_policy::sample, std::chrono::milliseconds( 0 ), 4 ), [ &dropped ]( size_t* const value ) { details::ts_queue_drop_helper( &dropped, value ); } );
+					for ( size_t i = 0 ; i < 10 ; ++i )
+						BOOST_CHECK_EQUAL( mq.push( new size_t( i ) ), true );
+					// 8 overflows, every 4th pushes message: 5 and 9 are in queue
+					BOOST_CHECK_EQUAL( mq.dropped(), 8u );
+					BOOST_CHECK_EQUAL( dropped.size(), 8u );
+					size_t* s = mq.ts_pop();
+					BOOST_CHECK_EQUAL( *s, 5u );
+					delete s;
+					s = mq.ts_pop();
+					BOOST_CHECK_EQUAL( *s, 9u );
+					delete s;
+				}
+				{
+					// push_range stops on the first message that was not pushed
+					details::ts_queue_size_t mq;
+					mq.set_capacity( capacity_settings( 3, overflow_policy::fail ) );
+					size_t* range[ 5 ];
+					for ( size_t i = 0 ; i < 5 ; ++i )
+						range[ i ] = new size_t( i );
+					BOOST_CHECK_EQUAL( mq.push_range( range, range + 5 ), 3u );
+					delete range[ 3 ];
+					delete range[ 4 ];
+				}
+			}
+			void ts_queue_spin_wait_performance_tests()
+			{
+				static const size_t iterations = 20000;
+				const long long park_time = details::ts_queue_ping_pong_test( 0, iterations );
+				const long long spin_time = details::ts_queue_ping_pong_test( 1000, iterations );
+				std::cout << iterations << " ping-pong round trips: park " << park_time << " us, spin then park " << spin_time << " us" << std::endl;
+			}
 			void ts_queue_another_container_tests()
 			{
 				ts_queue< int, std::deque > deque_ts;
@@ -0,0 +1,160 @@
+#include "test_registrator.h"
+
+#include <memory>
+#include <string>
+
+#include <ts_queue.h>
+#include <ts_value_queue.h>
+#include <time_tracker.h>
+
+#include <boost/thread.hpp>
+
+using namespace system_utilities::common;
+
+namespace system_utilities
+{
+	namespace tests_
+	{
+		namespace common
+		{
+			namespace details
+			{
+				typedef ts_value_queue< size_t > ts_value_queue_size_t;
+
+				struct destructor_counter
+				{
+					size_t* destroyed_;
+					explicit destructor_counter( size_t& destroyed )
+						: destroyed_( &destroyed )
+					{
+					}
+					destructor_counter( const destructor_counter& other )
+						: destroyed_( other.destroyed_ )
+					{
+					}
+					~destructor_counter()
+					{
+						++( *destroyed_ );
+					}
+				};
+
+				void ts_value_queue_pop_thread_helper( ts_value_queue_size_t* mq, const size_t test_size )
+				{
+					size_t i = 0;
+					size_t value = 0;
+					while ( i < test_size && mq->wait_pop( value ) )
+					{
+						BOOST_CHECK_EQUAL( value, i );
+						++i;
+					}
+					BOOST_CHECK_EQUAL( i, test_size );
+				}
+				struct tick
+				{
+					size_t instrument_;
+					double price_;
+					size_t volume_;
+				};
+			}
+			void ts_value_queue_constructor_tests()
+			{
+				BOOST_CHECK_NO_THROW( ts_value_queue< std::string >() );
+				details::ts_value_queue_size_t mq( 4 );
+				BOOST_CHECK_EQUAL( mq.capacity(), 4u );
+				size_t value = 0;
+				BOOST_CHECK_EQUAL( mq.ts_pop( value ), false );
+				for ( size_t i = 0 ; i < 3 ; ++i )
+					BOOST_CHECK_EQUAL( mq.push( i ), true );
+				BOOST_CHECK_EQUAL( mq.ts_pop( value ), true );
+				BOOST_CHECK_EQUAL( value, 0u );
+				// head is not at the beginning of ring, next pushes wrap around and grow the ring
+				for ( size_t i = 3 ; i < 20 ; ++i )
+					BOOST_CHECK_EQUAL( mq.push( i ), true );
+				BOOST_CHECK_EQUAL( mq.capacity(), 32u );
+				BOOST_CHECK_EQUAL( mq.size(), 19u );
+				for ( size_t i = 1 ; i < 20 ; ++i )
+				{
+					BOOST_CHECK_EQUAL( mq.ts_pop( value ), true );
+					BOOST_CHECK_EQUAL( value, i );
+				}
+				BOOST_CHECK_EQUAL( mq.empty(), true );
+			}
+			void ts_value_queue_move_only_tests()
+			{
+				ts_value_queue< std::unique_ptr< size_t > > mq( 2 );
+				for ( size_t i = 0 ; i < 10 ; ++i )
+					BOOST_CHECK_EQUAL( mq.push( std::unique_ptr< size_t >( new size_t( i ) ) ), true );
+				BOOST_CHECK_EQUAL( mq.emplace( new size_t( 10 ) ), true );
+				for ( size_t i = 0 ; i < 11 ; ++i )
+				{
+					std::unique_ptr< size_t > result;
+					BOOST_CHECK_EQUAL( mq.wait_pop( result ), true );
+					BOOST_CHECK_EQUAL( *result, i );
+				}
+				std::unique_ptr< size_t > result;
+				BOOST_CHECK_EQUAL( mq.wait_pop_for( result, std::chrono::milliseconds( 10 ) ), false );
+				BOOST_CHECK_EQUAL( result.get() == NULL, true );
+			}
+			void ts_value_queue_stop_tests()
+			{
+				size_t destroyed = 0;
+				{
+					ts_value_queue< details::destructor_counter > mq( 2 );
+					for ( size_t i = 0 ; i < 5 ; ++i )
+						mq.emplace( destroyed );
+					const size_t destroyed_on_grow = destroyed;
+					mq.stop_processing();
+					BOOST_CHECK_EQUAL( destroyed - destroyed_on_grow, 5u );
+					BOOST_CHECK_EQUAL( mq.ts_size(), 0u );
+					BOOST_CHECK_EQUAL( mq.emplace( destroyed ), false );
+					mq.restart();
+					BOOST_CHECK_EQUAL( mq.emplace( destroyed ), true );
+					destroyed = 0;
+				}
+				BOOST_CHECK_EQUAL( destroyed, 1u );
+			}
+			void ts_value_queue_different_threads_tests()
+			{
+				details::ts_value_queue_size_t mq;
+				const size_t test_size = 200000;
+				boost::thread pop( boost::bind( &details::ts_value_queue_pop_thread_helper, &mq, test_size ) );
+				for ( size_t i = 0 ; i < test_size ; ++i )
+					mq.push( i );
+				pop.join();
+				mq.wait();
+				BOOST_CHECK_EQUAL( mq.empty(), true );
+			}
+			void ts_value_queue_vs_ts_queue_performance_tests()
+			{
+				static const size_t test_size = 2000000;
+				long long ts_queue_time = 0;
+				{
+					ts_queue< details::tick > mq;
+					time_tracker< std::chrono::milliseconds > tt;
+					for ( size_t i = 0 ; i < test_size ; ++i )
+					{
+						details::tick* t = new details::tick();
+						t->instrument_ = i;
+						mq.push( t );
+						delete mq.ts_pop();
+					}
+					ts_queue_time = tt.elapsed();
+				}
+				long long ts_value_queue_time = 0;
+				{
+					ts_value_queue< details::tick > mq;
+					time_tracker< std::chrono::milliseconds > tt;
+					details::tick t = details::tick();
+					for ( size_t i = 0 ; i < test_size ; ++i )
+					{
+						t.instrument_ = i;
+						mq.push( t );
+						mq.ts_pop( t );
+					}
+					ts_value_queue_time = tt.elapsed();
+				}
+				std::cout << test_size << " push-pop of small messages: ts_queue " << ts_queue_time << " ms, ts_value_queue " << ts_value_queue_time << " ms" << std::endl;
+			}
+		}
+	}
+}
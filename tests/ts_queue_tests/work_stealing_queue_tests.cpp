@@ -0,0 +1,134 @@
+#include "test_registrator.h"
+
+#include <atomic>
+
+#include <work_stealing_queue.h>
+
+#include <boost/thread.hpp>
+
+using namespace system_utilities::common;
+
+namespace system_utilities
+{
+	namespace tests_
+	{
+		namespace common
+		{
+			namespace details
+			{
+				typedef work_stealing_queue< size_t, 8, 16 > work_stealing_queue_size_t;
+
+				// every message with value > 0 is replaced by two messages with value - 1, pushed from worker thread
+				struct work_stealing_tree_test_helper
+				{
+					work_stealing_queue_size_t queue_;
+					std::atomic< size_t > processed_;
+					const size_t total_;
+
+					explicit work_stealing_tree_test_helper( const size_t workers, const size_t roots, const size_t depth )
+						: processed_( 0 )
+						, total_( roots * ( ( size_t( 1 ) << ( depth + 1 ) ) - 1 ) )
+					{
+						boost::thread_group tg;
+						for ( size_t i = 0 ; i < workers ; ++i )
+							tg.create_thread( boost::bind( &work_stealing_tree_test_helper::worker, this ) );
+						for ( size_t i = 0 ; i < roots ; ++i )
+							BOOST_CHECK_EQUAL( queue_.push( new size_t( depth ) ), true );
+						tg.join_all();
+						BOOST_CHECK_EQUAL( processed_.load(), total_ );
+					}
+					void worker()
+					{
+						while ( size_t* s = queue_.wait_pop() )
+						{
+							if ( *s > 0 )
+							{
+								queue_.push( new size_t( *s - 1 ) );
+								queue_.push( new size_t( *s - 1 ) );
+							}
+							delete s;
+							if ( ++processed_ == total_ )
+								queue_.stop();
+						}
+					}
+				};
+				void work_stealing_queue_stop_test_helper( work_stealing_queue_size_t* mq, size_t** result )
+				{
+					*result = mq->wait_pop();
+				}
+			}
+			void work_stealing_queue_constructor_tests()
+			{
+				BOOST_CHECK_NO_THROW( work_stealing_queue< int >() );
+				details::work_stealing_queue_size_t mq;
+				BOOST_CHECK_EQUAL( mq.empty(), true );
+				BOOST_CHECK_EQUAL( mq.pop() == NULL, true );
+				for ( size_t i = 0 ; i < 10 ; ++i )
+					BOOST_CHECK_EQUAL( mq.push( new size_t( i ) ), true );
+				BOOST_CHECK_EQUAL( mq.size(), 10u );
+				// not a worker thread: messages are taken from injection queue in FIFO order
+				for ( size_t i = 0 ; i < 10 ; ++i )
+				{
+					size_t* s = mq.ts_pop();
+					BOOST_CHECK_EQUAL( *s, i );
+					delete s;
+				}
+				BOOST_CHECK_EQUAL( mq.empty(), true );
+				BOOST_CHECK_NO_THROW( mq.wait() );
+			}
+			void work_stealing_queue_worker_tests()
+			{
+				details::work_stealing_queue_size_t mq;
+				mq.push( new size_t( 0 ) );
+				// wait_pop registers calling thread as worker, following pushes go to own deque (LIFO), deque overflow goes to injection queue
+				size_t* s = mq.wait_pop();
+				BOOST_CHECK_EQUAL( *s, 0u );
+				delete s;
+				for ( size_t i = 1 ; i <= 20 ; ++i )
+					mq.push( new size_t( i ) );
+				BOOST_CHECK_EQUAL( mq.size(), 20u );
+				for ( size_t i = 16 ; i > 0 ; --i )
+				{
+					s = mq.wait_pop();
+					BOOST_CHECK_EQUAL( *s, i );
+					delete s;
+				}
+				// first injected message is returned, the rest are moved to own deque
+				const size_t injected[] = { 17, 20, 19, 18 };
+				for ( size_t i = 0 ; i < 4 ; ++i )
+				{
+					s = mq.wait_pop();
+					BOOST_CHECK_EQUAL( *s, injected[ i ] );
+					delete s;
+				}
+				BOOST_CHECK_EQUAL( mq.empty(), true );
+			}
+			void work_stealing_queue_stop_tests()
+			{
+				details::work_stealing_queue_size_t mq;
+				size_t not_poped = 0;
+				size_t* result = &not_poped;
+				boost::thread pop( boost::bind( &details::work_stealing_queue_stop_test_helper, &mq, &result ) );
+				boost::this_thread::sleep( boost::posix_time::milliseconds( 50 ) );
+				mq.stop();
+				pop.join();
+				BOOST_CHECK_EQUAL( result == NULL, true );
+				size_t* const rejected = new size_t( 1 );
+				BOOST_CHECK_EQUAL( mq.push( rejected ), false );
+				delete rejected;
+				BOOST_CHECK_NO_THROW( mq.wait() );
+
+				mq.restart();
+				BOOST_CHECK_EQUAL( mq.push( new size_t( 1 ) ), true );
+				BOOST_CHECK_EQUAL( mq.ts_size(), 1u );
+				mq.stop_processing();
+				BOOST_CHECK_EQUAL( mq.ts_size(), 0u );
+			}
+			void work_stealing_queue_many_threads_tests()
+			{
+				details::work_stealing_tree_test_helper one_worker( 1, 4, 10 );
+				details::work_stealing_tree_test_helper many_workers( 8, 4, 12 );
+			}
+		}
+	}
+}